@@ -1,48 +1,712 @@
-#include <linux/kernel.h>
-#include <linux/i2c.h>
-#include <linux/delay.h>
-
-#define SSD1306_I2C_ADDRESS 0x3C
-
-// hàm probe  trả về int
-static int ssd1306_probe(struct i2c_client *client, const struct i2c_device_id *id)
-{
-    pr_info("SSD1306 I2C device probed\n");
-
-    // Gửi lệnh khởi tạo SSD1306 qua I2C
-    i2c_smbus_write_byte_data(client, 0x00, 0xAE);  // Display OFF
-    i2c_smbus_write_byte_data(client, 0x00, 0xA8);  // Set multiplex ratio
-    i2c_smbus_write_byte_data(client, 0x00, 0x3F);  // Max multiplex
-    i2c_smbus_write_byte_data(client, 0x00, 0xD3);  // Set display offset
-    i2c_smbus_write_byte_data(client, 0x00, 0x00);  // No offset
-    i2c_smbus_write_byte_data(client, 0x00, 0x40);  // Set display start line
-    i2c_smbus_write_byte_data(client, 0x00, 0xA4);  // Display RAM content
-
-    return 0; // Trả về 0 sau khi khởi tạo thành công
-}
-
-// hàm remove trả về void
-static void ssd1306_remove(struct i2c_client *client)
-{
-    pr_info("SSD1306 I2C device removed\n");
-}
-
-static const struct i2c_device_id ssd1306_id[] = {
-    { "ssd1306", 0 },
-    { }
-};
-
-static struct i2c_driver ssd1306_driver = {
-    .driver = {
-        .name = "ssd1306",
-    },
-    .probe = ssd1306_probe,  //  int
-    .remove = ssd1306_remove,  // void
-    .id_table = ssd1306_id,
-};
-
-module_i2c_driver(ssd1306_driver);
-
-MODULE_AUTHOR("Your Name");
-MODULE_DESCRIPTION("SSD1306 OLED I2C Driver for Raspberry Pi");
-MODULE_LICENSE("GPL");
\ No newline at end of file
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/i2c.h>
+#include <linux/delay.h>
+#include <linux/fb.h>
+#include <linux/mm.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+#include <linux/mutex.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/sysfs.h>
+#include <linux/of.h>
+#include <linux/property.h>
+
+#define SSD1306_I2C_ADDRESS 0x3C
+
+// Kích thước lớn nhất driver hỗ trợ (kích thước thật lấy từ bảng panel)
+#define SSD1306_MAX_WIDTH   128
+#define SSD1306_MAX_PAGES   8
+
+// Control byte
+#define SSD1306_CONTROL_CMD  0x00
+#define SSD1306_CONTROL_DATA 0x40
+
+// Chuỗi khởi tạo dựng sẵn lúc biên dịch cho từng loại panel:
+// control byte 0x00 + toàn bộ lệnh, gửi bằng một i2c_transfer duy nhất
+#define SSD1306_INIT_BLOB(mux, com_pins) {                 \
+    SSD1306_CONTROL_CMD,                                   \
+    0xAE,             /* Display OFF */                    \
+    0xD5, 0x80,       /* Display clock divide */           \
+    0xA8, (mux),      /* Multiplex ratio (height - 1) */   \
+    0xD3, 0x00,       /* Display offset */                 \
+    0x40,             /* Display start line 0 */           \
+    0x8D, 0x14,       /* Charge pump ON */                 \
+    0x20, 0x00,       /* Horizontal Addressing Mode */     \
+    0xA1,             /* Segment remap */                  \
+    0xC8,             /* COM scan direction remapped */    \
+    0xDA, (com_pins), /* COM pins */                       \
+    0x81, 0xCF,       /* Contrast */                       \
+    0xD9, 0xF1,       /* Pre-charge period */              \
+    0xDB, 0x40,       /* VCOMH deselect level */           \
+    0xA4,             /* Display RAM content */            \
+    0xA6,             /* Normal display */                 \
+    0xAF,             /* Display ON */                     \
+}
+
+static const u8 ssd1306_init_128x64[] = SSD1306_INIT_BLOB(63, 0x12);
+static const u8 ssd1306_init_128x32[] = SSD1306_INIT_BLOB(31, 0x02);
+static const u8 ssd1306_init_96x16[]  = SSD1306_INIT_BLOB(15, 0x02);
+static const u8 ssd1306_init_64x48[]  = SSD1306_INIT_BLOB(47, 0x12);
+
+// Mô tả một loại panel
+struct ssd1306_panel {
+    u32 width, height;
+    u8 col_offset;          // cột GDDRAM đầu tiên nhìn thấy được
+    const u8 *init_blob;
+    u32 init_len;
+};
+
+enum ssd1306_panel_type {
+    SSD1306_128X64,
+    SSD1306_128X32,
+    SSD1306_96X16,
+    SSD1306_64X48,
+};
+
+static const struct ssd1306_panel ssd1306_panels[] = {
+    [SSD1306_128X64] = { 128, 64, 0,  ssd1306_init_128x64, sizeof(ssd1306_init_128x64) },
+    [SSD1306_128X32] = { 128, 32, 0,  ssd1306_init_128x32, sizeof(ssd1306_init_128x32) },
+    [SSD1306_96X16]  = { 96,  16, 0,  ssd1306_init_96x16,  sizeof(ssd1306_init_96x16) },
+    [SSD1306_64X48]  = { 64,  48, 32, ssd1306_init_64x48,  sizeof(ssd1306_init_64x48) },
+};
+
+// Giới hạn một lần ghi SMBus I2C block (dùng khi adapter không hỗ trợ I2C thô, ví dụ i2c-stub)
+#define SSD1306_SMBUS_BLOCK_MAX 32
+
+// Số lần flush tối đa mỗi giây; các lần ghi trong khoảng 1/refreshrate giây được gộp lại
+static unsigned int refreshrate = 30;
+module_param(refreshrate, uint, 0444);
+MODULE_PARM_DESC(refreshrate, "Maximum framebuffer flushes per second (default 30)");
+
+// =========================================================================
+// Đo đạc, đọc qua sysfs: /sys/bus/i2c/devices/<bus>-<addr>/stats/
+//   flushes transfers bytes short_writes nacks errors : bộ đếm
+//   fps                                               : theo trung bình trượt khoảng cách khung
+//   xfer_ns flush_ns flush_bytes frame_interval_ns    : histogram log2, một dòng
+//       "<count> <sum> <max> <b0> ... <b31>", bucket i đếm 2^(i-1) <= v < 2^i
+//   reset                                             : ghi bất kỳ để xóa
+// Cùng ý nghĩa với bộ đo của driver userspace (ssd1306_metrics.h).
+// =========================================================================
+
+#define SSD1306_HIST_BUCKETS 32
+
+struct ssd1306_hist {
+    u64 count, sum, max;
+    u64 buckets[SSD1306_HIST_BUCKETS];
+};
+
+struct ssd1306_stats {
+    struct ssd1306_hist xfer_ns;            // một lần i2c_transfer/i2c_master_send/ghi khối SMBus
+    struct ssd1306_hist flush_ns;           // một lần flush có gửi dữ liệu
+    struct ssd1306_hist flush_bytes;        // byte lên bus mỗi lần flush
+    struct ssd1306_hist frame_interval_ns;  // giữa hai lần flush có gửi dữ liệu
+    u64 flushes, transfers, bytes;
+    u64 short_writes;                       // adapter chỉ nhận một phần giao dịch
+    u64 nacks;                              // -ENXIO/-EREMOTEIO: slave không ACK
+    u64 errors;
+    u64 frame_avg_ns;                       // trung bình trượt (1/8) của frame_interval_ns
+    ktime_t last_frame;
+};
+
+struct ssd1306_par {
+    struct i2c_client *client;
+    struct fb_info *info;
+    const struct ssd1306_panel *panel;
+    u32 line_length;            // 1 bit/pixel, theo hàng (định dạng fbdev)
+    u8 *vmem;                   // bộ đệm fbdev (theo hàng), userspace mmap vào đây
+    unsigned int vmem_order;
+
+    // Vùng hàng bị ghi qua write()/fillrect/... (không đi qua page fault của mmap)
+    spinlock_t dirty_lock;
+    int dirty_y0, dirty_y1;     // dirty_y0 > dirty_y1 nghĩa là sạch
+
+    struct mutex tx_lock;       // bảo vệ shadow và tx
+    bool shadow_valid;          // false -> lần flush kế tiếp gửi toàn bộ
+    u8 shadow[SSD1306_MAX_PAGES][SSD1306_MAX_WIDTH]; // nội dung GDDRAM hiện tại của màn hình
+    u8 tx[1 + SSD1306_MAX_WIDTH];                    // control byte + một hàng dữ liệu
+    bool smbus_only;
+    struct ssd1306_stats stats;                      // bảo vệ bởi tx_lock
+};
+
+static void ssd1306_hist_add(struct ssd1306_hist *h, u64 v)
+{
+    int i = v ? fls64(v) : 0;
+
+    h->buckets[min(i, SSD1306_HIST_BUCKETS - 1)]++;
+    h->count++;
+    h->sum += v;
+    if (v > h->max)
+        h->max = v;
+}
+
+// Ghi nhận một lần truyền len byte bắt đầu lúc start; ret là 0 hoặc mã lỗi âm
+static int ssd1306_xfer_done(struct ssd1306_par *par, ktime_t start, int len, int ret)
+{
+    struct ssd1306_stats *st = &par->stats;
+
+    ssd1306_hist_add(&st->xfer_ns, ktime_to_ns(ktime_sub(ktime_get(), start)));
+    if (ret < 0) {
+        st->errors++;
+        if (ret == -ENXIO || ret == -EREMOTEIO)
+            st->nacks++;
+        return ret;
+    }
+    st->transfers++;
+    st->bytes += len;
+    return 0;
+}
+
+// i2c_master_send() của len byte trong buf, ghi thiếu được tính là lỗi
+static int ssd1306_master_send(struct ssd1306_par *par, const u8 *buf, int len)
+{
+    ktime_t start = ktime_get();
+    int ret = i2c_master_send(par->client, buf, len);
+
+    if (ret >= 0 && ret != len) {
+        par->stats.short_writes++;
+        ret = -EIO;
+    }
+    return ssd1306_xfer_done(par, start, len, ret);
+}
+
+static int ssd1306_smbus_block(struct ssd1306_par *par, u8 control, int len, const u8 *buf)
+{
+    ktime_t start = ktime_get();
+    int ret = i2c_smbus_write_i2c_block_data(par->client, control, len, buf);
+
+    return ssd1306_xfer_done(par, start, len + 1, ret < 0 ? ret : 0);
+}
+
+// =========================================================================
+// Giao tiếp I2C
+// =========================================================================
+
+// Gửi một chuỗi lệnh trong một giao dịch (một control byte 0x00 cho cả chuỗi)
+static int ssd1306_write_cmds(struct ssd1306_par *par, const u8 *cmds, int len)
+{
+    int ret;
+
+    if (par->smbus_only) {
+        while (len > 0) {
+            int chunk = min(len, SSD1306_SMBUS_BLOCK_MAX);
+
+            ret = ssd1306_smbus_block(par, SSD1306_CONTROL_CMD, chunk, cmds);
+            if (ret < 0)
+                return ret;
+            cmds += chunk;
+            len -= chunk;
+        }
+        return 0;
+    }
+
+    par->tx[0] = SSD1306_CONTROL_CMD;
+    memcpy(par->tx + 1, cmds, len);
+    return ssd1306_master_send(par, par->tx, len + 1);
+}
+
+// Gửi chuỗi khởi tạo của panel. Với adapter I2C thô: một i2c_master_send() (một i2c_transfer) từ blob dựng sẵn.
+static int ssd1306_send_init(struct ssd1306_par *par)
+{
+    const struct ssd1306_panel *panel = par->panel;
+
+    if (par->smbus_only)
+        return ssd1306_write_cmds(par, panel->init_blob + 1, panel->init_len - 1);
+    return ssd1306_master_send(par, panel->init_blob, panel->init_len);
+}
+
+static int ssd1306_write_data(struct ssd1306_par *par, const u8 *data, int len)
+{
+    int ret;
+
+    if (par->smbus_only) {
+        // Chia thành các khối 32 byte; con trỏ địa chỉ của SSD1306 chạy tiếp giữa các khối
+        while (len > 0) {
+            int chunk = min(len, SSD1306_SMBUS_BLOCK_MAX);
+
+            ret = ssd1306_smbus_block(par, SSD1306_CONTROL_DATA, chunk, data);
+            if (ret < 0)
+                return ret;
+            data += chunk;
+            len -= chunk;
+        }
+        return 0;
+    }
+
+    par->tx[0] = SSD1306_CONTROL_DATA;
+    memcpy(par->tx + 1, data, len);
+    return ssd1306_master_send(par, par->tx, len + 1);
+}
+
+// =========================================================================
+// Flush: chuyển vùng hàng [y0, y1] từ định dạng fbdev sang trang SSD1306,
+// so với shadow và chỉ gửi đoạn cột thay đổi của từng trang
+// =========================================================================
+
+static void ssd1306_update_rows(struct ssd1306_par *par, int y0, int y1)
+{
+    const struct ssd1306_panel *panel = par->panel;
+    u32 line_length = par->line_length;
+    struct ssd1306_stats *st = &par->stats;
+    u8 page_buf[SSD1306_MAX_WIDTH];
+    ktime_t start = ktime_get(), now;
+    u64 bytes0;
+    int page, x, k;
+
+    mutex_lock(&par->tx_lock);
+    bytes0 = st->bytes;
+    for (page = y0 / 8; page <= y1 / 8; page++) {
+        const u8 *rows = par->vmem + page * 8 * line_length;
+        int cmin = panel->width, cmax = -1;
+
+        for (x = 0; x < panel->width; x++) {
+            u8 byte = 0;
+
+            for (k = 0; k < 8; k++) {
+                u8 bit = (rows[k * line_length + x / 8] >> (x % 8)) & 1;
+
+                byte |= bit << k;
+            }
+            page_buf[x] = byte;
+            if (!par->shadow_valid || byte != par->shadow[page][x]) {
+                if (x < cmin)
+                    cmin = x;
+                cmax = x;
+            }
+        }
+        if (cmax < 0)
+            continue;
+
+        {
+            const u8 window[] = {
+                0x21, panel->col_offset + cmin, panel->col_offset + cmax,
+                0x22, page, page,
+            };
+
+            if (ssd1306_write_cmds(par, window, sizeof(window)) < 0 ||
+                ssd1306_write_data(par, page_buf + cmin, cmax - cmin + 1) < 0) {
+                dev_err(&par->client->dev, "failed to flush page %d\n", page);
+                par->shadow_valid = false;
+                break;
+            }
+        }
+        memcpy(&par->shadow[page][cmin], page_buf + cmin, cmax - cmin + 1);
+    }
+    if (page > y1 / 8 && y0 == 0 && y1 == panel->height - 1)
+        par->shadow_valid = true;
+
+    if (st->bytes != bytes0) {
+        now = ktime_get();
+        ssd1306_hist_add(&st->flush_ns, ktime_to_ns(ktime_sub(now, start)));
+        ssd1306_hist_add(&st->flush_bytes, st->bytes - bytes0);
+        if (st->flushes) {
+            u64 interval = ktime_to_ns(ktime_sub(now, st->last_frame));
+
+            ssd1306_hist_add(&st->frame_interval_ns, interval);
+            st->frame_avg_ns = st->frame_avg_ns ?
+                st->frame_avg_ns - st->frame_avg_ns / 8 + interval / 8 : interval;
+        }
+        st->last_frame = now;
+        st->flushes++;
+    }
+    mutex_unlock(&par->tx_lock);
+}
+
+// Được fb_deferred_io gọi tối đa refreshrate lần/giây với danh sách trang bộ nhớ đã bị ghi qua mmap
+static void ssd1306_deferred_io(struct fb_info *info, struct list_head *pagereflist)
+{
+    struct ssd1306_par *par = info->par;
+    struct fb_deferred_io_pageref *pageref;
+    int height = par->panel->height;
+    unsigned long flags;
+    int y0, y1;
+
+    spin_lock_irqsave(&par->dirty_lock, flags);
+    y0 = par->dirty_y0;
+    y1 = par->dirty_y1;
+    par->dirty_y0 = height;
+    par->dirty_y1 = -1;
+    spin_unlock_irqrestore(&par->dirty_lock, flags);
+
+    list_for_each_entry(pageref, pagereflist, list) {
+        int start = pageref->offset / par->line_length;
+        int end = (pageref->offset + PAGE_SIZE - 1) / par->line_length;
+
+        y0 = min(y0, start);
+        y1 = max(y1, min(end, height - 1));
+    }
+
+    if (!par->shadow_valid) {
+        y0 = 0;
+        y1 = height - 1;
+    }
+    if (y0 > y1)
+        return;
+    ssd1306_update_rows(par, y0, y1);
+}
+
+// Ghi qua write()/fbcon: đánh dấu vùng hàng và hẹn flush qua cùng hàng đợi của deferred I/O
+static void ssd1306_damage(struct fb_info *info, int y, int height)
+{
+    struct ssd1306_par *par = info->par;
+    unsigned long flags;
+
+    if (height <= 0)
+        return;
+    spin_lock_irqsave(&par->dirty_lock, flags);
+    par->dirty_y0 = min(par->dirty_y0, max(y, 0));
+    par->dirty_y1 = max(par->dirty_y1, min(y + height - 1, (int)par->panel->height - 1));
+    spin_unlock_irqrestore(&par->dirty_lock, flags);
+
+    schedule_delayed_work(&info->deferred_work, info->fbdefio->delay);
+}
+
+static ssize_t ssd1306_fb_write(struct fb_info *info, const char __user *buf,
+                                size_t count, loff_t *ppos)
+{
+    struct ssd1306_par *par = info->par;
+    loff_t start = *ppos;
+    ssize_t ret = fb_sys_write(info, buf, count, ppos);
+
+    if (ret > 0) {
+        int y0 = start / par->line_length;
+        int y1 = (start + ret - 1) / par->line_length;
+
+        ssd1306_damage(info, y0, y1 - y0 + 1);
+    }
+    return ret;
+}
+
+static void ssd1306_fb_fillrect(struct fb_info *info, const struct fb_fillrect *rect)
+{
+    sys_fillrect(info, rect);
+    ssd1306_damage(info, rect->dy, rect->height);
+}
+
+static void ssd1306_fb_copyarea(struct fb_info *info, const struct fb_copyarea *area)
+{
+    sys_copyarea(info, area);
+    ssd1306_damage(info, area->dy, area->height);
+}
+
+static void ssd1306_fb_imageblit(struct fb_info *info, const struct fb_image *image)
+{
+    sys_imageblit(info, image);
+    ssd1306_damage(info, image->dy, image->height);
+}
+
+static const struct fb_ops ssd1306_fbops = {
+    .owner        = THIS_MODULE,
+    .fb_read      = fb_sys_read,
+    .fb_write     = ssd1306_fb_write,
+    .fb_fillrect  = ssd1306_fb_fillrect,
+    .fb_copyarea  = ssd1306_fb_copyarea,
+    .fb_imageblit = ssd1306_fb_imageblit,
+    .fb_mmap      = fb_deferred_io_mmap,
+};
+
+static const struct fb_fix_screeninfo ssd1306_fix = {
+    .id          = "SSD1306",
+    .type        = FB_TYPE_PACKED_PIXELS,
+    .visual      = FB_VISUAL_MONO10,
+    .accel       = FB_ACCEL_NONE,
+};
+
+static const struct fb_var_screeninfo ssd1306_var = {
+    .bits_per_pixel = 1,
+    .red            = { .length = 1 },
+    .green          = { .length = 1 },
+    .blue           = { .length = 1 },
+};
+
+// =========================================================================
+// Probe / remove
+// Thử không cần phần cứng với i2c-stub (chỉ hỗ trợ SMBus -> dùng đường block 32 byte):
+//   modprobe i2c-stub chip_addr=0x3c
+//   echo ssd1306 0x3c > /sys/bus/i2c/devices/i2c-N/new_device
+// =========================================================================
+
+// =========================================================================
+// sysfs: thư mục stats/ của thiết bị I2C
+// =========================================================================
+
+static struct ssd1306_par *ssd1306_dev_par(struct device *dev)
+{
+    struct fb_info *info = dev_get_drvdata(dev);
+
+    return info->par;
+}
+
+#define SSD1306_STAT_ATTR(name)                                                    \
+static ssize_t name##_show(struct device *dev, struct device_attribute *attr, char *buf) \
+{                                                                                  \
+    struct ssd1306_par *par = ssd1306_dev_par(dev);                                \
+    u64 v;                                                                         \
+                                                                                   \
+    mutex_lock(&par->tx_lock);                                                     \
+    v = par->stats.name;                                                           \
+    mutex_unlock(&par->tx_lock);                                                   \
+    return sysfs_emit(buf, "%llu\n", v);                                           \
+}                                                                                  \
+static DEVICE_ATTR_RO(name)
+
+SSD1306_STAT_ATTR(flushes);
+SSD1306_STAT_ATTR(transfers);
+SSD1306_STAT_ATTR(bytes);
+SSD1306_STAT_ATTR(short_writes);
+SSD1306_STAT_ATTR(nacks);
+SSD1306_STAT_ATTR(errors);
+
+static ssize_t ssd1306_hist_show(struct ssd1306_par *par, const struct ssd1306_hist *h, char *buf)
+{
+    struct ssd1306_hist copy;
+    int len, i;
+
+    mutex_lock(&par->tx_lock);
+    copy = *h;
+    mutex_unlock(&par->tx_lock);
+
+    len = sysfs_emit(buf, "%llu %llu %llu", copy.count, copy.sum, copy.max);
+    for (i = 0; i < SSD1306_HIST_BUCKETS; i++)
+        len += sysfs_emit_at(buf, len, " %llu", copy.buckets[i]);
+    return len + sysfs_emit_at(buf, len, "\n");
+}
+
+#define SSD1306_HIST_ATTR(name)                                                    \
+static ssize_t name##_show(struct device *dev, struct device_attribute *attr, char *buf) \
+{                                                                                  \
+    struct ssd1306_par *par = ssd1306_dev_par(dev);                                \
+                                                                                   \
+    return ssd1306_hist_show(par, &par->stats.name, buf);                          \
+}                                                                                  \
+static DEVICE_ATTR_RO(name)
+
+SSD1306_HIST_ATTR(xfer_ns);
+SSD1306_HIST_ATTR(flush_ns);
+SSD1306_HIST_ATTR(flush_bytes);
+SSD1306_HIST_ATTR(frame_interval_ns);
+
+// Khung/giây với một chữ số thập phân
+static ssize_t fps_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    struct ssd1306_par *par = ssd1306_dev_par(dev);
+    u64 avg, fps10;
+    u32 rem;
+
+    mutex_lock(&par->tx_lock);
+    avg = par->stats.frame_avg_ns;
+    mutex_unlock(&par->tx_lock);
+
+    // Không dùng % trên u64: trên ARM 32-bit nó cần __aeabi_uldivmod, kernel không có
+    fps10 = avg ? div64_u64(10ULL * NSEC_PER_SEC, avg) : 0;
+    fps10 = div_u64_rem(fps10, 10, &rem);
+    return sysfs_emit(buf, "%llu.%u\n", fps10, rem);
+}
+static DEVICE_ATTR_RO(fps);
+
+static ssize_t reset_store(struct device *dev, struct device_attribute *attr,
+                           const char *buf, size_t count)
+{
+    struct ssd1306_par *par = ssd1306_dev_par(dev);
+
+    mutex_lock(&par->tx_lock);
+    memset(&par->stats, 0, sizeof(par->stats));
+    mutex_unlock(&par->tx_lock);
+    return count;
+}
+static DEVICE_ATTR_WO(reset);
+
+static struct attribute *ssd1306_stats_attrs[] = {
+    &dev_attr_flushes.attr,
+    &dev_attr_transfers.attr,
+    &dev_attr_bytes.attr,
+    &dev_attr_short_writes.attr,
+    &dev_attr_nacks.attr,
+    &dev_attr_errors.attr,
+    &dev_attr_xfer_ns.attr,
+    &dev_attr_flush_ns.attr,
+    &dev_attr_flush_bytes.attr,
+    &dev_attr_frame_interval_ns.attr,
+    &dev_attr_fps.attr,
+    &dev_attr_reset.attr,
+    NULL,
+};
+
+static const struct attribute_group ssd1306_stats_group = {
+    .name = "stats",
+    .attrs = ssd1306_stats_attrs,
+};
+
+static const struct attribute_group *ssd1306_groups[] = {
+    &ssd1306_stats_group,
+    NULL,
+};
+
+// Loại panel lấy từ device tree (compatible) hoặc driver_data của id-table
+static const struct ssd1306_panel *ssd1306_get_panel(struct i2c_client *client,
+                                                     const struct i2c_device_id *id)
+{
+    const struct ssd1306_panel *panel = device_get_match_data(&client->dev);
+
+    if (panel)
+        return panel;
+    if (id)
+        return &ssd1306_panels[id->driver_data];
+    return &ssd1306_panels[SSD1306_128X64];
+}
+
+// hàm probe  trả về int
+// Chạy bất đồng bộ (PROBE_PREFER_ASYNCHRONOUS) nên không chặn probe của các thiết bị khác
+static int ssd1306_probe(struct i2c_client *client)
+{
+    const struct ssd1306_panel *panel = ssd1306_get_panel(client, i2c_client_get_device_id(client));
+    ktime_t start = ktime_get();
+    struct fb_info *info;
+    struct fb_deferred_io *fbdefio;
+    struct ssd1306_par *par;
+    u32 vmem_size = panel->width / 8 * panel->height;
+    int ret;
+
+    pr_info("SSD1306 I2C device probed\n");
+
+    if (!i2c_check_functionality(client->adapter, I2C_FUNC_SMBUS_BYTE_DATA))
+        return -EOPNOTSUPP;
+
+    info = framebuffer_alloc(sizeof(struct ssd1306_par), &client->dev);
+    if (!info)
+        return -ENOMEM;
+
+    par = info->par;
+    par->info = info;
+    par->client = client;
+    par->panel = panel;
+    par->line_length = panel->width / 8;
+    par->smbus_only = !i2c_check_functionality(client->adapter, I2C_FUNC_I2C);
+    par->dirty_y0 = panel->height;
+    par->dirty_y1 = -1;
+    spin_lock_init(&par->dirty_lock);
+    mutex_init(&par->tx_lock);
+
+    if (par->smbus_only &&
+        !i2c_check_functionality(client->adapter, I2C_FUNC_SMBUS_WRITE_I2C_BLOCK)) {
+        ret = -EOPNOTSUPP;
+        goto fb_release;
+    }
+
+    // Bộ nhớ framebuffer phải là trang vật lý để deferred I/O theo dõi page fault khi mmap
+    par->vmem_order = get_order(vmem_size);
+    par->vmem = (u8 *)__get_free_pages(GFP_KERNEL | __GFP_ZERO, par->vmem_order);
+    if (!par->vmem) {
+        ret = -ENOMEM;
+        goto fb_release;
+    }
+
+    fbdefio = devm_kzalloc(&client->dev, sizeof(*fbdefio), GFP_KERNEL);
+    if (!fbdefio) {
+        ret = -ENOMEM;
+        goto free_vmem;
+    }
+    fbdefio->delay = HZ / max(refreshrate, 1U);
+    fbdefio->deferred_io = ssd1306_deferred_io;
+
+    info->fbops = &ssd1306_fbops;
+    info->fix = ssd1306_fix;
+    info->var = ssd1306_var;
+    info->fix.line_length = par->line_length;
+    info->var.xres = panel->width;
+    info->var.yres = panel->height;
+    info->var.xres_virtual = panel->width;
+    info->var.yres_virtual = panel->height;
+    info->screen_buffer = par->vmem;
+    info->fix.smem_start = __pa(par->vmem);
+    info->fix.smem_len = vmem_size;
+    info->fbdefio = fbdefio;
+
+    ret = fb_deferred_io_init(info);
+    if (ret)
+        goto free_vmem;
+
+    // Gửi lệnh khởi tạo SSD1306 qua I2C
+    ret = ssd1306_send_init(par);
+    if (ret < 0) {
+        dev_err(&client->dev, "failed to send init sequence: %d\n", ret);
+        goto defio_cleanup;
+    }
+
+    i2c_set_clientdata(client, info);
+
+    ret = register_framebuffer(info);
+    if (ret) {
+        dev_err(&client->dev, "failed to register framebuffer: %d\n", ret);
+        goto defio_cleanup;
+    }
+
+    // Nội dung GDDRAM chưa biết -> xóa màn hình bằng một lần flush toàn bộ
+    ssd1306_update_rows(par, 0, panel->height - 1);
+
+    dev_info(&client->dev, "fb%d: %ux%u SSD1306 framebuffer, %u Hz max refresh%s, probe took %lld us\n",
+             info->node, panel->width, panel->height, max(refreshrate, 1U),
+             par->smbus_only ? " (SMBus block writes)" : "",
+             ktime_us_delta(ktime_get(), start));
+    return 0; // Trả về 0 sau khi khởi tạo thành công
+
+defio_cleanup:
+    fb_deferred_io_cleanup(info);
+free_vmem:
+    free_pages((unsigned long)par->vmem, par->vmem_order);
+fb_release:
+    framebuffer_release(info);
+    return ret;
+}
+
+// hàm remove trả về void
+static void ssd1306_remove(struct i2c_client *client)
+{
+    struct fb_info *info = i2c_get_clientdata(client);
+    struct ssd1306_par *par = info->par;
+
+    unregister_framebuffer(info);
+    fb_deferred_io_cleanup(info);
+    i2c_smbus_write_byte_data(client, SSD1306_CONTROL_CMD, 0xAE); // Display OFF
+    free_pages((unsigned long)par->vmem, par->vmem_order);
+    framebuffer_release(info);
+
+    pr_info("SSD1306 I2C device removed\n");
+}
+
+static const struct i2c_device_id ssd1306_id[] = {
+    { "ssd1306", SSD1306_128X64 },
+    { "ssd1306-128x32", SSD1306_128X32 },
+    { "ssd1306-96x16", SSD1306_96X16 },
+    { "ssd1306-64x48", SSD1306_64X48 },
+    { }
+};
+MODULE_DEVICE_TABLE(i2c, ssd1306_id);
+
+static const struct of_device_id ssd1306_of_match[] = {
+    { .compatible = "solomon,ssd1306-128x64", .data = &ssd1306_panels[SSD1306_128X64] },
+    { .compatible = "solomon,ssd1306-128x32", .data = &ssd1306_panels[SSD1306_128X32] },
+    { .compatible = "solomon,ssd1306-96x16",  .data = &ssd1306_panels[SSD1306_96X16] },
+    { .compatible = "solomon,ssd1306-64x48",  .data = &ssd1306_panels[SSD1306_64X48] },
+    { }
+};
+MODULE_DEVICE_TABLE(of, ssd1306_of_match);
+
+static struct i2c_driver ssd1306_driver = {
+    .driver = {
+        .name = "ssd1306",
+        .of_match_table = ssd1306_of_match,
+        .probe_type = PROBE_PREFER_ASYNCHRONOUS,
+        .dev_groups = ssd1306_groups, // stats/ được tạo sau khi probe thành công
+    },
+    .probe = ssd1306_probe,  //  int
+    .remove = ssd1306_remove,  // void
+    .id_table = ssd1306_id,
+};
+
+module_i2c_driver(ssd1306_driver);
+
+MODULE_AUTHOR("Your Name");
+MODULE_DESCRIPTION("SSD1306 OLED I2C Driver for Raspberry Pi");
+MODULE_LICENSE("GPL");
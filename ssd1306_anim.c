@@ -0,0 +1,491 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>           // For clock_nanosleep()
+#include <fcntl.h>          // For open()
+#include <unistd.h>         // For close()
+#include <sys/mman.h>       // For mmap()
+#include <sys/stat.h>       // For fstat()
+
+#if !defined(SSD1306_NO_SIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+#define SSD1306_ANIM_SSE2 1
+#elif !defined(SSD1306_NO_SIMD) && defined(__ARM_NEON) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+// Chỉ dùng intrinsic có trên cả ARMv7 (armhf, NEON 32-bit) lẫn ARMv8 (AArch32/AArch64);
+// thứ tự làn giả định little-endian như mọi bản phân phối ARM
+#include <arm_neon.h>
+#define SSD1306_ANIM_NEON 1
+#endif
+
+#include "ssd1306_anim.h"
+
+// =========================================================================
+// Đổi bố cục: ảnh theo hàng -> trang (8 hàng dọc mỗi byte, bit 0 ở trên)
+// =========================================================================
+
+// Byte thứ b của 8 hàng ghép thành một từ (byte k = hàng k). Hàng ngoài ảnh có mask 0.
+static inline uint64_t anim_gather8(const uint8_t *const *rows, const uint8_t *row_mask, int b) {
+    uint64_t x = 0;
+    for (int k = 0; k < 8; ++k) {
+        x |= (uint64_t)(rows[k][b] & row_mask[k]) << (8 * k);
+    }
+    return x;
+}
+
+// Chuẩn bị con trỏ 8 hàng của một trang; hàng ngoài ảnh trỏ về hàng đầu với mask 0
+static int anim_page_rows(const uint8_t *src, size_t stride, int page, int h,
+                          const uint8_t **rows, uint8_t *row_mask) {
+    int nrows = h - page * 8 < 8 ? h - page * 8 : 8;
+    for (int k = 0; k < 8; ++k) {
+        rows[k] = src + (size_t)(page * 8 + (k < nrows ? k : 0)) * stride;
+        row_mask[k] = k < nrows ? 0xFF : 0x00;
+    }
+    return nrows;
+}
+
+void ssd1306_pack_1bpp(uint8_t *pages, int pw, int ph, const uint8_t *src, size_t stride, int w, int h) {
+    int cw = w < pw ? w : pw;
+    int ch = h < ph ? h : ph;
+    int full = cw / 8;         // số byte nguồn đủ 8 pixel mỗi hàng
+    int tail = cw % 8;
+    memset(pages, 0, (size_t)pw * (ph / 8));
+
+    for (int page = 0; page * 8 < ch; ++page) {
+        const uint8_t *rows[8];
+        uint8_t row_mask[8];
+        anim_page_rows(src, stride, page, ch, rows, row_mask);
+        uint8_t *out = pages + (size_t)page * pw;
+        int b = 0;
+
+#if defined(SSD1306_ANIM_SSE2)
+        // 16 cột mỗi vòng: byte k của vector là hàng k (cột 0-7), byte 8 + k là hàng k (cột 8-15).
+        // movemask lấy bit 7 của mọi byte = cột đang xét của 8 hàng, rồi dịch trái mỗi byte 1 bit.
+        for (; b + 2 <= full; b += 2) {
+            uint8_t tmp[16] __attribute__((aligned(16)));
+            for (int k = 0; k < 8; ++k) {
+                tmp[k] = rows[k][b] & row_mask[k];
+                tmp[8 + k] = rows[k][b + 1] & row_mask[k];
+            }
+            __m128i v = _mm_load_si128((const __m128i *)tmp);
+            for (int c = 0; c < 8; ++c) {
+                int m = _mm_movemask_epi8(v);
+                out[8 * b + c] = (uint8_t)m;
+                out[8 * b + 8 + c] = (uint8_t)(m >> 8);
+                v = _mm_add_epi8(v, v);
+            }
+        }
+#elif defined(SSD1306_ANIM_NEON)
+        // Hai khối 8x8 cùng lúc trong hai làn 64-bit, đảo byte trong làn để cột 0 ở byte thấp
+        for (; b + 2 <= full; b += 2) {
+            uint64x2_t v = vcombine_u64(vcreate_u64(anim_gather8(rows, row_mask, b)),
+                                        vcreate_u64(anim_gather8(rows, row_mask, b + 1)));
+            uint64x2_t t;
+            t = vandq_u64(veorq_u64(v, vshrq_n_u64(v, 7)), vdupq_n_u64(0x00AA00AA00AA00AAULL));
+            v = veorq_u64(v, veorq_u64(t, vshlq_n_u64(t, 7)));
+            t = vandq_u64(veorq_u64(v, vshrq_n_u64(v, 14)), vdupq_n_u64(0x0000CCCC0000CCCCULL));
+            v = veorq_u64(v, veorq_u64(t, vshlq_n_u64(t, 14)));
+            t = vandq_u64(veorq_u64(v, vshrq_n_u64(v, 28)), vdupq_n_u64(0x00000000F0F0F0F0ULL));
+            v = veorq_u64(v, veorq_u64(t, vshlq_n_u64(t, 28)));
+            vst1q_u8(out + 8 * b, vrev64q_u8(vreinterpretq_u8_u64(v)));
+        }
+#endif
+        // Bit 7 của byte nguồn là cột trái nhất -> sau chuyển vị cột c nằm ở byte 7 - c
+        for (; b < full; ++b) {
+            uint64_t x = ssd1306_transpose8x8(anim_gather8(rows, row_mask, b));
+            for (int c = 0; c < 8; ++c) {
+                out[8 * b + c] = (uint8_t)(x >> (8 * (7 - c)));
+            }
+        }
+        if (tail) {
+            uint8_t keep = (uint8_t)(0xFF << (8 - tail)); // bỏ bit đệm cuối hàng
+            uint8_t tail_mask[8];
+            for (int k = 0; k < 8; ++k) tail_mask[k] = row_mask[k] & keep;
+            uint64_t x = ssd1306_transpose8x8(anim_gather8(rows, tail_mask, full));
+            for (int c = 0; c < tail; ++c) {
+                out[8 * full + c] = (uint8_t)(x >> (8 * (7 - c)));
+            }
+        }
+    }
+}
+
+// Ảnh 8 bit -> trang, ngưỡng theo vị trí: pixel (x, 8 * page + k) sáng khi lớn hơn thr[k][x % 16].
+// Ngưỡng cố định là bảng hằng, Bayer là ma trận 8x8 lặp lại.
+static void anim_pack_gray(uint8_t *pages, int pw, int ph, const uint8_t *src, size_t stride, int w, int h,
+                           const uint8_t thr[8][16]) {
+    int cw = w < pw ? w : pw;
+    int ch = h < ph ? h : ph;
+    memset(pages, 0, (size_t)pw * (ph / 8));
+
+    for (int page = 0; page * 8 < ch; ++page) {
+        const uint8_t *rows[8];
+        uint8_t row_mask[8];
+        int nrows = anim_page_rows(src, stride, page, ch, rows, row_mask);
+        uint8_t *out = pages + (size_t)page * pw;
+        int x = 0;
+
+        // Không cần chuyển vị: so ngưỡng 16 pixel của hàng k cho mặt nạ 0x00/0xFF,
+        // AND với bit k rồi OR dồn 8 hàng -> 16 byte trang liền nhau
+#if defined(SSD1306_ANIM_SSE2)
+        const __m128i bias = _mm_set1_epi8((char)0x80); // so sánh không dấu bằng cmpgt có dấu
+        __m128i th[8];
+        for (int k = 0; k < nrows; ++k) {
+            th[k] = _mm_xor_si128(_mm_loadu_si128((const __m128i *)thr[k]), bias);
+        }
+        for (; x + 16 <= cw; x += 16) {
+            __m128i acc = _mm_setzero_si128();
+            for (int k = 0; k < nrows; ++k) {
+                __m128i px = _mm_loadu_si128((const __m128i *)(rows[k] + x));
+                __m128i on = _mm_cmpgt_epi8(_mm_xor_si128(px, bias), th[k]);
+                acc = _mm_or_si128(acc, _mm_and_si128(on, _mm_set1_epi8((char)(1 << k))));
+            }
+            _mm_storeu_si128((__m128i *)(out + x), acc);
+        }
+#elif defined(SSD1306_ANIM_NEON)
+        uint8x16_t th[8];
+        for (int k = 0; k < nrows; ++k) {
+            th[k] = vld1q_u8(thr[k]);
+        }
+        for (; x + 16 <= cw; x += 16) {
+            uint8x16_t acc = vdupq_n_u8(0);
+            for (int k = 0; k < nrows; ++k) {
+                uint8x16_t on = vcgtq_u8(vld1q_u8(rows[k] + x), th[k]);
+                acc = vorrq_u8(acc, vandq_u8(on, vdupq_n_u8((uint8_t)(1 << k))));
+            }
+            vst1q_u8(out + x, acc);
+        }
+#endif
+        for (; x < cw; ++x) {
+            uint8_t v = 0;
+            for (int k = 0; k < nrows; ++k) {
+                v |= (uint8_t)((rows[k][x] > thr[k][x & 15]) << k);
+            }
+            out[x] = v;
+        }
+    }
+}
+
+void ssd1306_pack_8bpp(uint8_t *pages, int pw, int ph, const uint8_t *src, size_t stride, int w, int h,
+                       uint8_t threshold) {
+    uint8_t thr[8][16];
+    memset(thr, threshold, sizeof(thr));
+    anim_pack_gray(pages, pw, ph, src, stride, w, h, thr);
+}
+
+// =========================================================================
+// Dithering: ảnh xám 8 bit -> 1 bit, ghi thẳng bố cục trang
+// =========================================================================
+
+// Ngưỡng Bayer 8x8: chỉ số i (0-63) của ma trận -> 4 * i + 2, mỗi hàng lặp hai lần cho 16 cột.
+// Hàng k của một trang là hàng y % 8 == k của ma trận nên mọi trang dùng chung bảng.
+static const uint8_t anim_bayer_thr[8][16] = {
+    {   2, 130,  34, 162,  10, 138,  42, 170,   2, 130,  34, 162,  10, 138,  42, 170 },
+    { 194,  66, 226,  98, 202,  74, 234, 106, 194,  66, 226,  98, 202,  74, 234, 106 },
+    {  50, 178,  18, 146,  58, 186,  26, 154,  50, 178,  18, 146,  58, 186,  26, 154 },
+    { 242, 114, 210,  82, 250, 122, 218,  90, 242, 114, 210,  82, 250, 122, 218,  90 },
+    {  14, 142,  46, 174,   6, 134,  38, 166,  14, 142,  46, 174,   6, 134,  38, 166 },
+    { 206,  78, 238, 110, 198,  70, 230, 102, 206,  78, 238, 110, 198,  70, 230, 102 },
+    {  62, 190,  30, 158,  54, 182,  22, 150,  62, 190,  30, 158,  54, 182,  22, 150 },
+    { 254, 126, 222,  94, 246, 118, 214,  86, 254, 126, 222,  94, 246, 118, 214,  86 },
+};
+
+// Khuếch tán sai số theo từng hàng. err giữ sai số cho hàng hiện tại và hai hàng sau
+// (Atkinson đẩy xuống hai hàng), lệch 2 cột để x - 1 và x + 2 không cần kiểm tra biên.
+static void anim_dither_diffuse(uint8_t *pages, int pw, int ph, const uint8_t *src, size_t stride,
+                                int w, int h, int method, uint8_t threshold) {
+    int16_t err[3][SSD1306_WIDTH + 4];
+    int cw = w < pw ? w : pw;
+    int ch = h < ph ? h : ph;
+    memset(pages, 0, (size_t)pw * (ph / 8));
+    memset(err, 0, sizeof(err));
+
+    for (int y = 0; y < ch; ++y) {
+        int16_t *e0 = err[y % 3] + 2, *e1 = err[(y + 1) % 3] + 2, *e2 = err[(y + 2) % 3] + 2;
+        const uint8_t *row = src + (size_t)y * stride;
+        uint8_t *out = pages + (size_t)(y / 8) * pw;
+        uint8_t bit = (uint8_t)(1 << (y % 8));
+
+        if (method == SSD1306_DITHER_FLOYD) {
+            // Quét zigzag: hàng lẻ đi từ phải sang trái để sai số không dồn về một phía.
+            // Sai số cho điểm kế tiếp và hàng dưới cộng dồn trong thanh ghi, mỗi ô của e1 chỉ
+            // ghi một lần (không có chuỗi đọc-ghi bộ nhớ giữa các vòng). Quyết định sáng/tắt
+            // không rẽ nhánh vì sau dithering nó gần như ngẫu nhiên.
+            int dir = (y & 1) ? -1 : 1;
+            int x = dir > 0 ? 0 : cw - 1;
+            int carry = 0, below0 = 0, below1 = 0;
+            for (int i = 0; i < cw; ++i, x += dir) {
+                int v = row[x] + e0[x] + carry;
+                int on = v > threshold;
+                int d = v - (-on & 255);
+                out[x] |= bit & (uint8_t)-on;
+                carry = d * 7 / 16;
+                e1[x - dir] = below0 + d * 3 / 16;
+                below0 = below1 + d * 5 / 16;
+                below1 = d / 16;
+            }
+            e1[x - dir] = below0;
+        } else {
+            // Atkinson: 6/8 sai số cho 6 điểm lân cận, phần còn lại bỏ đi (tương phản cao hơn).
+            // e1 đã có phần của hàng trên (qua e2 của nó) nên cộng thêm.
+            int carry1 = 0, carry2 = 0, below0 = 0, below1 = 0;
+            for (int x = 0; x < cw; ++x) {
+                int v = row[x] + e0[x] + carry1;
+                int on = v > threshold;
+                int d = (v - (-on & 255)) / 8;
+                out[x] |= bit & (uint8_t)-on;
+                carry1 = carry2 + d;
+                carry2 = d;
+                e1[x - 1] += below0 + d;
+                below0 = below1 + d;
+                below1 = d;
+                e2[x] += d;
+            }
+            e1[cw - 1] += below0;
+        }
+        memset(e0 - 2, 0, sizeof(err[0])); // hàng này xong, dùng lại cho hàng y + 3
+    }
+}
+
+int ssd1306_dither(uint8_t *pages, int pw, int ph, const uint8_t *src, size_t stride, int w, int h,
+                   int method, uint8_t threshold) {
+    switch (method) {
+    case SSD1306_DITHER_THRESHOLD:
+        ssd1306_pack_8bpp(pages, pw, ph, src, stride, w, h, threshold);
+        return 0;
+    case SSD1306_DITHER_BAYER:
+        anim_pack_gray(pages, pw, ph, src, stride, w, h, anim_bayer_thr);
+        return 0;
+    case SSD1306_DITHER_FLOYD:
+    case SSD1306_DITHER_ATKINSON:
+        if (pw > SSD1306_WIDTH) break;
+        anim_dither_diffuse(pages, pw, ph, src, stride, w, h, method, threshold);
+        return 0;
+    default:
+        break;
+    }
+    fprintf(stderr, "Error: Invalid dither method %d for a %d-column image.\n", method, pw);
+    return -1;
+}
+
+int ssd1306_draw_gray(ssd1306_t *dev, const uint8_t *src, size_t stride, int w, int h, int x, int y,
+                      int method, uint8_t threshold) {
+    uint8_t pages[SSD1306_BUFFER_SIZE];
+    int bw = w < SSD1306_WIDTH ? w : SSD1306_WIDTH;
+    int bh = h < SSD1306_HEIGHT ? h : SSD1306_HEIGHT;
+    if (bw <= 0 || bh <= 0) return 0;
+    if (ssd1306_dither(pages, bw, (bh + 7) / 8 * 8, src, stride, bw, bh, method, threshold) != 0) return -1;
+    ssd1306_blit(dev, pages, bw, bh, x, y, SSD1306_BLIT_COPY);
+    return 0;
+}
+
+// =========================================================================
+// Nguồn khung: file mmap
+// =========================================================================
+
+static int anim_map(ssd1306_frames_t *f, const char *path) {
+    struct stat st;
+    memset(f, 0, sizeof(*f));
+    f->fd = open(path, O_RDONLY);
+    if (f->fd < 0) {
+        perror("Failed to open frame file");
+        return -1;
+    }
+    if (fstat(f->fd, &st) != 0 || st.st_size == 0) {
+        fprintf(stderr, "Error: frame file %s is empty or unreadable.\n", path);
+        close(f->fd);
+        return -1;
+    }
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, f->fd, 0);
+    if (p == MAP_FAILED) {
+        perror("Failed to mmap frame file");
+        close(f->fd);
+        return -1;
+    }
+    madvise(p, (size_t)st.st_size, MADV_WILLNEED); // hoạt ảnh phát lặp: giữ cả file trong page cache
+    f->map = p;
+    f->map_len = (size_t)st.st_size;
+    return 0;
+}
+
+static int anim_add_frame(ssd1306_frames_t *f, size_t offset, size_t *cap) {
+    if (f->frame_count == *cap) {
+        size_t new_cap = *cap ? *cap * 2 : 64;
+        size_t *p = realloc(f->offsets, new_cap * sizeof(*p));
+        if (p == NULL) return -1;
+        f->offsets = p;
+        *cap = new_cap;
+    }
+    f->offsets[f->frame_count++] = offset;
+    return 0;
+}
+
+// Đọc một số trong header netpbm, bỏ qua khoảng trắng và chú thích '#'
+static int anim_header_int(const ssd1306_frames_t *f, size_t *pos, int *value) {
+    const uint8_t *p = f->map;
+    size_t i = *pos;
+    for (;;) {
+        while (i < f->map_len && (p[i] == ' ' || p[i] == '\t' || p[i] == '\n' || p[i] == '\r')) i++;
+        if (i < f->map_len && p[i] == '#') {
+            while (i < f->map_len && p[i] != '\n') i++;
+            continue;
+        }
+        break;
+    }
+    if (i >= f->map_len || p[i] < '0' || p[i] > '9') return -1;
+    long v = 0;
+    while (i < f->map_len && p[i] >= '0' && p[i] <= '9' && v < 65536) v = v * 10 + (p[i++] - '0');
+    *value = (int)v;
+    *pos = i;
+    return 0;
+}
+
+int ssd1306_frames_open(ssd1306_frames_t *f, const char *path) {
+    if (anim_map(f, path) != 0) return -1;
+
+    size_t pos = 0, cap = 0;
+    while (pos + 2 <= f->map_len) {
+        int type = f->map[pos] == 'P' ? f->map[pos + 1] : 0;
+        int w, h, maxval = 1;
+        pos += 2;
+        if ((type != '4' && type != '5') ||
+            anim_header_int(f, &pos, &w) != 0 || anim_header_int(f, &pos, &h) != 0 ||
+            (type == '5' && anim_header_int(f, &pos, &maxval) != 0) ||
+            w <= 0 || h <= 0 || maxval <= 0 || maxval > 255 || pos >= f->map_len) {
+            fprintf(stderr, "Error: %s frame %zu is not a binary PBM (P4) or 8-bit PGM (P5).\n",
+                    path, f->frame_count);
+            ssd1306_frames_close(f);
+            return -1;
+        }
+        pos++; // đúng một khoảng trắng trước dữ liệu ảnh
+
+        int bpp = type == '4' ? 1 : 8;
+        if (f->frame_count == 0) {
+            f->width = w;
+            f->height = h;
+            f->bpp = bpp;
+            f->stride = bpp == 1 ? (size_t)(w + 7) / 8 : (size_t)w;
+            f->threshold = (uint8_t)(maxval / 2);
+        } else if (w != f->width || h != f->height || bpp != f->bpp) {
+            fprintf(stderr, "Error: %s frame %zu has a different size or type.\n", path, f->frame_count);
+            ssd1306_frames_close(f);
+            return -1;
+        }
+        size_t size = f->stride * (size_t)h;
+        if (size > f->map_len - pos) {
+            fprintf(stderr, "Error: %s frame %zu is truncated.\n", path, f->frame_count);
+            ssd1306_frames_close(f);
+            return -1;
+        }
+        if (anim_add_frame(f, pos, &cap) != 0) {
+            ssd1306_frames_close(f);
+            return -1;
+        }
+        pos += size;
+        // Cho phép khoảng trắng giữa các ảnh nối nhau
+        while (pos < f->map_len && (f->map[pos] == '\n' || f->map[pos] == ' ' || f->map[pos] == '\r')) pos++;
+    }
+    if (f->frame_count == 0) {
+        fprintf(stderr, "Error: %s contains no frames.\n", path);
+        ssd1306_frames_close(f);
+        return -1;
+    }
+    return 0;
+}
+
+int ssd1306_frames_open_raw(ssd1306_frames_t *f, const char *path, int width, int height, int bpp) {
+    if (width <= 0 || height <= 0 || (bpp != 1 && bpp != 8)) {
+        fprintf(stderr, "Error: invalid raw frame format %dx%d, %d bpp.\n", width, height, bpp);
+        return -1;
+    }
+    if (anim_map(f, path) != 0) return -1;
+
+    f->width = width;
+    f->height = height;
+    f->bpp = bpp;
+    f->stride = bpp == 1 ? (size_t)(width + 7) / 8 : (size_t)width;
+    f->threshold = 127;
+    size_t size = f->stride * (size_t)height, cap = 0;
+    for (size_t pos = 0; pos + size <= f->map_len; pos += size) {
+        if (anim_add_frame(f, pos, &cap) != 0) {
+            ssd1306_frames_close(f);
+            return -1;
+        }
+    }
+    if (f->frame_count == 0) {
+        fprintf(stderr, "Error: %s is smaller than one %dx%d frame.\n", path, width, height);
+        ssd1306_frames_close(f);
+        return -1;
+    }
+    return 0;
+}
+
+void ssd1306_frames_close(ssd1306_frames_t *f) {
+    if (f->map != NULL) munmap((void *)f->map, f->map_len);
+    if (f->fd >= 0) close(f->fd);
+    free(f->offsets);
+    memset(f, 0, sizeof(*f));
+    f->fd = -1;
+}
+
+void ssd1306_frames_convert(const ssd1306_frames_t *f, size_t idx, uint8_t *pages) {
+    const uint8_t *src = f->map + f->offsets[idx];
+    if (f->bpp == 1) {
+        ssd1306_pack_1bpp(pages, SSD1306_WIDTH, SSD1306_HEIGHT, src, f->stride, f->width, f->height);
+    } else {
+        ssd1306_dither(pages, SSD1306_WIDTH, SSD1306_HEIGHT, src, f->stride, f->width, f->height,
+                       f->dither, f->threshold);
+    }
+}
+
+// =========================================================================
+// Phát theo lịch
+// =========================================================================
+
+static uint64_t anim_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int ssd1306_anim_play(ssd1306_t *dev, const ssd1306_frames_t *f, double fps, int loops,
+                      ssd1306_play_stats_t *stats) {
+    if (fps <= 0 || f->frame_count == 0) {
+        fprintf(stderr, "Error: Invalid arguments for anim_play.\n");
+        return -1;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    uint8_t pages[SSD1306_BUFFER_SIZE];
+    uint64_t period = (uint64_t)(1e9 / fps);
+    uint64_t total = loops > 0 ? (uint64_t)loops * f->frame_count : 0;
+    uint64_t t0 = anim_now_ns();
+
+    for (uint64_t n = 0; total == 0 || n < total; ++n) {
+        uint64_t due = t0 + n * period;
+        struct timespec ts = { (time_t)(due / 1000000000ULL), (long)(due % 1000000000ULL) };
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+        }
+
+        // Chậm hơn lịch từ một khung trở lên: nhảy tới khung đúng lịch
+        uint64_t now = anim_now_ns();
+        uint64_t on_time = (now - t0) / period;
+        if (on_time > n) {
+            stats->skipped += on_time - n;
+            n = on_time;
+            if (total != 0 && n >= total) break;
+            due = t0 + n * period;
+        }
+        if (now - due > stats->max_late_ns) stats->max_late_ns = now - due;
+
+        uint64_t c0 = ssd1306_cpu_time_ns();
+        ssd1306_frames_convert(f, n % f->frame_count, pages);
+        stats->convert_ns += ssd1306_cpu_time_ns() - c0;
+        stats->changed_bytes += ssd1306_load_frame(dev, pages);
+
+        int rc = atomic_load(&dev->bus->flusher_running) ? ssd1306_present(dev) : (ssd1306_display_buffer(dev) < 0 ? -1 : 0);
+        if (rc != 0) return -1;
+        stats->shown++;
+    }
+    return 0;
+}
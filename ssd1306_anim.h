@@ -0,0 +1,89 @@
+#ifndef SSD1306_ANIM_H
+#define SSD1306_ANIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "ssd1306_c_driver.h"
+
+// =========================================================================
+// Phát hoạt ảnh / ảnh camera lên SSD1306
+// Nguồn khung là một file được mmap:
+//   - chuỗi ảnh PBM nhị phân (P4, 1 bit/pixel) hoặc PGM (P5, 8 bit/pixel) nối liền nhau
+//   - file raw không header: các khung W x H liền nhau, 1 bit (hàng đệm tới byte, bit 7
+//     là pixel trái nhất như PBM) hoặc 8 bit/pixel
+// Mỗi khung theo hàng (row-major) được đổi sang bố cục trang của display_buffer bằng
+// phép chuyển vị ma trận bit 8x8 (SSE2 / NEON, bản vô hướng khi không có SIMD hoặc
+// biên dịch với -DSSD1306_NO_SIMD), thay cho 8192 lần gọi ssd1306_draw_pixel().
+// Ảnh 8 bit qua ngưỡng cố định hoặc một trong các kiểu dithering bên dưới.
+// =========================================================================
+
+typedef struct {
+    int fd;
+    const uint8_t *map;     // toàn bộ file, chỉ đọc
+    size_t map_len;
+    int width, height;
+    int bpp;                // 1 hoặc 8
+    size_t stride;          // byte mỗi hàng
+    uint8_t threshold;      // ảnh 8 bit: pixel > threshold thì sáng
+    size_t frame_count;
+    size_t *offsets;        // vị trí dữ liệu ảnh của từng khung trong map
+    int dither;             // ảnh 8 bit: SSD1306_DITHER_* (mặc định ngưỡng cố định)
+} ssd1306_frames_t;
+
+// Mở chuỗi PBM/PGM. Trả về 0/-1.
+int ssd1306_frames_open(ssd1306_frames_t *f, const char *path);
+// Mở file raw gồm các khung width x height, bpp = 1 hoặc 8. Trả về 0/-1.
+int ssd1306_frames_open_raw(ssd1306_frames_t *f, const char *path, int width, int height, int bpp);
+void ssd1306_frames_close(ssd1306_frames_t *f);
+
+// Đổi khung idx sang bố cục trang SSD1306_WIDTH x SSD1306_HEIGHT (SSD1306_BUFFER_SIZE byte).
+// Ảnh đặt ở góc trên trái, phần thừa bị cắt, phần thiếu là pixel tắt.
+void ssd1306_frames_convert(const ssd1306_frames_t *f, size_t idx, uint8_t *pages);
+
+// Đổi ảnh theo hàng w x h sang bố cục trang pw x ph (ph là bội của 8)
+void ssd1306_pack_1bpp(uint8_t *pages, int pw, int ph, const uint8_t *src, size_t stride, int w, int h);
+void ssd1306_pack_8bpp(uint8_t *pages, int pw, int ph, const uint8_t *src, size_t stride, int w, int h,
+                       uint8_t threshold);
+
+// =========================================================================
+// Dithering ảnh xám 8 bit -> 1 bit, ghi thẳng bố cục trang
+//   THRESHOLD : pixel > threshold thì sáng
+//   BAYER     : ngưỡng theo ma trận Bayer 8x8, 16 pixel mỗi lệnh so sánh SIMD
+//   FLOYD     : Floyd-Steinberg, quét zigzag từng hàng
+//   ATKINSON  : Atkinson (chỉ khuếch tán 6/8 sai số, giữ tương phản cho ảnh nhỏ)
+// Hai kiểu khuếch tán sai số đi từng hàng với bộ đệm sai số 3 hàng, cần pw <= SSD1306_WIDTH.
+// Chi phí một khung 128x64 (cả vẽ lẫn flush, cpu_ns_per_frame của ssd1306_bench -c dither_*),
+// đo trên máy phát triển x86-64: Bayer ~3 us, Floyd/Atkinson ~40-50 us. Chưa đo trên
+// Cortex-A53 hay Raspberry Pi; chạy lại bench trên thiết bị đích thay vì suy ra từ số này.
+// =========================================================================
+
+#define SSD1306_DITHER_THRESHOLD 0
+#define SSD1306_DITHER_BAYER     1
+#define SSD1306_DITHER_FLOYD     2
+#define SSD1306_DITHER_ATKINSON  3
+
+// Như ssd1306_pack_8bpp() nhưng chọn kiểu dithering. Trả về 0/-1.
+int ssd1306_dither(uint8_t *pages, int pw, int ph, const uint8_t *src, size_t stride, int w, int h,
+                   int method, uint8_t threshold);
+// Vẽ ảnh xám w x h vào display_buffer tại (x, y) (chỉ đánh dấu bẩn vùng ảnh). threshold như
+// ssd1306_dither() (THRESHOLD, FLOYD, ATKINSON; BAYER bỏ qua). Trả về 0/-1.
+int ssd1306_draw_gray(ssd1306_t *dev, const uint8_t *src, size_t stride, int w, int h, int x, int y,
+                      int method, uint8_t threshold);
+
+typedef struct {
+    uint64_t shown;         // số khung đã gửi
+    uint64_t skipped;       // số khung bỏ qua vì chậm hơn lịch
+    uint64_t changed_bytes; // tổng số byte khác khung trước
+    uint64_t convert_ns;    // thời gian CPU đổi bố cục
+    uint64_t max_late_ns;   // trễ lớn nhất so với lịch khi bắt đầu một khung
+} ssd1306_play_stats_t;
+
+// Phát các khung ở fps khung/giây, loops vòng (0: lặp mãi). Lịch tính theo thời điểm
+// tuyệt đối; khi chậm hơn một khung trở lên thì nhảy tới khung đúng lịch và bỏ các khung
+// ở giữa. Mỗi khung chỉ gửi các byte khác khung trước (ssd1306_load_frame()). Khi bus đang
+// chạy luồng flush nền thì khung được present(), ngược lại flush đồng bộ. Trả về 0/-1.
+int ssd1306_anim_play(ssd1306_t *dev, const ssd1306_frames_t *f, double fps, int loops,
+                      ssd1306_play_stats_t *stats);
+
+#endif // SSD1306_ANIM_H
@@ -0,0 +1,650 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>         // For getopt()
+
+#include "ssd1306_c_driver.h"
+#include "ssd1306_emu.h"
+#include "ssd1306_anim.h"
+#include "ssd1306_console.h"
+#include "ssd1306_compositor.h"
+#include "ssd1306_portrait.h"
+
+// =========================================================================
+// Benchmark cho driver SSD1306 userspace trên bus mô phỏng (backend mem)
+// Mỗi trường hợp chạy N khung; mỗi khung = thao tác vẽ + flush như ứng dụng thật.
+// Kết quả in ra stdout, mỗi trường hợp một dòng JSON (JSON Lines):
+//   fps                : số khung/giây của CPU (bus mô phỏng không ngủ)
+//   bus_fps            : số khung/giây tối đa mà bus thật ở tốc độ bus_hz cho phép
+//   bytes_per_frame    : byte lên bus (kể cả control byte, không kể byte địa chỉ)
+//   txns_per_frame     : số giao dịch I2C trên bus mô phỏng. Backend dev tốn một write() cho mỗi
+//                        giao dịch; rdwr gom nhiều giao dịch chia nhỏ vào một ioctl() nên có thể ít hơn
+//   cpu_ns_per_frame   : thời gian CPU của luồng benchmark
+//   bus_us_per_frame   : thời gian chiếm bus mô phỏng
+//
+// So sánh với kết quả cũ: -B FILE, theo cặp (trường hợp, kích thước panel). Byte và giao dịch là tất định nên chỉ cần tăng
+// là tính hồi quy; thời gian CPU được phép dao động trong -t phần trăm.
+//
+// Kiểm tra đúng đắn: -e gắn bộ mô phỏng SSD1306 vào bus và sau mỗi khung so từng pixel
+// ảnh trên panel với một lần gửi nguyên khung đơn giản (0x21/0x22 + 1024 byte dữ liệu).
+// Khung sai đầu tiên của mỗi trường hợp được ghi ra bench-<tên>-got.pbm / -want.pbm.
+// Thời gian CPU khi chạy -e gồm cả bộ mô phỏng, không dùng để so hồi quy.
+// -m N: bus mô phỏng từ chối giao dịch dài hơn N byte như adapter có giới hạn
+// (ví dụ 33 cho ghi khối SMBus), để đo và kiểm tra đường chia nhỏ giao dịch.
+// Cách dùng: ./ssd1306_bench [-n khung] [-b bus_hz] [-c trường_hợp] [-v] [-e] [-m max_xfer] [-B baseline] [-t PCT]
+// =========================================================================
+
+#define BENCH_DEFAULT_FRAMES     2000
+#define BENCH_DEFAULT_TOLERANCE  25.0
+#define BENCH_MAX_CASES          32
+
+typedef struct {
+    const char *name;
+    int frames_div;                          // chia số khung (trường hợp chậm chạy ít khung hơn)
+    int verify;                              // sau mỗi khung panel phải khớp display_buffer
+    int (*frame)(ssd1306_t *dev, int i);     // vẽ + flush một khung, trả về -1 nếu lỗi
+} bench_case_t;
+
+typedef struct {
+    char name[32];
+    int width, height;                       // panel lúc đo
+    int frames;
+    double fps, bus_fps;
+    double bytes_per_frame, txns_per_frame, cpu_ns_per_frame, bus_us_per_frame;
+    int verified_frames, mismatch_frames;    // chỉ khi chạy với -e
+    uint64_t protocol_errors;
+} bench_result_t;
+
+// Sinh số giả ngẫu nhiên cố định (LCG) để mọi lần chạy vẽ cùng một chuỗi pixel
+static uint32_t bench_rand_state;
+
+static uint32_t bench_rand(void) {
+    bench_rand_state = bench_rand_state * 1664525u + 1013904223u;
+    return bench_rand_state >> 8;
+}
+
+// =========================================================================
+// Các trường hợp đo
+// =========================================================================
+
+static int bench_init(ssd1306_t *dev, int i) {
+    (void)i;
+    return ssd1306_init(dev);
+}
+
+static int bench_full_flush(ssd1306_t *dev, int i) {
+    (void)i;
+    return ssd1306_display_buffer_full(dev) < 0 ? -1 : 0;
+}
+
+// Một khối 16x16 chạy qua màn hình: đảo ô mới và ô cũ, chỉ gửi vùng thay đổi
+static int bench_partial(ssd1306_t *dev, int i) {
+    int x = (i * 3) % (dev->width - 16);
+    int y = (i * 5) % (dev->height > 16 ? dev->height - 16 : 1);
+    ssd1306_invert_rect(dev, x, y, 16, 16);
+    return ssd1306_display_buffer(dev) < 0 ? -1 : 0;
+}
+
+// Một dòng trạng thái 5x7 cập nhật mỗi khung, y không chia hết cho 8
+static int bench_text_5x7(ssd1306_t *dev, int i) {
+    char text[32];
+    snprintf(text, sizeof(text), "frame %06d T=%2d.%dC", i, 20 + i % 10, i % 10);
+    ssd1306_draw_string(dev, &ssd1306_font_5x7, 0, 3 + (i % 5) * 11, text, SSD1306_BLIT_COPY);
+    return ssd1306_display_buffer(dev) < 0 ? -1 : 0;
+}
+
+static int bench_text_8x16(ssd1306_t *dev, int i) {
+    char text[32];
+    snprintf(text, sizeof(text), "%02d:%02d:%02d", i / 3600 % 24, i / 60 % 60, i % 60);
+    ssd1306_draw_string(dev, &ssd1306_font_8x16, 32, 24, text, SSD1306_BLIT_COPY);
+    return ssd1306_display_buffer(dev) < 0 ? -1 : 0;
+}
+
+// 64 pixel rải rác mỗi khung: trường hợp xấu nhất cho bộ lập kế hoạch cửa sổ
+static int bench_pixels_scatter(ssd1306_t *dev, int i) {
+    for (int k = 0; k < 64; ++k) {
+        uint32_t r = bench_rand();
+        ssd1306_draw_pixel(dev, r % dev->width, (r >> 8) % dev->height, i & 1);
+    }
+    return ssd1306_display_buffer(dev) < 0 ? -1 : 0;
+}
+
+// Vẽ từng pixel toàn màn hình rồi flush: chi phí của ssd1306_draw_pixel()
+static int bench_pixels_full(ssd1306_t *dev, int i) {
+    const int w = dev->width, h = dev->height;
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            ssd1306_draw_pixel(dev, x, y, ((x ^ y ^ i) & 1));
+        }
+    }
+    return ssd1306_display_buffer(dev) < 0 ? -1 : 0;
+}
+
+// Nhật ký cuộn: dịch 8 hàng bằng start line rồi vẽ dòng mới ở đáy
+static int bench_scroll_log(ssd1306_t *dev, int i) {
+    char text[32];
+    snprintf(text, sizeof(text), "log line %d", i);
+    if (ssd1306_pan(dev, 8) != 0) return -1;
+    ssd1306_fill_rect(dev, 0, dev->height - 8, dev->width, 8, SSD1306_COLOR_BLACK);
+    ssd1306_draw_string(dev, &ssd1306_font_5x7, 0, dev->height - 8, text, SSD1306_BLIT_OR);
+    return ssd1306_display_buffer(dev) < 0 ? -1 : 0;
+}
+
+// Console chữ 21x8: bảng trạng thái với vài trường đổi mỗi khung (đồng hồ, bộ đếm, cờ đảo màu)
+static ssd1306_console_t bench_con;
+
+static int bench_console_status(ssd1306_t *dev, int i) {
+    char text[32];
+    if (i == 0) {
+        ssd1306_console_init(&bench_con, dev);
+        ssd1306_console_write(&bench_con, "STATUS\nuptime\nrx pkts\ntx pkts\ncpu\nmem\nlink\nlast err");
+    }
+    snprintf(text, sizeof(text), "%02d:%02d:%02d", i / 3600 % 24, i / 60 % 60, i % 60);
+    ssd1306_console_print_at(&bench_con, 1, 10, SSD1306_ATTR_NORMAL, text);
+    snprintf(text, sizeof(text), "%9d", i * 7);
+    ssd1306_console_print_at(&bench_con, 2, 10, SSD1306_ATTR_NORMAL, text);
+    snprintf(text, sizeof(text), "%9d", i * 3);
+    ssd1306_console_print_at(&bench_con, 3, 10, SSD1306_ATTR_NORMAL, text);
+    snprintf(text, sizeof(text), "%3d%%", (i * 13) % 100);
+    ssd1306_console_print_at(&bench_con, 4, 10, SSD1306_ATTR_NORMAL, text);
+    ssd1306_console_print_at(&bench_con, 6, 10, (i / 16) & 1 ? SSD1306_ATTR_INVERSE : SSD1306_ATTR_NORMAL,
+                             (i / 16) & 1 ? "DOWN" : "UP  ");
+    return ssd1306_console_update(&bench_con) < 0 ? -1 : 0;
+}
+
+// Nhật ký trên console: mỗi khung một dòng mới, cuộn bằng start line, dòng đầu gạch chân
+static int bench_console_log(ssd1306_t *dev, int i) {
+    if (i == 0) {
+        ssd1306_console_init(&bench_con, dev);
+    }
+    ssd1306_console_set_attr(&bench_con, i % 8 == 0 ? SSD1306_ATTR_UNDERLINE : SSD1306_ATTR_NORMAL);
+    ssd1306_console_printf(&bench_con, "%slog line %d", i ? "\n" : "", i);
+    return ssd1306_console_update(&bench_con) < 0 ? -1 : 0;
+}
+
+// Bộ ghép lớp: nền tĩnh (sọc chéo + chữ) với con trỏ nhấp nháy, biểu tượng quay 16x16
+// và huy hiệu có mask chạy ngang. comp_overlay chỉ ghép lại phần thay đổi; comp_redraw
+// là cách làm cũ: mỗi khung chép lại nền và vẽ lại mọi phần tử rồi so cả khung.
+#define BENCH_SPINNER_FRAMES 8
+
+static uint8_t bench_comp_bg[SSD1306_BUFFER_SIZE];
+static uint8_t bench_spinner[BENCH_SPINNER_FRAMES][2 * 16], bench_spinner_mask[2 * 16];
+static uint8_t bench_badge[2 * 24], bench_badge_mask[2 * 24];
+static uint8_t bench_spinner_hole[2 * 16], bench_badge_hole[2 * 24]; // mask đảo, để xóa nền bằng BLIT_AND
+static const uint8_t bench_cursor[2] = { 0xFF, 0xFF };
+static ssd1306_compositor_t bench_comp;
+static int bench_comp_ids[3];
+
+static void bench_set_px(uint8_t *bitmap, int w, int x, int y) {
+    bitmap[(y >> 3) * w + x] |= (uint8_t)(1 << (y & 7));
+}
+
+static void bench_comp_setup(ssd1306_t *dev) {
+    for (int y = 0; y < 16; ++y) {
+        for (int x = 0; x < 16; ++x) {
+            int dx = 2 * x - 15, dy = 2 * y - 15, d2 = dx * dx + dy * dy;
+            if (d2 > 256) continue;
+            bench_set_px(bench_spinner_mask, 16, x, y);
+            for (int f = 0; f < BENCH_SPINNER_FRAMES; ++f) {
+                // Vành tròn với một cung đặc quay 45 độ mỗi khung
+                int octant = ((dy >= 0) << 2) | ((dx >= 0) << 1) | (abs(dx) >= abs(dy));
+                if (d2 > 144 || octant == f) bench_set_px(bench_spinner[f], 16, x, y);
+            }
+        }
+    }
+    for (int y = 0; y < 12; ++y) {
+        for (int x = 0; x < 24; ++x) {
+            int corner = (x < 2 || x > 21) && (y < 2 || y > 9);
+            if (corner) continue;
+            bench_set_px(bench_badge_mask, 24, x, y);
+            if (!(x >= 11 && x <= 12 && (y <= 6 || y == 9))) bench_set_px(bench_badge, 24, x, y); // dấu "!"
+        }
+    }
+    for (int k = 0; k < 2 * 16; ++k) bench_spinner_hole[k] = (uint8_t)~bench_spinner_mask[k];
+    for (int k = 0; k < 2 * 24; ++k) bench_badge_hole[k] = (uint8_t)~bench_badge_mask[k];
+
+    ssd1306_clear_buffer(dev);
+    for (int x = -dev->height; x < dev->width; x += 8) {
+        for (int y = 0; y < dev->height; ++y) {
+            if (x + y >= 0 && x + y < dev->width) ssd1306_draw_pixel(dev, x + y, y, 1);
+        }
+    }
+    ssd1306_fill_rect(dev, 0, 0, 80, 12, SSD1306_COLOR_BLACK);
+    ssd1306_draw_string(dev, &ssd1306_font_5x7, 2, 2, "status: OK", SSD1306_BLIT_COPY);
+    memcpy(bench_comp_bg, dev->display_buffer, SSD1306_BUFFER_SIZE);
+}
+
+static void bench_comp_positions(const ssd1306_t *dev, int i, int *badge_x, int *cursor_on) {
+    *badge_x = i % (dev->width + 24) - 24;
+    *cursor_on = (i / 4) & 1;
+}
+
+static int bench_comp_overlay(ssd1306_t *dev, int i) {
+    int badge_x, cursor_on;
+    if (i == 0) {
+        bench_comp_setup(dev);
+        ssd1306_comp_init(&bench_comp, dev);
+        bench_comp_ids[0] = ssd1306_comp_add_sprite(&bench_comp, bench_cursor, NULL, 2, 8, 64, 2, 2, SSD1306_BLIT_XOR);
+        bench_comp_ids[1] = ssd1306_comp_add_sprite(&bench_comp, bench_spinner[0], bench_spinner_mask,
+                                                    16, 16, dev->width - 20, 2, 1, SSD1306_BLIT_COPY);
+        bench_comp_ids[2] = ssd1306_comp_add_sprite(&bench_comp, bench_badge, bench_badge_mask,
+                                                    24, 12, -24, 45, 0, SSD1306_BLIT_COPY);
+    }
+    bench_comp_positions(dev, i, &badge_x, &cursor_on);
+    ssd1306_comp_show(&bench_comp, bench_comp_ids[0], cursor_on);
+    ssd1306_comp_set_bitmap(&bench_comp, bench_comp_ids[1], bench_spinner[i % BENCH_SPINNER_FRAMES], bench_spinner_mask);
+    ssd1306_comp_move(&bench_comp, bench_comp_ids[2], badge_x, 45);
+    return ssd1306_comp_update(&bench_comp) < 0 ? -1 : 0;
+}
+
+// Cùng hình như comp_overlay, vẽ lại toàn bộ mỗi khung
+static int bench_comp_redraw(ssd1306_t *dev, int i) {
+    static uint8_t frame[SSD1306_BUFFER_SIZE];
+    int badge_x, cursor_on;
+    if (i == 0) {
+        bench_comp_setup(dev);
+    }
+    bench_comp_positions(dev, i, &badge_x, &cursor_on);
+    uint8_t *saved = dev->display_buffer;
+    memcpy(frame, bench_comp_bg, SSD1306_BUFFER_SIZE);
+    dev->display_buffer = frame; // vẽ vào khung tạm rồi so với khung đang hiển thị
+    ssd1306_blit(dev, bench_badge_hole, 24, 12, badge_x, 45, SSD1306_BLIT_AND);
+    ssd1306_blit(dev, bench_badge, 24, 12, badge_x, 45, SSD1306_BLIT_OR);
+    ssd1306_blit(dev, bench_spinner_hole, 16, 16, dev->width - 20, 2, SSD1306_BLIT_AND);
+    ssd1306_blit(dev, bench_spinner[i % BENCH_SPINNER_FRAMES], 16, 16, dev->width - 20, 2, SSD1306_BLIT_OR);
+    if (cursor_on) ssd1306_blit(dev, bench_cursor, 2, 8, 64, 2, SSD1306_BLIT_XOR);
+    dev->display_buffer = saved;
+    ssd1306_load_frame(dev, frame);
+    return ssd1306_display_buffer(dev) < 0 ? -1 : 0;
+}
+
+// Hoạt ảnh dựng sẵn theo hàng (như file PGM/PBM): vòng tròn rỗng chạy ngang trên nền sọc chéo cố định.
+// Mỗi khung: đổi bố cục trang + chỉ gửi byte khác khung trước, so với pixels_full vẽ từng pixel.
+#define BENCH_ANIM_FRAMES 32
+
+static uint8_t bench_anim_gray[BENCH_ANIM_FRAMES][SSD1306_HEIGHT][SSD1306_WIDTH];
+static uint8_t bench_anim_mono[BENCH_ANIM_FRAMES][SSD1306_HEIGHT][SSD1306_WIDTH / 8];
+static size_t bench_anim_gray_offsets[BENCH_ANIM_FRAMES], bench_anim_mono_offsets[BENCH_ANIM_FRAMES];
+static ssd1306_frames_t bench_anim_gray_src, bench_anim_mono_src;
+static ssd1306_frames_t bench_dither_bayer_src, bench_dither_floyd_src, bench_dither_atkinson_src;
+
+static void bench_anim_setup(void) {
+    for (int f = 0; f < BENCH_ANIM_FRAMES; ++f) {
+        int cx = 16 + f * 3, cy = SSD1306_HEIGHT / 2;
+        for (int y = 0; y < SSD1306_HEIGHT; ++y) {
+            for (int x = 0; x < SSD1306_WIDTH; ++x) {
+                int d2 = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+                uint8_t g = d2 < 100 ? 0 : d2 < 256 ? 255 : (((x + y) & 16) ? 200 : 40);
+                bench_anim_gray[f][y][x] = g;
+                if (g > 127) bench_anim_mono[f][y][x / 8] |= (uint8_t)(0x80 >> (x % 8));
+            }
+        }
+        bench_anim_gray_offsets[f] = (size_t)f * sizeof(bench_anim_gray[0]);
+        bench_anim_mono_offsets[f] = (size_t)f * sizeof(bench_anim_mono[0]);
+    }
+    bench_anim_gray_src = (ssd1306_frames_t){ -1, &bench_anim_gray[0][0][0], sizeof(bench_anim_gray),
+        SSD1306_WIDTH, SSD1306_HEIGHT, 8, SSD1306_WIDTH, 127, BENCH_ANIM_FRAMES, bench_anim_gray_offsets,
+        SSD1306_DITHER_THRESHOLD };
+    bench_anim_mono_src = (ssd1306_frames_t){ -1, &bench_anim_mono[0][0][0], sizeof(bench_anim_mono),
+        SSD1306_WIDTH, SSD1306_HEIGHT, 1, SSD1306_WIDTH / 8, 0, BENCH_ANIM_FRAMES, bench_anim_mono_offsets,
+        SSD1306_DITHER_THRESHOLD };
+    bench_dither_bayer_src = bench_anim_gray_src;
+    bench_dither_bayer_src.dither = SSD1306_DITHER_BAYER;
+    bench_dither_floyd_src = bench_anim_gray_src;
+    bench_dither_floyd_src.dither = SSD1306_DITHER_FLOYD;
+    bench_dither_atkinson_src = bench_anim_gray_src;
+    bench_dither_atkinson_src.dither = SSD1306_DITHER_ATKINSON;
+}
+
+static int bench_anim(ssd1306_t *dev, const ssd1306_frames_t *src, int i) {
+    uint8_t pages[SSD1306_BUFFER_SIZE];
+    ssd1306_frames_convert(src, i % BENCH_ANIM_FRAMES, pages);
+    ssd1306_load_frame(dev, pages);
+    return ssd1306_display_buffer(dev) < 0 ? -1 : 0;
+}
+
+static int bench_anim_1bpp(ssd1306_t *dev, int i) {
+    return bench_anim(dev, &bench_anim_mono_src, i);
+}
+
+static int bench_anim_8bpp(ssd1306_t *dev, int i) {
+    return bench_anim(dev, &bench_anim_gray_src, i);
+}
+
+// Cùng hoạt ảnh xám qua dithering (nền sọc 200/40 thành mẫu điểm thay vì trắng/đen)
+static int bench_dither_bayer(ssd1306_t *dev, int i) {
+    return bench_anim(dev, &bench_dither_bayer_src, i);
+}
+
+static int bench_dither_floyd(ssd1306_t *dev, int i) {
+    return bench_anim(dev, &bench_dither_floyd_src, i);
+}
+
+static int bench_dither_atkinson(ssd1306_t *dev, int i) {
+    return bench_anim(dev, &bench_dither_atkinson_src, i);
+}
+
+// Panel gắn dọc (90 độ): dòng trạng thái và một khối chạy dọc trên khung logic (64x128 với 128x64).
+// portrait_90 chỉ chuyển vị các ô 8x8 bẩn; portrait_naive là cách làm cũ: xoay lại từng
+// pixel của cả khung rồi so cả khung.
+static ssd1306_portrait_t bench_portrait;
+
+static void bench_portrait_draw(int i) {
+    char text[16];
+    int y = (i * 3) % (bench_portrait.height - 24) + 12;
+    snprintf(text, sizeof(text), "%05d", i);
+    ssd1306_portrait_draw_string(&bench_portrait, &ssd1306_font_5x7, 2, 2, text, SSD1306_BLIT_COPY);
+    ssd1306_portrait_fill_rect(&bench_portrait, 8, y, 12, 12, SSD1306_COLOR_INVERT);
+}
+
+static int bench_portrait_90(ssd1306_t *dev, int i) {
+    if (i == 0 && ssd1306_portrait_init(&bench_portrait, dev, SSD1306_ROTATE_90) != 0) return -1;
+    bench_portrait_draw(i);
+    return ssd1306_portrait_update(&bench_portrait) < 0 ? -1 : 0;
+}
+
+static int bench_portrait_naive(ssd1306_t *dev, int i) {
+    if (i == 0 && ssd1306_portrait_init(&bench_portrait, dev, SSD1306_ROTATE_90) != 0) return -1;
+    bench_portrait_draw(i);
+    const int w = bench_portrait.width, h = bench_portrait.height;
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            int on = (bench_portrait.buffer[(y >> 3) * SSD1306_PORTRAIT_WIDTH + x] >> (y & 7)) & 1;
+            ssd1306_draw_pixel(dev, y, w - 1 - x, on);
+        }
+    }
+    return ssd1306_display_buffer(dev) < 0 ? -1 : 0;
+}
+
+static const bench_case_t bench_cases[] = {
+    { "init",           1,  0, bench_init }, // init xóa bộ đệm nhưng không flush
+    { "full_flush",     1,  1, bench_full_flush },
+    { "partial_16x16",  1,  1, bench_partial },
+    { "text_5x7",       1,  1, bench_text_5x7 },
+    { "text_8x16",      1,  1, bench_text_8x16 },
+    { "pixels_scatter", 1,  1, bench_pixels_scatter },
+    { "pixels_full",    10, 1, bench_pixels_full },
+    { "scroll_log",     1,  1, bench_scroll_log },
+    { "console_status", 1,  1, bench_console_status },
+    { "console_log",    1,  1, bench_console_log },
+    { "comp_overlay",   1,  1, bench_comp_overlay },
+    { "comp_redraw",    1,  1, bench_comp_redraw },
+    { "anim_1bpp",      1,  1, bench_anim_1bpp },
+    { "anim_8bpp",      1,  1, bench_anim_8bpp },
+    { "dither_bayer",   1,  1, bench_dither_bayer },
+    { "dither_floyd",   1,  1, bench_dither_floyd },
+    { "dither_atkinson", 1, 1, bench_dither_atkinson },
+    { "portrait_90",    1,  1, bench_portrait_90 },
+    { "portrait_naive", 1,  1, bench_portrait_naive },
+};
+
+#define BENCH_CASE_COUNT ((int)(sizeof(bench_cases) / sizeof(bench_cases[0])))
+
+// =========================================================================
+// Đo và in kết quả
+// =========================================================================
+
+static uint64_t bench_wall_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Bộ mô phỏng gắn vào bus khi chạy với -e (NULL nếu không kiểm tra)
+static ssd1306_emu_t *bench_emu;
+
+// So ảnh trên panel mô phỏng với ảnh của một lần gửi nguyên khung đơn giản (cửa sổ cả
+// panel, các hàng trang nối liền) lên panel cùng cấu hình. Trả về 0 nếu khớp từng pixel.
+static int bench_verify_frame(ssd1306_t *dev, const char *name, int frame, int dump) {
+    static ssd1306_emu_t ref;
+    const uint8_t naive_cmds[] = {
+        SSD1306_COMMAND_MODE,
+        SSD1306_DEACTIVATE_SCROLL, SSD1306_SET_DISPLAY_START_LINE_CMD | 0, SSD1306_SET_DISPLAY_OFFSET, 0x00,
+        SSD1306_SET_MEMORY_ADDR_MODE, 0x00,
+        SSD1306_SET_COLUMN_ADDR, (uint8_t)dev->col_offset, (uint8_t)(dev->col_offset + dev->width - 1),
+        SSD1306_SET_PAGE_ADDR, 0, (uint8_t)(dev->pages - 1),
+    };
+    uint8_t frame_txn[1 + SSD1306_BUFFER_SIZE];
+    uint8_t got[SSD1306_BUFFER_SIZE], want[SSD1306_BUFFER_SIZE];
+
+    ref = *bench_emu;
+    ref.next = NULL;
+    ssd1306_emu_write(&ref, naive_cmds, sizeof(naive_cmds));
+    frame_txn[0] = SSD1306_DATA_MODE;
+    for (int page = 0; page < dev->pages; ++page) {
+        memcpy(frame_txn + 1 + page * dev->width, dev->display_buffer + page * SSD1306_WIDTH, dev->width);
+    }
+    ssd1306_emu_write(&ref, frame_txn, 1 + (size_t)dev->pages * dev->width);
+
+    ssd1306_emu_render(bench_emu, got);
+    ssd1306_emu_render(&ref, want);
+    if (memcmp(got, want, (size_t)SSD1306_WIDTH * dev->pages) == 0) {
+        return 0;
+    }
+    if (dump) {
+        char path[64];
+        fprintf(stderr, "MISMATCH %s: frame %d differs from a full-frame flush\n", name, frame);
+        snprintf(path, sizeof(path), "bench-%s-got.pbm", name);
+        ssd1306_emu_write_pbm(bench_emu, path);
+        snprintf(path, sizeof(path), "bench-%s-want.pbm", name);
+        ssd1306_emu_write_pbm(&ref, path);
+    }
+    return -1;
+}
+
+// Chạy một trường hợp trên màn hình vừa init (bộ đệm trống, đã flush)
+static int bench_run_case(ssd1306_t *dev, const bench_case_t *c, int frames, bench_result_t *r) {
+    ssd1306_transport_t *t = &dev->bus->t;
+    uint64_t bytes = 0, txns = 0, bus_ns = 0;
+
+    memset(r, 0, sizeof(*r));
+    if (bench_emu != NULL) {
+        ssd1306_emu_init(bench_emu, dev->addr, dev->width, dev->height, dev->panel->col_offset);
+    }
+
+    if (ssd1306_init(dev) != 0 || ssd1306_display_buffer(dev) < 0) {
+        return -1;
+    }
+    bench_rand_state = 12345;
+
+    uint64_t wall0 = bench_wall_ns();
+    uint64_t cpu0 = ssd1306_cpu_time_ns();
+    for (int i = 0; i < frames; ++i) {
+        ssd1306_mem_reset(t); // log của bus mem không phình ra theo số khung
+        if (c->frame(dev, i) != 0) {
+            fprintf(stderr, "Error: benchmark '%s' failed at frame %d.\n", c->name, i);
+            return -1;
+        }
+        bytes += t->mem.total_bytes;
+        txns += t->mem.txn_count;
+        bus_ns += t->mem.bus_time_ns;
+        if (bench_emu != NULL && c->verify) {
+            r->verified_frames++;
+            if (bench_verify_frame(dev, c->name, i, r->mismatch_frames == 0) != 0) r->mismatch_frames++;
+        }
+    }
+    uint64_t cpu1 = ssd1306_cpu_time_ns();
+    uint64_t wall1 = bench_wall_ns();
+
+    snprintf(r->name, sizeof(r->name), "%s", c->name);
+    r->width = dev->width;
+    r->height = dev->height;
+    r->frames = frames;
+    r->fps = frames / ((wall1 - wall0) / 1e9);
+    r->bus_fps = bus_ns ? frames / (bus_ns / 1e9) : 0;
+    r->bytes_per_frame = (double)bytes / frames;
+    r->txns_per_frame = (double)txns / frames;
+    r->cpu_ns_per_frame = (double)(cpu1 - cpu0) / frames;
+    r->bus_us_per_frame = bus_ns / 1e3 / frames;
+    if (bench_emu != NULL) r->protocol_errors = bench_emu->protocol_errors + bench_emu->unknown_cmds;
+    return 0;
+}
+
+static void bench_print(FILE *out, const bench_result_t *r, uint32_t bus_hz) {
+    fprintf(out, "{\"bench\":\"%s\",\"bus_hz\":%u,\"width\":%d,\"height\":%d,\"frames\":%d,"
+                 "\"fps\":%.1f,\"bus_fps\":%.1f,\"bytes_per_frame\":%.2f,\"txns_per_frame\":%.3f,"
+                 "\"cpu_ns_per_frame\":%.0f,\"bus_us_per_frame\":%.2f}\n",
+            r->name, bus_hz, r->width, r->height, r->frames,
+            r->fps, r->bus_fps, r->bytes_per_frame, r->txns_per_frame,
+            r->cpu_ns_per_frame, r->bus_us_per_frame);
+}
+
+static void bench_print_verify(FILE *out, const bench_result_t *r) {
+    fprintf(out, "{\"bench\":\"%s\",\"verified_frames\":%d,\"mismatch_frames\":%d,\"protocol_errors\":%llu}\n",
+            r->name, r->verified_frames, r->mismatch_frames, (unsigned long long)r->protocol_errors);
+}
+
+// Đọc một số từ dòng JSON do bench_print() sinh ra
+static int bench_json_number(const char *line, const char *key, double *value) {
+    char pattern[48];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    const char *p = strstr(line, pattern);
+    return p != NULL && sscanf(p + strlen(pattern), "%lf", value) == 1 ? 0 : -1;
+}
+
+// So sánh với file baseline. Trả về số chỉ số bị hồi quy, -1 nếu không đọc được file.
+static int bench_compare(const char *path, const bench_result_t *results, int n, double tolerance) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        perror("Failed to open benchmark baseline");
+        return -1;
+    }
+
+    int regressions = 0;
+    char line[512];
+    while (fgets(line, sizeof(line), f) != NULL) {
+        char name[32];
+        const char *p = strstr(line, "\"bench\":\"");
+        if (p == NULL || sscanf(p + 9, "%31[^\"]", name) != 1) continue;
+
+        // Cùng trường hợp trên panel khác kích thước là phép đo khác: khóa gồm cả width/height
+        double width, height;
+        if (bench_json_number(line, "width", &width) != 0 || bench_json_number(line, "height", &height) != 0) {
+            continue;
+        }
+        const bench_result_t *r = NULL;
+        for (int i = 0; i < n; ++i) {
+            if (strcmp(results[i].name, name) == 0 && results[i].width == (int)width &&
+                results[i].height == (int)height) {
+                r = &results[i];
+            }
+        }
+        double bytes, txns, cpu_ns;
+        if (r == NULL || bench_json_number(line, "bytes_per_frame", &bytes) != 0 ||
+            bench_json_number(line, "txns_per_frame", &txns) != 0 ||
+            bench_json_number(line, "cpu_ns_per_frame", &cpu_ns) != 0) {
+            continue;
+        }
+
+        // Dòng JSON làm tròn 2-3 chữ số thập phân: so sánh với cùng độ chính xác
+        if (r->bytes_per_frame > bytes + 0.005) {
+            fprintf(stderr, "REGRESSION %s (%dx%d): bytes/frame %.2f -> %.2f\n", name, r->width, r->height, bytes, r->bytes_per_frame);
+            regressions++;
+        }
+        if (r->txns_per_frame > txns + 0.0005) {
+            fprintf(stderr, "REGRESSION %s (%dx%d): txns/frame %.3f -> %.3f\n", name, r->width, r->height, txns, r->txns_per_frame);
+            regressions++;
+        }
+        if (r->cpu_ns_per_frame > cpu_ns * (1.0 + tolerance / 100.0)) {
+            fprintf(stderr, "REGRESSION %s (%dx%d): CPU ns/frame %.0f -> %.0f (+%.1f%%, tolerance %.1f%%)\n",
+                    name, r->width, r->height, cpu_ns, r->cpu_ns_per_frame, (r->cpu_ns_per_frame / cpu_ns - 1.0) * 100.0, tolerance);
+            regressions++;
+        }
+    }
+    fclose(f);
+    return regressions;
+}
+
+static void bench_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-n frames] [-b bus_hz] [-c case] [-v] [-e] [-m max_xfer] [-B baseline] [-t tolerance_pct]\n", prog);
+    fprintf(stderr, "Cases:");
+    for (int i = 0; i < BENCH_CASE_COUNT; ++i) fprintf(stderr, " %s", bench_cases[i].name);
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char *argv[]) {
+    int frames = BENCH_DEFAULT_FRAMES;
+    uint32_t bus_hz = SSD1306_BUS_400KHZ;
+    const char *only = NULL, *baseline = NULL;
+    double tolerance = BENCH_DEFAULT_TOLERANCE;
+    int verbose = 0, verify = 0, opt;
+    size_t max_write = 0;
+
+    while ((opt = getopt(argc, argv, "n:b:c:vem:B:t:h")) != -1) {
+        switch (opt) {
+        case 'n': frames = atoi(optarg); break;
+        case 'b': bus_hz = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'c': only = optarg; break;
+        case 'v': verbose = 1; break;
+        case 'e': verify = 1; break;
+        case 'm': max_write = (size_t)strtoul(optarg, NULL, 10); break;
+        case 'B': baseline = optarg; break;
+        case 't': tolerance = atof(optarg); break;
+        default:
+            bench_usage(argv[0]);
+            return 2;
+        }
+    }
+    if (frames <= 0) {
+        bench_usage(argv[0]);
+        return 2;
+    }
+
+    // stdout chỉ có các dòng JSON; thông báo của driver (mở bus, init) ra stderr khi chạy với -v
+    ssd1306_verbose = verbose;
+
+    ssd1306_bus_t *bus = ssd1306_bus_open("mem", I2C_BUS_PATH, bus_hz);
+    if (bus == NULL) {
+        return 1;
+    }
+    ssd1306_t *dev = ssd1306_open(bus, SSD1306_I2C_ADDR);
+    if (dev == NULL) {
+        ssd1306_bus_close(bus);
+        return 1;
+    }
+
+    bus->t.mem.max_write = max_write;
+    static ssd1306_emu_t emu;
+    if (verify) {
+        bench_emu = &emu;
+        ssd1306_emu_attach(bench_emu, &bus->t);
+    }
+
+    bench_anim_setup();
+    bench_result_t results[BENCH_MAX_CASES];
+    int n = 0, rc = 0;
+    for (int i = 0; i < BENCH_CASE_COUNT; ++i) {
+        const bench_case_t *c = &bench_cases[i];
+        if (only != NULL && strcmp(only, c->name) != 0) continue;
+        int case_frames = frames / c->frames_div > 0 ? frames / c->frames_div : 1;
+        if (bench_run_case(dev, c, case_frames, &results[n]) != 0) {
+            rc = 1;
+            break;
+        }
+        if (verify) {
+            bench_print_verify(stdout, &results[n]);
+            if (results[n].mismatch_frames != 0 || results[n].protocol_errors != 0) rc = 1;
+        } else {
+            bench_print(stdout, &results[n], bus_hz);
+        }
+        fflush(stdout);
+        n++;
+    }
+    ssd1306_bus_close(bus);
+
+    if (only != NULL && n == 0) {
+        fprintf(stderr, "Error: unknown benchmark case '%s'.\n", only);
+        bench_usage(argv[0]);
+        return 2;
+    }
+    if (rc == 0 && baseline != NULL && !verify) {
+        int regressions = bench_compare(baseline, results, n, tolerance);
+        if (regressions != 0) {
+            if (regressions > 0) fprintf(stderr, "%d benchmark regression(s) against %s.\n", regressions, baseline);
+            rc = 1;
+        }
+    }
+    return rc;
+}
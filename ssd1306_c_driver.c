@@ -1,81 +1,30 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>         // For uint8_t
-#include <fcntl.h>          // For O_RDWR
-#include <unistd.h>         // For write(), close(), usleep()
-#include <sys/ioctl.h>      // For ioctl()
-#include <linux/i2c-dev.h>  // For I2C_SLAVE
 #include <string.h>         // For memset(), memcpy()
 #include <time.h>           // For nanosleep()
+#include <pthread.h>        // For luồng flush nền
+#include <semaphore.h>      // For sem_post() khi present
+#include <stdatomic.h>      // For trao đổi bộ đệm không khóa
 
-// =========================================================================
-// Bước 1: Khai báo hằng số và biến toàn cục
-// =========================================================================
+#include "ssd1306_c_driver.h" // Bước 1: hằng số và kiểu dữ liệu
+#include "ssd1306_console.h"  // Console chữ dùng trong chương trình thử nghiệm
 
-// Địa chỉ I2C của SSD1306 (thường là 0x3C, kiểm tra bằng i2cdetect -y 1)
-#define SSD1306_I2C_ADDR         0x3C
+static void ssd1306_mark_span(ssd1306_t *dev, int page, int x0, int x1);
 
-// Tên file device I2C (thường là /dev/i2c-1 trên Raspberry Pi)
-#define I2C_BUS_PATH             "/dev/i2c-1"
+// Vòng lặp nóng được viết một lần với kích thước panel là tham số và luôn được inline vào
+// bản riêng của từng panel (mục "Hình học panel"), nên ở đó kích thước là hằng số
+#define SSD1306_PANEL_INLINE static inline __attribute__((always_inline))
 
-// Kích thước màn hình
-#define SSD1306_WIDTH            128
-#define SSD1306_HEIGHT           64 // Thay đổi thành 32 nếu bạn dùng màn 128x32
-
-#if (SSD1306_HEIGHT == 64)
-#define SSD1306_PAGES            8
-#elif (SSD1306_HEIGHT == 32)
-#define SSD1306_PAGES            4
-#else
-#error "Unsupported screen height. Only 32 or 64 are supported."
-#endif
-
-#define SSD1306_BUFFER_SIZE      (SSD1306_WIDTH * SSD1306_PAGES)
-
-// Control byte
-#define SSD1306_COMMAND_MODE     0x00 // Co = 0, D/C# = 0
-#define SSD1306_DATA_MODE        0x40 // Co = 0, D/C# = 1
-
-// Fundamental Command Table
-#define SSD1306_SET_CONTRAST                  0x81
-#define SSD1306_DISPLAY_ALL_ON_RESUME         0xA4
-#define SSD1306_DISPLAY_ALL_ON_IGNORE_RAM     0xA5
-#define SSD1306_NORMAL_DISPLAY                0xA6
-#define SSD1306_INVERT_DISPLAY                0xA7
-#define SSD1306_DISPLAY_OFF                   0xAE
-#define SSD1306_DISPLAY_ON                    0xAF
-
-// Addressing Setting Command Table
-#define SSD1306_SET_MEMORY_ADDR_MODE          0x20
-#define SSD1306_SET_COLUMN_ADDR               0x21
-#define SSD1306_SET_PAGE_ADDR                 0x22
-// For Page Addressing Mode only
-#define SSD1306_SET_PAGE_START_ADDR_CM        0xB0 // For command mode, add page number (0-7)
-
-// Hardware Configuration Command Table
-#define SSD1306_SET_DISPLAY_START_LINE_CMD    0x40 // Add line number (0-63)
-#define SSD1306_SET_SEGMENT_REMAP_NORMAL      0xA0 // Column 0 maps to SEG0
-#define SSD1306_SET_SEGMENT_REMAP_REVERSE     0xA1 // Column 127 maps to SEG0 (default for many modules)
-#define SSD1306_SET_MULTIPLEX_RATIO           0xA8
-#define SSD1306_SET_COM_OUTPUT_SCAN_DIR_NORMAL 0xC0 // Scan from COM0 to COM[N-1]
-#define SSD1306_SET_COM_OUTPUT_SCAN_DIR_REMAPPED 0xC8 // Scan from COM[N-1] to COM0 (default for many modules)
-#define SSD1306_SET_DISPLAY_OFFSET            0xD3
-#define SSD1306_SET_COM_PINS_HW_CONFIG        0xDA
-
-// Timing & Driving Scheme Setting Command Table
-#define SSD1306_SET_DISPLAY_CLOCK_DIV         0xD5
-#define SSD1306_SET_PRECHARGE_PERIOD          0xD9
-#define SSD1306_SET_VCOMH_DESELECT_LEVEL      0xDB
-#define SSD1306_NOP                           0xE3
-
-// Charge Pump Command Table
-#define SSD1306_CHARGE_PUMP_SETTING           0x8D
-#define SSD1306_CHARGE_PUMP_ENABLE            0x14
-#define SSD1306_CHARGE_PUMP_DISABLE           0x10
-
-// Biến toàn cục
-int i2c_fd = -1; // File descriptor cho bus I2C, khởi tạo là không hợp lệ
-uint8_t display_buffer[SSD1306_BUFFER_SIZE]; // Bộ đệm màn hình
+// Bản riêng theo panel của các vòng lặp nóng (lập kế hoạch, gửi, vẽ, nạp/so khung)
+struct ssd1306_panel_ops {
+    int (*plan)(ssd1306_dirty_t dirty, ssd1306_window_t *windows, int max_windows);
+    int (*send_frame)(ssd1306_t *dev, uint8_t *frame, ssd1306_dirty_t dirty);
+    void (*fill_rect)(ssd1306_t *dev, int x, int y, int w, int h, int color);
+    void (*blit)(ssd1306_t *dev, const uint8_t *bitmap, int bw, int bh, int x, int y, int mode, int mark);
+    int (*load_frame)(ssd1306_t *dev, const uint8_t *frame);
+    void (*diff_frame)(const uint8_t *frame, const uint8_t *shadow, ssd1306_dirty_t dirty);
+};
 
 // =========================================================================
 // Bước 2: Các hàm giao tiếp I2C
@@ -92,40 +41,149 @@ void delay_ms(long milliseconds) {
     }
 }
 
-int ssd1306_open_i2c() {
-    i2c_fd = open(I2C_BUS_PATH, O_RDWR);
-    if (i2c_fd < 0) {
-        perror("Failed to open I2C bus");
+// Thời gian CPU của luồng hiện tại (ns), dùng để đo chi phí mỗi khung hình
+uint64_t ssd1306_cpu_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Mở bus bằng backend chỉ định ("dev", "rdwr", "smbus", "mem" hoặc "auto"). Trả về NULL nếu lỗi.
+ssd1306_bus_t *ssd1306_bus_open(const char *backend, const char *path, uint32_t bus_hz) {
+    ssd1306_bus_t *bus = calloc(1, sizeof(*bus));
+    if (bus == NULL) {
+        perror("Failed to allocate I2C bus");
+        return NULL;
+    }
+    if (ssd1306_transport_open_by_name(&bus->t, backend, path, SSD1306_I2C_ADDR, bus_hz) != 0) {
+        free(bus);
+        return NULL;
+    }
+    snprintf(bus->path, sizeof(bus->path), "%s", path);
+    pthread_mutex_init(&bus->lock, NULL);
+    bus->t.metrics.start_ns = ssd1306_metrics_now();
+    if (ssd1306_verbose) fprintf(stderr, "I2C transport '%s' opened (bus %s).\n", bus->t.ops->name, bus->path);
+    // Ghi vết lưu lượng ngoài hiện trường mà không cần sửa chương trình: SSD1306_TRACE=file
+    // (bus thứ hai trở đi ghi vào file.1, file.2, ...)
+    const char *trace = getenv("SSD1306_TRACE");
+    if (trace != NULL && *trace != '\0') {
+        static atomic_int traced_buses;
+        int n = atomic_fetch_add(&traced_buses, 1);
+        char path[256];
+        if (n == 0) snprintf(path, sizeof(path), "%s", trace);
+        else snprintf(path, sizeof(path), "%s.%d", trace, n);
+        if (ssd1306_trace_start(&bus->t, path) == 0 && ssd1306_verbose) {
+            fprintf(stderr, "Recording I2C traffic of %s to %s.\n", bus->path, path);
+        }
+    }
+    return bus;
+}
+
+void ssd1306_close(ssd1306_t *dev); // Định nghĩa ngay dưới
+void ssd1306_bus_stop_flusher(ssd1306_bus_t *bus); // Định nghĩa ở Bước 5
+
+// Đóng bus cùng mọi màn hình còn mở trên đó
+void ssd1306_bus_close(ssd1306_bus_t *bus) {
+    if (bus == NULL) return;
+    ssd1306_bus_stop_flusher(bus);
+    while (bus->display_count > 0) {
+        ssd1306_close(bus->displays[bus->display_count - 1]);
+    }
+    ssd1306_transport_close(&bus->t);
+    pthread_mutex_destroy(&bus->lock);
+    if (ssd1306_verbose) fprintf(stderr, "I2C bus %s closed.\n", bus->path);
+    free(bus);
+}
+
+// Tạo ngữ cảnh cho màn hình tại địa chỉ addr trên bus. Gọi ssd1306_init() trước khi vẽ.
+ssd1306_t *ssd1306_open(ssd1306_bus_t *bus, uint16_t addr) {
+    if (atomic_load(&bus->flusher_running)) {
+        fprintf(stderr, "Error: Stop the flusher of %s before adding displays.\n", bus->path);
+        return NULL;
+    }
+    if (bus->display_count == SSD1306_MAX_BUS_DISPLAYS) {
+        fprintf(stderr, "Error: Too many displays on %s.\n", bus->path);
+        return NULL;
+    }
+    for (int i = 0; i < bus->display_count; ++i) {
+        if (bus->displays[i]->addr == addr) {
+            fprintf(stderr, "Error: Address 0x%X already open on %s.\n", addr, bus->path);
+            return NULL;
+        }
+    }
+
+    ssd1306_t *dev = calloc(1, sizeof(*dev));
+    if (dev == NULL) {
+        perror("Failed to allocate SSD1306 context");
+        return NULL;
+    }
+    dev->bus = bus;
+    dev->addr = addr;
+    dev->display_buffer = dev->storage[0] + SSD1306_TX_HEADROOM;
+    pthread_mutex_init(&dev->render_lock, NULL);
+    ssd1306_set_panel(dev, ssd1306_default_panel());
+    bus->displays[bus->display_count++] = dev;
+    return dev;
+}
+
+void ssd1306_close(ssd1306_t *dev) {
+    ssd1306_bus_t *bus = dev->bus;
+    int i = 0;
+    while (i < bus->display_count && bus->displays[i] != dev) ++i;
+    if (i < bus->display_count) {
+        bus->displays[i] = bus->displays[--bus->display_count];
+    }
+    pthread_mutex_destroy(&dev->render_lock);
+    free(dev);
+}
+
+// Giành bus cho dev: khóa bus rồi chọn địa chỉ slave của dev. Trả về 0 nếu thành công
+// (bus đang bị khóa), -1 nếu lỗi (bus không bị khóa).
+static int ssd1306_bus_acquire(ssd1306_t *dev) {
+    if (!ssd1306_transport_is_open(&dev->bus->t)) {
+        fprintf(stderr, "Error: I2C bus not open.\n");
         return -1;
     }
-    if (ioctl(i2c_fd, I2C_SLAVE, SSD1306_I2C_ADDR) < 0) {
+    uint64_t t0 = ssd1306_metrics_now();
+    pthread_mutex_lock(&dev->bus->lock);
+    ssd1306_hist_add(&dev->metrics.lock_wait_ns, ssd1306_metrics_now() - t0);
+    if (ssd1306_transport_set_addr(&dev->bus->t, dev->addr) != 0) {
         perror("Failed to set I2C slave address");
-        close(i2c_fd);
-        i2c_fd = -1;
+        dev->metrics.errors++;
+        pthread_mutex_unlock(&dev->bus->lock);
         return -1;
     }
-    printf("I2C bus %s opened and slave address 0x%X set.\n", I2C_BUS_PATH, SSD1306_I2C_ADDR);
     return 0;
 }
 
-void ssd1306_close_i2c() {
-    if (i2c_fd >= 0) {
-        close(i2c_fd);
-        i2c_fd = -1;
-        printf("I2C bus closed.\n");
-    }
+static void ssd1306_bus_release(ssd1306_t *dev) {
+    pthread_mutex_unlock(&dev->bus->lock);
+}
+
+// Ghi nhận một thao tác bắt đầu lúc t0 (kể cả chờ bus) vào h. Người gọi giữ bus.
+static void ssd1306_metrics_op(ssd1306_t *dev, ssd1306_hist_t *h, uint64_t t0, int failed) {
+    ssd1306_hist_add(h, ssd1306_metrics_now() - t0);
+    if (failed) dev->metrics.errors++;
+}
+
+// Gửi len byte (đã có control byte) trong một giao dịch tới dev
+static int ssd1306_write_txn(ssd1306_t *dev, const uint8_t *buf, int len) {
+    uint64_t t0 = ssd1306_metrics_now();
+    if (ssd1306_bus_acquire(dev) != 0) return -1;
+    uint64_t txns0 = dev->bus->t.metrics.txns;
+    int rc = ssd1306_transport_write(&dev->bus->t, buf, len);
+    ssd1306_metrics_op(dev, &dev->metrics.cmd_ns, t0, rc != 0);
+    dev->tx_stats.transactions += dev->bus->t.metrics.txns - txns0;
+    ssd1306_bus_release(dev);
+    return rc;
 }
 
 // Gửi một byte lệnh duy nhất
-int ssd1306_send_single_command(uint8_t command) {
-    if (i2c_fd < 0) {
-        fprintf(stderr, "Error: I2C bus not open for sending command.\n");
-        return -1;
-    }
+int ssd1306_send_single_command(ssd1306_t *dev, uint8_t command) {
     uint8_t buffer[2];
     buffer[0] = SSD1306_COMMAND_MODE;
     buffer[1] = command;
-    if (write(i2c_fd, buffer, 2) != 2) {
+    if (ssd1306_write_txn(dev, buffer, 2) != 0) {
         perror("Failed to write single command to I2C");
         return -1;
     }
@@ -133,13 +191,12 @@ int ssd1306_send_single_command(uint8_t command) {
 }
 
 // Gửi một lệnh có một tham số
-int ssd1306_send_command_1param(uint8_t command, uint8_t param1) {
-    if (i2c_fd < 0) return -1;
+int ssd1306_send_command_1param(ssd1306_t *dev, uint8_t command, uint8_t param1) {
     uint8_t buffer[3];
     buffer[0] = SSD1306_COMMAND_MODE;
     buffer[1] = command;
     buffer[2] = param1;
-    if (write(i2c_fd, buffer, 3) != 3) {
+    if (ssd1306_write_txn(dev, buffer, 3) != 0) {
         perror("Failed to write command with 1 param to I2C");
         return -1;
     }
@@ -147,14 +204,13 @@ int ssd1306_send_command_1param(uint8_t command, uint8_t param1) {
 }
 
 // Gửi một lệnh có hai tham số
-int ssd1306_send_command_2params(uint8_t command, uint8_t param1, uint8_t param2) {
-    if (i2c_fd < 0) return -1;
+int ssd1306_send_command_2params(ssd1306_t *dev, uint8_t command, uint8_t param1, uint8_t param2) {
     uint8_t buffer[4];
     buffer[0] = SSD1306_COMMAND_MODE;
     buffer[1] = command;
     buffer[2] = param1;
     buffer[3] = param2;
-    if (write(i2c_fd, buffer, 4) != 4) {
+    if (ssd1306_write_txn(dev, buffer, 4) != 0) {
         perror("Failed to write command with 2 params to I2C");
         return -1;
     }
@@ -163,231 +219,1679 @@ int ssd1306_send_command_2params(uint8_t command, uint8_t param1, uint8_t param2
 
 // Gửi một chuỗi các byte dưới dạng lệnh (ví dụ: một chuỗi khởi tạo dài)
 // Buffer đầu vào commands KHÔNG chứa control byte 0x00. Hàm này sẽ thêm nó vào.
-int ssd1306_send_command_sequence(const uint8_t *commands, int len) {
-    if (i2c_fd < 0) {
-        fprintf(stderr, "Error: I2C bus not open for sending command sequence.\n");
-        return -1;
-    }
+int ssd1306_send_command_sequence(ssd1306_t *dev, const uint8_t *commands, int len) {
     if (len <= 0 || commands == NULL) {
         fprintf(stderr, "Error: Invalid arguments for send_command_sequence.\n");
         return -1;
     }
-
-    uint8_t *buffer = (uint8_t *)malloc(len + 1);
-    if (buffer == NULL) {
-        perror("Failed to allocate memory for command sequence buffer");
+    uint64_t t0 = ssd1306_metrics_now();
+    if (ssd1306_bus_acquire(dev) != 0) {
         return -1;
     }
 
-    buffer[0] = SSD1306_COMMAND_MODE;
-    memcpy(buffer + 1, commands, len);
-
-    if (write(i2c_fd, buffer, len + 1) != (len + 1)) {
-        perror("Failed to write command sequence to I2C");
-        free(buffer);
+    // Chuỗi lệnh ngắn: chép vào bộ dựng giao dịch (không cấp phát heap)
+    ssd1306_batch_t *b = &dev->bus->batch;
+    uint64_t txns0 = dev->bus->t.metrics.txns;
+    ssd1306_batch_begin(b, &dev->bus->t);
+    ssd1306_batch_cmd(b, commands, len);
+    long sent = ssd1306_batch_flush(b);
+    ssd1306_metrics_op(dev, &dev->metrics.cmd_ns, t0, sent < 0);
+    dev->tx_stats.transactions += dev->bus->t.metrics.txns - txns0;
+    ssd1306_bus_release(dev);
+    if (sent < 0) {
         return -1;
     }
-    free(buffer);
+    dev->tx_stats.bytes += sent;
+    dev->tx_stats.copied_bytes += len;
     return 0;
 }
 
+// Gửi một đoạn liền nhau [offset, offset + len) của frame (bộ đệm có headroom) trong một giao dịch.
+// hdr_len byte đứng ngay trước đoạn đó được mượn tạm để chứa header (lệnh + control byte),
+// sau khi gửi thì khôi phục lại -> payload không bị sao chép. Người gọi giữ bus.
+// Byte bị mượn là pixel của đoạn phía trước, nên trong lúc gửi không luồng nào khác được
+// ghi vào frame: luồng flush nền chỉ gửi ô front/shadow của riêng nó, còn với display_buffer
+// thì ssd1306_display_buffer()/ssd1306_send_data() phải chạy cùng luồng với các hàm vẽ.
+static int ssd1306_send_span(ssd1306_t *dev, uint8_t *frame, const uint8_t *hdr, int hdr_len, int offset, int len) {
+    uint8_t *start = frame + offset - hdr_len;
+    uint8_t saved[SSD1306_TX_HEADROOM];
+    uint64_t txns0 = dev->bus->t.metrics.txns;
 
-int ssd1306_send_data(const uint8_t *data, int len) {
-    if (i2c_fd < 0) {
-        fprintf(stderr, "Error: I2C bus not open for sending data.\n");
+    memcpy(saved, start, hdr_len);
+    memcpy(start, hdr, hdr_len);
+    int rc = ssd1306_transport_write(&dev->bus->t, start, hdr_len + len);
+    memcpy(start, saved, hdr_len);
+
+    dev->tx_stats.transactions += dev->bus->t.metrics.txns - txns0;
+    if (rc != 0) {
+        perror("Failed to write data to I2C");
         return -1;
     }
+    dev->tx_stats.bytes += hdr_len + len;
+    return 0;
+}
+
+int ssd1306_send_data(ssd1306_t *dev, const uint8_t *data, int len) {
     if (len <= 0 || data == NULL) {
         fprintf(stderr, "Error: Invalid arguments for send_data.\n");
         return -1;
     }
-
-    uint8_t *buffer = (uint8_t *)malloc(len + 1);
-    if (buffer == NULL) {
-        perror("Failed to allocate memory for data buffer");
+    uint64_t t0 = ssd1306_metrics_now();
+    if (ssd1306_bus_acquire(dev) != 0) {
         return -1;
     }
 
-    buffer[0] = SSD1306_DATA_MODE;
-    memcpy(buffer + 1, data, len);
+    // Dữ liệu nằm trong display_buffer: gửi trực tiếp nhờ khoảng trống phía trước
+    if (data >= dev->display_buffer && data + len <= dev->display_buffer + SSD1306_BUFFER_SIZE) {
+        static const uint8_t data_hdr[1] = { SSD1306_DATA_MODE };
+        int rc = ssd1306_send_span(dev, dev->display_buffer, data_hdr, 1, (int)(data - dev->display_buffer), len);
+        ssd1306_metrics_op(dev, &dev->metrics.data_ns, t0, rc != 0);
+        ssd1306_bus_release(dev);
+        return rc;
+    }
 
-    // Gửi dữ liệu. I2C có giới hạn về kích thước gói (thường là 32 byte cho write_i2c_block_data trên RPi,
-    // nhưng write() trực tiếp có thể xử lý nhiều hơn, tùy thuộc vào driver).
-    // Để an toàn, có thể chia thành nhiều lần ghi nếu len lớn.
-    // Tuy nhiên, với 1024 byte, write một lần thường vẫn ổn.
-    if (write(i2c_fd, buffer, len + 1) != (len + 1)) {
-        perror("Failed to write data to I2C");
-        free(buffer);
+    // Dữ liệu ở nơi khác: chép qua bộ dựng giao dịch (không cấp phát heap).
+    // Dữ liệu dài hơn SSD1306_BATCH_MAX được chia thành nhiều giao dịch;
+    // con trỏ địa chỉ của SSD1306 vẫn tiếp tục giữa các giao dịch.
+    ssd1306_batch_t *b = &dev->bus->batch;
+    uint64_t txns0 = dev->bus->t.metrics.txns;
+    ssd1306_batch_begin(b, &dev->bus->t);
+    ssd1306_batch_data(b, data, len);
+    long sent = ssd1306_batch_flush(b);
+    ssd1306_metrics_op(dev, &dev->metrics.data_ns, t0, sent < 0);
+    dev->tx_stats.transactions += dev->bus->t.metrics.txns - txns0;
+    ssd1306_bus_release(dev);
+    if (sent < 0) {
         return -1;
     }
-    free(buffer);
+    dev->tx_stats.bytes += sent;
+    dev->tx_stats.copied_bytes += len;
     return 0;
 }
 
 // =========================================================================
 // Bước 3: Hàm khởi tạo màn hình
 // =========================================================================
-int ssd1306_init() {
-    // Chuỗi lệnh khởi tạo này khá chuẩn cho nhiều màn hình SSD1306 128x64.
-    // Tham khảo datasheet để tùy chỉnh nếu cần.
-    ssd1306_send_single_command(SSD1306_DISPLAY_OFF);               // 0xAE
+static uint8_t ssd1306_seg_remap_cmd(int orientation) {
+    return orientation & SSD1306_ORIENT_MIRROR_X ? SSD1306_SET_SEGMENT_REMAP_NORMAL : SSD1306_SET_SEGMENT_REMAP_REVERSE;
+}
+
+static uint8_t ssd1306_com_scan_cmd(int orientation) {
+    return orientation & SSD1306_ORIENT_MIRROR_Y ? SSD1306_SET_COM_OUTPUT_SCAN_DIR_NORMAL
+                                                 : SSD1306_SET_COM_OUTPUT_SCAN_DIR_REMAPPED;
+}
+
+// Cột GDDRAM của cột 0. Panel hẹp chỉ nối một dải segment: khi lật trái-phải (0xA0) dải
+// đó nằm ở đầu kia của địa chỉ cột.
+static int ssd1306_panel_col_offset(const ssd1306_panel_t *panel, int orientation) {
+    return orientation & SSD1306_ORIENT_MIRROR_X ? SSD1306_WIDTH - panel->width - panel->col_offset
+                                                 : panel->col_offset;
+}
 
-    ssd1306_send_command_1param(SSD1306_SET_DISPLAY_CLOCK_DIV, 0x80); // 0xD5, 0x80
+int ssd1306_init(ssd1306_t *dev) {
+    // Chuỗi lệnh khởi tạo này khá chuẩn cho nhiều màn hình SSD1306; multiplex và cấu hình
+    // chân COM lấy từ mô tả panel (dev->panel). Tham khảo datasheet để tùy chỉnh nếu cần.
+    // Toàn bộ chuỗi được gom vào một giao dịch I2C duy nhất (một control byte 0x00).
+    if (ssd1306_bus_acquire(dev) != 0) {
+        return -1;
+    }
+    ssd1306_batch_t *b = &dev->bus->batch;
+    uint64_t txns0 = dev->bus->t.metrics.txns;
+    ssd1306_batch_begin(b, &dev->bus->t);
+
+    ssd1306_batch_cmd1(b, SSD1306_DISPLAY_OFF);                           // 0xAE
+
+    ssd1306_batch_cmd1(b, SSD1306_DEACTIVATE_SCROLL);                     // 0x2E (tiến trình trước có thể để panel đang cuộn)
+
+    ssd1306_batch_cmd2(b, SSD1306_SET_DISPLAY_CLOCK_DIV, 0x80);           // 0xD5, 0x80
     
-    ssd1306_send_command_1param(SSD1306_SET_MULTIPLEX_RATIO, SSD1306_HEIGHT - 1); // 0xA8, 0x3F (cho 64) hoặc 0x1F (cho 32)
+    ssd1306_batch_cmd2(b, SSD1306_SET_MULTIPLEX_RATIO, dev->height - 1);  // 0xA8, 0x3F (cho 64) hoặc 0x1F (cho 32)
     
-    ssd1306_send_command_1param(SSD1306_SET_DISPLAY_OFFSET, 0x00);   // 0xD3, 0x00
+    ssd1306_batch_cmd2(b, SSD1306_SET_DISPLAY_OFFSET, 0x00);              // 0xD3, 0x00
     
-    ssd1306_send_single_command(SSD1306_SET_DISPLAY_START_LINE_CMD | 0x00); // 0x40 | 0x00 (start line 0)
+    ssd1306_batch_cmd1(b, SSD1306_SET_DISPLAY_START_LINE_CMD | 0x00);     // 0x40 | 0x00 (start line 0)
     
-    ssd1306_send_command_1param(SSD1306_CHARGE_PUMP_SETTING, SSD1306_CHARGE_PUMP_ENABLE); // 0x8D, 0x14
+    ssd1306_batch_cmd2(b, SSD1306_CHARGE_PUMP_SETTING, SSD1306_CHARGE_PUMP_ENABLE); // 0x8D, 0x14
     
-    ssd1306_send_command_1param(SSD1306_SET_MEMORY_ADDR_MODE, 0x00); // 0x20, 0x00 (Horizontal Addressing Mode)
-                                                                  // 0x02 for Page Addressing Mode (default)
+    ssd1306_batch_cmd2(b, SSD1306_SET_MEMORY_ADDR_MODE, 0x00);            // 0x20, 0x00 (Horizontal Addressing Mode)
+                                                                          // 0x02 for Page Addressing Mode (default)
 
-    // Remap (điều chỉnh nếu hình ảnh bị lật hoặc đảo ngược)
-    ssd1306_send_single_command(SSD1306_SET_SEGMENT_REMAP_REVERSE);  // 0xA1 (hoặc 0xA0)
-    ssd1306_send_single_command(SSD1306_SET_COM_OUTPUT_SCAN_DIR_REMAPPED); // 0xC8 (hoặc 0xC0)
+    // Remap theo hướng panel (ssd1306_set_orientation), mặc định 0xA1, 0xC8
+    ssd1306_batch_cmd1(b, ssd1306_seg_remap_cmd(dev->orientation));       // 0xA1 (hoặc 0xA0)
+    ssd1306_batch_cmd1(b, ssd1306_com_scan_cmd(dev->orientation));        // 0xC8 (hoặc 0xC0)
 
-#if (SSD1306_HEIGHT == 64)
-    ssd1306_send_command_1param(SSD1306_SET_COM_PINS_HW_CONFIG, 0x12); // 0xDA, 0x12
-#elif (SSD1306_HEIGHT == 32)
-    ssd1306_send_command_1param(SSD1306_SET_COM_PINS_HW_CONFIG, 0x02); // 0xDA, 0x02 (kiểm tra datasheet nếu là 128x32)
-#endif
+    ssd1306_batch_cmd2(b, SSD1306_SET_COM_PINS_HW_CONFIG, dev->panel->com_pins); // 0xDA, 0x12 (xen kẽ) hoặc 0x02 (tuần tự)
 
-    ssd1306_send_command_1param(SSD1306_SET_CONTRAST, 0xCF);         // 0x81, 0xCF (độ tương phản, thử giá trị khác)
+    ssd1306_batch_cmd2(b, SSD1306_SET_CONTRAST, 0xCF);                    // 0x81, 0xCF (độ tương phản, thử giá trị khác)
     
-    ssd1306_send_command_1param(SSD1306_SET_PRECHARGE_PERIOD, 0xF1); // 0xD9, 0xF1 (hoặc 0x22 nếu dùng VCC ngoài)
+    ssd1306_batch_cmd2(b, SSD1306_SET_PRECHARGE_PERIOD, 0xF1);            // 0xD9, 0xF1 (hoặc 0x22 nếu dùng VCC ngoài)
     
-    ssd1306_send_command_1param(SSD1306_SET_VCOMH_DESELECT_LEVEL, 0x40); // 0xDB, 0x40 (hoặc 0x30)
+    ssd1306_batch_cmd2(b, SSD1306_SET_VCOMH_DESELECT_LEVEL, 0x40);        // 0xDB, 0x40 (hoặc 0x30)
 
-    ssd1306_send_single_command(SSD1306_DISPLAY_ALL_ON_RESUME);     // 0xA4 (hiển thị nội dung từ RAM)
+    ssd1306_batch_cmd1(b, SSD1306_DISPLAY_ALL_ON_RESUME);                 // 0xA4 (hiển thị nội dung từ RAM)
     
-    ssd1306_send_single_command(SSD1306_NORMAL_DISPLAY);            // 0xA6
+    ssd1306_batch_cmd1(b, SSD1306_NORMAL_DISPLAY);                        // 0xA6
     
-    // Xóa bộ đệm trước khi bật màn hình
-    memset(display_buffer, 0x00, SSD1306_BUFFER_SIZE);
-    // Gửi bộ đệm trống lên màn hình (không bắt buộc nhưng tốt)
-    // ssd1306_display_buffer(); // Sẽ được định nghĩa ở Bước 4
+    ssd1306_batch_cmd1(b, SSD1306_DISPLAY_ON);                            // 0xAF
+
+    long sent = ssd1306_batch_flush(b);
+    dev->tx_stats.transactions += dev->bus->t.metrics.txns - txns0;
+    ssd1306_bus_release(dev);
+    if (sent < 0) {
+        fprintf(stderr, "Failed to send SSD1306 init sequence.\n");
+        return -1;
+    }
 
-    ssd1306_send_single_command(SSD1306_DISPLAY_ON);                // 0xAF
+    dev->start_line = 0;
+    dev->display_offset = 0;
+    dev->hw_scroll_active = 0;
 
-    printf("SSD1306 initialized.\n");
+    // Xóa bộ đệm; lần gọi ssd1306_display_buffer() đầu tiên sẽ gửi khung trống
+    memset(dev->display_buffer, 0x00, SSD1306_BUFFER_SIZE);
+    // Nội dung GDDRAM sau khi bật nguồn là ngẫu nhiên -> lần flush đầu phải gửi toàn bộ
+    ssd1306_mark_all_dirty(dev);
+
+    if (ssd1306_verbose) {
+        fprintf(stderr, "SSD1306 0x%X on %s initialized (%s).\n", dev->addr, dev->bus->path, dev->panel->name);
+    }
+    return 0;
+}
+
+// Hướng quét COM đổi ngay ảnh trên kính; segment remap chỉ đổi cách ghi dữ liệu tới sau,
+// nên khi lật trái-phải GDDRAM phải được ghi lại từ display_buffer.
+int ssd1306_set_orientation(ssd1306_t *dev, int orientation) {
+    if (orientation < SSD1306_ORIENT_0 || orientation > SSD1306_ORIENT_180) {
+        fprintf(stderr, "Error: Invalid orientation %d.\n", orientation);
+        return -1;
+    }
+    if (atomic_load(&dev->bus->flusher_running) || dev->hw_scroll_active) {
+        fprintf(stderr, "Error: Cannot change orientation while the flusher or hardware scroll is running.\n");
+        return -1;
+    }
+    uint8_t cmds[2] = { ssd1306_seg_remap_cmd(orientation), ssd1306_com_scan_cmd(orientation) };
+    if (ssd1306_send_command_sequence(dev, cmds, 2) != 0) {
+        return -1;
+    }
+    if ((orientation ^ dev->orientation) & SSD1306_ORIENT_MIRROR_X) {
+        ssd1306_mark_all_dirty(dev);
+    }
+    dev->orientation = orientation;
+    dev->col_offset = ssd1306_panel_col_offset(dev->panel, orientation);
     return 0;
 }
 
 // =========================================================================
 // Bước 4: Các hàm tiện ích (clear, display, draw_pixel)
 // =========================================================================
-void ssd1306_clear_buffer() {
-    memset(display_buffer, 0x00, SSD1306_BUFFER_SIZE);
+
+// Đánh dấu vùng cột [x0, x1] của các trang [page0, page1] là đã thay đổi.
+// Dùng khi ghi trực tiếp vào display_buffer mà không qua các hàm vẽ.
+void ssd1306_mark_dirty(ssd1306_t *dev, int x0, int x1, int page0, int page1) {
+    if (x0 < 0) x0 = 0;
+    if (x1 >= dev->width) x1 = dev->width - 1;
+    if (page0 < 0) page0 = 0;
+    if (page1 >= dev->pages) page1 = dev->pages - 1;
+    if (x0 > x1 || page0 > page1) return;
+
+    for (int page = page0; page <= page1; ++page) {
+        ssd1306_mark_span(dev, page, x0, x1);
+    }
 }
 
-void ssd1306_fill_buffer(uint8_t pattern) {
-    memset(display_buffer, pattern, SSD1306_BUFFER_SIZE);
+void ssd1306_mark_all_dirty(ssd1306_t *dev) {
+    ssd1306_mark_dirty(dev, 0, dev->width - 1, 0, dev->pages - 1);
 }
 
-void ssd1306_display_buffer() {
-    if (i2c_fd < 0) {
-        fprintf(stderr, "Error: I2C not initialized for display_buffer.\n");
+static void ssd1306_clear_dirty(ssd1306_dirty_t dirty, const ssd1306_window_t *w) {
+    for (int page = w->page_start; page <= w->page_end; ++page) {
+        for (int x = w->col_start; x <= w->col_end; ++x) {
+            dirty[page][x >> 6] &= ~(1ULL << (x & 63));
+        }
+    }
+}
+
+static int ssd1306_col_is_dirty(ssd1306_dirty_t dirty, int page, int x) {
+    return (dirty[page][x >> 6] >> (x & 63)) & 1;
+}
+
+void ssd1306_clear_buffer(ssd1306_t *dev) {
+    memset(dev->display_buffer, 0x00, SSD1306_BUFFER_SIZE);
+    ssd1306_mark_all_dirty(dev);
+}
+
+void ssd1306_fill_buffer(ssd1306_t *dev, uint8_t pattern) {
+    memset(dev->display_buffer, pattern, SSD1306_BUFFER_SIZE);
+    ssd1306_mark_all_dirty(dev);
+}
+
+// Lập kế hoạch flush: chọn tập cửa sổ có tổng chi phí (byte trên bus) nhỏ nhất.
+//  1. Trong mỗi trang, các đoạn cột bẩn được gộp lại nếu khoảng trống giữa chúng
+//     rẻ hơn chi phí mở một cửa sổ mới.
+//  2. Giữa các trang, quy hoạch động chọn gửi từng trang riêng hay gộp một dải
+//     trang liên tiếp thành một hình chữ nhật (hợp của các cột bẩn).
+// Chỉ xét W cột của P trang đầu (kích thước panel). Trả về số cửa sổ ghi vào windows
+// (tối đa max_windows).
+SSD1306_PANEL_INLINE int ssd1306_plan_dirty(ssd1306_dirty_t dirty, ssd1306_window_t *windows, int max_windows,
+                                            const int W, const int P) {
+    // Các đoạn của từng trang sau khi gộp theo chiều ngang
+    uint8_t span_start[SSD1306_PAGES][SSD1306_WIDTH / 2];
+    uint8_t span_end[SSD1306_PAGES][SSD1306_WIDTH / 2];
+    int span_count[SSD1306_PAGES];
+    int page_cost[SSD1306_PAGES];
+    int col_min[SSD1306_PAGES], col_max[SSD1306_PAGES];
+
+    for (int page = 0; page < P; ++page) {
+        int n = 0;
+        page_cost[page] = 0;
+        col_min[page] = -1;
+        col_max[page] = -1;
+
+        int x = 0;
+        while (x < W) {
+            if (!ssd1306_col_is_dirty(dirty, page, x)) { ++x; continue; }
+            int start = x;
+            while (x < W && ssd1306_col_is_dirty(dirty, page, x)) ++x;
+            int end = x - 1;
+
+            if (n > 0 && start - span_end[page][n - 1] - 1 <= SSD1306_WINDOW_OVERHEAD) {
+                span_end[page][n - 1] = end; // Gửi luôn phần trống còn rẻ hơn mở cửa sổ mới
+            } else {
+                span_start[page][n] = start;
+                span_end[page][n] = end;
+                ++n;
+            }
+        }
+        span_count[page] = n;
+        for (int i = 0; i < n; ++i) {
+            page_cost[page] += SSD1306_WINDOW_OVERHEAD + (span_end[page][i] - span_start[page][i] + 1);
+        }
+        if (n > 0) {
+            col_min[page] = span_start[page][0];
+            col_max[page] = span_end[page][n - 1];
+        }
+    }
+
+    // best[j]: chi phí nhỏ nhất để gửi các trang 0..j-1
+    // from[j] < 0: trang j-1 gửi riêng; ngược lại gộp các trang from[j]..j-1
+    int best[SSD1306_PAGES + 1];
+    int from[SSD1306_PAGES + 1];
+    best[0] = 0;
+    for (int j = 1; j <= P; ++j) {
+        int last = j - 1;
+        best[j] = best[j - 1] + page_cost[last];
+        from[j] = -1;
+        if (span_count[last] == 0) continue;
+
+        int cmin = col_min[last], cmax = col_max[last];
+        for (int i = last - 1; i >= 0; --i) {
+            if (span_count[i] == 0) continue; // Dải gộp luôn bắt đầu ở một trang bẩn
+            if (col_min[i] < cmin) cmin = col_min[i];
+            if (col_max[i] > cmax) cmax = col_max[i];
+            int width = cmax - cmin + 1;
+            // Cửa sổ hẹp hơn hàng của bộ đệm: mỗi hàng sau hàng đầu là một giao dịch riêng
+            int extra = width < SSD1306_WIDTH ? (j - i - 1) * SSD1306_TXN_OVERHEAD : 0;
+            int cost = best[i] + SSD1306_WINDOW_OVERHEAD + extra + (j - i) * width;
+            if (cost < best[j]) {
+                best[j] = cost;
+                from[j] = i;
+            }
+        }
+    }
+
+    // Truy vết ngược để lấy danh sách cửa sổ (thứ tự từ trang cuối lên)
+    int count = 0;
+    int j = P;
+    while (j > 0) {
+        if (from[j] < 0) {
+            int page = j - 1;
+            for (int i = 0; i < span_count[page] && count < max_windows; ++i) {
+                windows[count].col_start = span_start[page][i];
+                windows[count].col_end = span_end[page][i];
+                windows[count].page_start = page;
+                windows[count].page_end = page;
+                ++count;
+            }
+            j -= 1;
+        } else {
+            int i = from[j];
+            int cmin = W, cmax = -1;
+            for (int page = i; page < j; ++page) {
+                if (span_count[page] == 0) continue;
+                if (col_min[page] < cmin) cmin = col_min[page];
+                if (col_max[page] > cmax) cmax = col_max[page];
+            }
+            if (count < max_windows) {
+                windows[count].col_start = cmin;
+                windows[count].col_end = cmax;
+                windows[count].page_start = i;
+                windows[count].page_end = j - 1;
+                ++count;
+            }
+            j = i;
+        }
+    }
+    return count;
+}
+
+// Lập kế hoạch cho các vùng đã thay đổi của display_buffer
+int ssd1306_plan_flush(ssd1306_t *dev, ssd1306_window_t *windows, int max_windows) {
+    return dev->panel->ops->plan(dev->dirty_cols, windows, max_windows);
+}
+
+// Số hàng hình hiển thị bị dịch trong GDDRAM (0..63)
+static int ssd1306_scroll_shift(ssd1306_t *dev) {
+    return (dev->start_line + dev->display_offset) & (SSD1306_RAM_ROWS - 1);
+}
+
+// Ghép 8 hàng liên tiếp của frame bắt đầu từ hàng row (cột x0..x0+n-1) thành một byte trang.
+// Chỉ số hàng quay vòng theo wrap_rows; các trang không có trong frame (>= pages) đọc là 0.
+SSD1306_PANEL_INLINE void ssd1306_compose_rows(uint8_t *dst, const uint8_t *frame, int pages, int row, int wrap_rows,
+                                               int x0, int n) {
+    int k = row & 7;
+    int p1 = row >> 3;
+    int p2 = ((row + 8) % wrap_rows) >> 3;
+    const uint8_t *a = p1 < pages ? frame + p1 * SSD1306_WIDTH + x0 : NULL;
+    const uint8_t *b = k != 0 && p2 < pages ? frame + p2 * SSD1306_WIDTH + x0 : NULL;
+    int i = 0;
+
+    if (k == 0) {
+        if (a) memcpy(dst, a, n); else memset(dst, 0, n);
         return;
     }
+#if SSD1306_WORD_OPS
+    if (a && b) {
+        // Dịch 8 byte một lúc; bit tràn sang byte bên cạnh bị mặt nạ loại bỏ
+        uint64_t lo_mask = SSD1306_BYTES_X8(0xFF >> k);
+        uint64_t hi_mask = SSD1306_BYTES_X8(0xFF << (8 - k));
+        for (; i + 8 <= n; i += 8) {
+            uint64_t va, vb;
+            memcpy(&va, a + i, 8);
+            memcpy(&vb, b + i, 8);
+            va = ((va >> k) & lo_mask) | ((vb << (8 - k)) & hi_mask);
+            memcpy(dst + i, &va, 8);
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        dst[i] = (uint8_t)((a ? a[i] >> k : 0) | (b ? b[i] << (8 - k) : 0));
+    }
+}
+
+// Thêm vào batch cửa sổ cột [x0, x1] của trang GDDRAM q, dữ liệu ghép từ hàng first của frame
+SSD1306_PANEL_INLINE int ssd1306_batch_ram_span(ssd1306_t *dev, const uint8_t *frame, int pages, int first, int q,
+                                                int x0, int x1) {
+    ssd1306_batch_t *b = &dev->bus->batch;
+    uint8_t row[SSD1306_WIDTH];
+    int n = x1 - x0 + 1;
+
+    ssd1306_compose_rows(row, frame, pages, first, SSD1306_RAM_ROWS, x0, n);
+    ssd1306_batch_cmd3(b, SSD1306_SET_COLUMN_ADDR, x0 + dev->col_offset, x1 + dev->col_offset);
+    ssd1306_batch_cmd3(b, SSD1306_SET_PAGE_ADDR, q, q);
+    ssd1306_batch_data(b, row, n);
+    return n;
+}
 
-    // Thiết lập lại con trỏ cột và trang cho Horizontal Addressing Mode
-    // Lệnh này nói rằng chúng ta sẽ ghi vào toàn bộ vùng nhớ màn hình
-    ssd1306_send_command_2params(SSD1306_SET_COLUMN_ADDR, 0, SSD1306_WIDTH - 1);
-    ssd1306_send_command_2params(SSD1306_SET_PAGE_ADDR, 0, SSD1306_PAGES - 1);
+// Flush khi hình bị dịch dọc (start line/offset khác 0): trang GDDRAM q chứa các hàng
+// (8q - shift) .. của frame, thường nằm trên hai trang frame, nên dữ liệu được ghép lại
+// qua tx_batch (không zero-copy). Mỗi trang GDDRAM gửi các đoạn bẩn của nó, gộp khoảng
+// trống nhỏ như bộ lập kế hoạch.
+SSD1306_PANEL_INLINE int ssd1306_flush_frame_shifted(ssd1306_t *dev, const uint8_t *frame, ssd1306_dirty_t dirty,
+                                                     int shift, const int W, const int P) {
+    ssd1306_batch_t *b = &dev->bus->batch;
+    int windows = 0;
+    long copied = 0;
+
+    uint64_t txns0 = dev->bus->t.metrics.txns;
+    ssd1306_batch_begin(b, &dev->bus->t);
+    for (int q = 0; q < SSD1306_RAM_ROWS / 8; ++q) {
+        int first = (q * 8 - shift) & (SSD1306_RAM_ROWS - 1); // hàng frame ở bit 0 của trang q
+        int p1 = first >> 3;
+        int p2 = ((first + 8) & (SSD1306_RAM_ROWS - 1)) >> 3;
+        uint64_t d[SSD1306_DIRTY_WORDS] = {0};
+
+        for (int w = 0; w < SSD1306_DIRTY_WORDS; ++w) {
+            if (p1 < P) d[w] |= dirty[p1][w];
+            if ((first & 7) && p2 < P) d[w] |= dirty[p2][w];
+        }
 
-    // Gửi toàn bộ buffer dữ liệu
-    if (ssd1306_send_data(display_buffer, SSD1306_BUFFER_SIZE) != 0) {
+        int x = 0, start = -1, end = -1;
+        while (x < W) {
+            if (!((d[x >> 6] >> (x & 63)) & 1)) { ++x; continue; }
+            int s0 = x;
+            while (x < W && ((d[x >> 6] >> (x & 63)) & 1)) ++x;
+            if (start >= 0 && s0 - end - 1 <= SSD1306_WINDOW_OVERHEAD) {
+                end = x - 1; // Gửi luôn phần trống còn rẻ hơn mở cửa sổ mới
+                continue;
+            }
+            if (start >= 0) {
+                copied += ssd1306_batch_ram_span(dev, frame, P, first, q, start, end);
+                ++windows;
+            }
+            start = s0;
+            end = x - 1;
+        }
+        if (start >= 0) {
+            copied += ssd1306_batch_ram_span(dev, frame, P, first, q, start, end);
+            ++windows;
+        }
+    }
+
+    long sent = ssd1306_batch_flush(b);
+    dev->tx_stats.transactions += dev->bus->t.metrics.txns - txns0;
+    if (sent < 0) {
         fprintf(stderr, "Error sending display buffer to SSD1306\n");
+        return -1;
+    }
+    memset(dirty, 0, sizeof(ssd1306_dirty_t));
+    if (windows > 0) {
+        dev->tx_stats.flushes++;
+        dev->tx_stats.bytes += sent;
+        dev->tx_stats.copied_bytes += copied;
+    }
+    return (int)sent;
+}
+
+// Gửi các vùng bẩn của frame (bộ đệm có headroom) và xóa dấu bẩn của phần đã gửi.
+// Cột của cửa sổ được dời theo dev->col_offset (panel hẹp nằm giữa hoặc cuối GDDRAM).
+// Trả về tổng số byte đã ghi lên bus (kể cả byte lệnh và control byte), -1 nếu lỗi.
+SSD1306_PANEL_INLINE int ssd1306_send_frame(ssd1306_t *dev, uint8_t *frame, ssd1306_dirty_t dirty,
+                                            const int W, const int P) {
+    int shift = ssd1306_scroll_shift(dev);
+    if (shift != 0) {
+        return ssd1306_flush_frame_shifted(dev, frame, dirty, shift, W, P);
+    }
+
+    ssd1306_window_t windows[SSD1306_MAX_WINDOWS];
+    int count = ssd1306_plan_dirty(dirty, windows, SSD1306_MAX_WINDOWS, W, P);
+    int off = dev->col_offset;
+    int bytes_sent = 0;
+
+    for (int i = 0; i < count; ++i) {
+        const ssd1306_window_t *w = &windows[i];
+        int width = w->col_end - w->col_start + 1;
+        int pages = w->page_end - w->page_start + 1;
+        int offset = w->page_start * SSD1306_WIDTH + w->col_start;
+
+        // Lệnh đặt cửa sổ (Horizontal Addressing Mode) mã hóa Co = 1, theo sau là control byte dữ liệu;
+        // con trỏ tự xuống trang khi hết cột
+        const uint8_t hdr[SSD1306_TX_HEADROOM] = {
+            SSD1306_CONTROL_CMD_SINGLE, SSD1306_SET_COLUMN_ADDR,
+            SSD1306_CONTROL_CMD_SINGLE, (uint8_t)(w->col_start + off),
+            SSD1306_CONTROL_CMD_SINGLE, (uint8_t)(w->col_end + off),
+            SSD1306_CONTROL_CMD_SINGLE, SSD1306_SET_PAGE_ADDR,
+            SSD1306_CONTROL_CMD_SINGLE, w->page_start,
+            SSD1306_CONTROL_CMD_SINGLE, w->page_end,
+            SSD1306_DATA_MODE,
+        };
+        static const uint8_t data_hdr[1] = { SSD1306_DATA_MODE };
+
+        if (width == SSD1306_WIDTH) {
+            // Rộng đủ 128 cột: các trang liền nhau trong bộ đệm -> một giao dịch
+            if (ssd1306_send_span(dev, frame, hdr, SSD1306_TX_HEADROOM, offset, pages * width) != 0) {
+                fprintf(stderr, "Error sending display buffer to SSD1306\n");
+                return -1;
+            }
+            bytes_sent += SSD1306_TX_HEADROOM + pages * width;
+        } else {
+            // Các hàng không liền nhau: mỗi hàng một giao dịch, con trỏ địa chỉ chạy tiếp trong cửa sổ
+            for (int page = 0; page < pages; ++page) {
+                int rc = page == 0
+                    ? ssd1306_send_span(dev, frame, hdr, SSD1306_TX_HEADROOM, offset, width)
+                    : ssd1306_send_span(dev, frame, data_hdr, 1, offset + page * SSD1306_WIDTH, width);
+                if (rc != 0) {
+                    fprintf(stderr, "Error sending display buffer to SSD1306\n");
+                    return -1;
+                }
+                bytes_sent += (page == 0 ? SSD1306_TX_HEADROOM : 1) + width;
+            }
+        }
+        ssd1306_clear_dirty(dirty, w);
+    }
+    if (count > 0) {
+        dev->tx_stats.flushes++;
+    }
+    return bytes_sent;
+}
+
+// ssd1306_send_frame() kèm đo đạc: thời gian, byte và giao dịch thật trên bus (kể cả phần
+// chia nhỏ, lấy từ bộ đếm của transport), khoảng cách giữa các khung. Người gọi giữ bus.
+static int ssd1306_flush_frame(ssd1306_t *dev, uint8_t *frame, ssd1306_dirty_t dirty) {
+    ssd1306_metrics_t *m = &dev->metrics;
+    const ssd1306_transport_metrics_t *tm = &dev->bus->t.metrics;
+    uint64_t t0 = ssd1306_metrics_now();
+    uint64_t bytes0 = tm->bytes, txns0 = tm->txns;
+
+    int sent = dev->panel->ops->send_frame(dev, frame, dirty);
+    if (sent < 0) {
+        m->errors++;
+        return sent;
+    }
+    if (sent == 0) {
+        return 0;
+    }
+
+    uint64_t now = ssd1306_metrics_now();
+    ssd1306_hist_add(&m->flush_ns, now - t0);
+    ssd1306_hist_add(&m->flush_bytes, tm->bytes - bytes0);
+    ssd1306_hist_add(&m->flush_txns, tm->txns - txns0);
+    if (m->frames > 0) {
+        uint64_t interval = now - m->last_frame_ns;
+        ssd1306_hist_add(&m->frame_interval_ns, interval);
+        m->frame_avg_ns = m->frame_avg_ns ? m->frame_avg_ns - m->frame_avg_ns / 8 + interval / 8 : interval;
+    }
+    m->last_frame_ns = now;
+    m->frames++;
+    return sent;
+}
+
+// Gửi các vùng đã thay đổi lên màn hình.
+// Trả về tổng số byte đã ghi lên bus (kể cả byte lệnh và control byte), -1 nếu lỗi.
+// Không dùng khi luồng flush nền đang chạy (dùng ssd1306_present()), và phải gọi cùng luồng
+// với các hàm vẽ: header của mỗi giao dịch được ghi tạm vào display_buffer (ssd1306_send_span).
+// Khi panel đang cuộn liên tục thì không được ghi GDDRAM: trả về 0 và giữ dấu bẩn
+// cho tới ssd1306_stop_scroll().
+int ssd1306_display_buffer(ssd1306_t *dev) {
+    if (!ssd1306_transport_is_open(&dev->bus->t)) {
+        fprintf(stderr, "Error: I2C not initialized for display_buffer.\n");
+        return -1;
+    }
+    if (dev->hw_scroll_active) {
+        return 0;
+    }
+    uint64_t t0 = ssd1306_metrics_now();
+    if (ssd1306_bus_acquire(dev) != 0) {
+        return -1;
+    }
+    if (dev->metrics.last_call_ns != 0) {
+        ssd1306_hist_add(&dev->metrics.render_ns, t0 - dev->metrics.last_call_ns);
     }
     // printf("Buffer displayed.\n"); // Bỏ comment nếu muốn thấy log này
+    int sent = ssd1306_flush_frame(dev, dev->display_buffer, dev->dirty_cols);
+    dev->metrics.last_call_ns = ssd1306_metrics_now();
+    ssd1306_bus_release(dev);
+    return sent;
+}
+
+// Gửi lại toàn bộ khung hình, bỏ qua theo dõi vùng thay đổi
+int ssd1306_display_buffer_full(ssd1306_t *dev) {
+    ssd1306_mark_all_dirty(dev);
+    return ssd1306_display_buffer(dev);
 }
 
-void ssd1306_draw_pixel(int x, int y, int color) {
-    if (x < 0 || x >= SSD1306_WIDTH || y < 0 || y >= SSD1306_HEIGHT) {
+void ssd1306_draw_pixel(ssd1306_t *dev, int x, int y, int color) {
+    if ((unsigned)x >= (unsigned)dev->width || (unsigned)y >= (unsigned)dev->height) {
         return; // Ngoài màn hình
     }
 
-    int page = y / 8;
-    int bit_offset_in_page = y % 8;
+    int page = y >> 3;
+    uint8_t bit = 1 << (y & 7);
     // Trong Horizontal Addressing Mode, buffer được sắp xếp theo từng byte cho mỗi cột, tuần tự qua các trang
-    int byte_index_in_buffer = x + (page * SSD1306_WIDTH);
+    uint8_t *byte = &dev->display_buffer[x + page * SSD1306_WIDTH];
+
+    uint8_t value = color ? (*byte | bit) : (*byte & ~bit); // Bật (trắng) / tắt (đen) pixel
+    if (value != *byte) {
+        *byte = value;
+        dev->dirty_cols[page][x >> 6] |= 1ULL << (x & 63);
+    }
+}
+
+// =========================================================================
+// Vẽ khối: thao tác trên cả byte trang (8 hàng) và từ 64-bit (8 cột) thay vì từng pixel
+// =========================================================================
 
-    if (byte_index_in_buffer >= SSD1306_BUFFER_SIZE || byte_index_in_buffer < 0) { // Kiểm tra an toàn
-        fprintf(stderr, "Pixel index out of bounds: x=%d, y=%d -> index=%d\n", x, y, byte_index_in_buffer);
+// Đánh dấu bẩn các cột [x0, x1] của một trang bằng mặt nạ từ 64-bit
+static void ssd1306_mark_span(ssd1306_t *dev, int page, int x0, int x1) {
+    for (int w = x0 >> 6; w <= x1 >> 6; ++w) {
+        int lo = (w == x0 >> 6) ? (x0 & 63) : 0;
+        int hi = (w == x1 >> 6) ? (x1 & 63) : 63;
+        dev->dirty_cols[page][w] |= (~0ULL << lo) & (~0ULL >> (63 - hi));
+    }
+}
+
+// v = ((v & and_mask) | or_mask) ^ xor_mask trên các cột [x0, x1] của một trang, 8 cột mỗi vòng
+SSD1306_PANEL_INLINE void ssd1306_page_span_op(ssd1306_t *dev, int page, int x0, int x1, uint8_t and_mask, uint8_t or_mask, uint8_t xor_mask) {
+    uint8_t *row = dev->display_buffer + page * SSD1306_WIDTH;
+    int x = x0;
+
+#if SSD1306_WORD_OPS
+    uint64_t and64 = SSD1306_BYTES_X8(and_mask);
+    uint64_t or64 = SSD1306_BYTES_X8(or_mask);
+    uint64_t xor64 = SSD1306_BYTES_X8(xor_mask);
+    for (; x + 8 <= x1 + 1; x += 8) {
+        uint64_t v;
+        memcpy(&v, row + x, 8);
+        v = ((v & and64) | or64) ^ xor64;
+        memcpy(row + x, &v, 8);
+    }
+#endif
+    for (; x <= x1; ++x) {
+        row[x] = ((row[x] & and_mask) | or_mask) ^ xor_mask;
+    }
+    ssd1306_mark_span(dev, page, x0, x1);
+}
+
+// Cắt hình chữ nhật theo màn hình W x H. Trả về 0 nếu không còn gì để vẽ.
+SSD1306_PANEL_INLINE int ssd1306_clip_rect(int *x, int *y, int *w, int *h, const int W, const int H) {
+    if (*x < 0) { *w += *x; *x = 0; }
+    if (*y < 0) { *h += *y; *y = 0; }
+    if (*x + *w > W) *w = W - *x;
+    if (*y + *h > H) *h = H - *y;
+    return *w > 0 && *h > 0;
+}
+
+SSD1306_PANEL_INLINE void ssd1306_fill_rect_panel(ssd1306_t *dev, int x, int y, int w, int h, int color,
+                                                  const int W, const int H) {
+    if (!ssd1306_clip_rect(&x, &y, &w, &h, W, H)) return;
+
+    int y1 = y + h - 1;
+    for (int page = y >> 3; page <= y1 >> 3; ++page) {
+        // Mặt nạ các hàng của trang nằm trong [y, y1]
+        int top = page == (y >> 3) ? (y & 7) : 0;
+        int bottom = page == (y1 >> 3) ? (y1 & 7) : 7;
+        uint8_t mask = (uint8_t)((0xFF << top) & (0xFF >> (7 - bottom)));
+
+        if (color == SSD1306_COLOR_INVERT) {
+            ssd1306_page_span_op(dev, page, x, x + w - 1, 0xFF, 0x00, mask);
+        } else if (color) {
+            ssd1306_page_span_op(dev, page, x, x + w - 1, 0xFF, mask, 0x00);
+        } else {
+            ssd1306_page_span_op(dev, page, x, x + w - 1, (uint8_t)~mask, 0x00, 0x00);
+        }
+    }
+}
+
+void ssd1306_fill_rect(ssd1306_t *dev, int x, int y, int w, int h, int color) {
+    dev->panel->ops->fill_rect(dev, x, y, w, h, color);
+}
+
+void ssd1306_draw_hline(ssd1306_t *dev, int x, int y, int w, int color) {
+    ssd1306_fill_rect(dev, x, y, w, 1, color);
+}
+
+void ssd1306_draw_vline(ssd1306_t *dev, int x, int y, int h, int color) {
+    ssd1306_fill_rect(dev, x, y, 1, h, color);
+}
+
+void ssd1306_draw_rect(ssd1306_t *dev, int x, int y, int w, int h, int color) {
+    if (w <= 0 || h <= 0) return;
+    ssd1306_draw_hline(dev, x, y, w, color);
+    if (h > 1) ssd1306_draw_hline(dev, x, y + h - 1, w, color);
+    if (h > 2) {
+        ssd1306_draw_vline(dev, x, y + 1, h - 2, color);
+        if (w > 1) ssd1306_draw_vline(dev, x + w - 1, y + 1, h - 2, color);
+    }
+}
+
+void ssd1306_invert_rect(ssd1306_t *dev, int x, int y, int w, int h) {
+    ssd1306_fill_rect(dev, x, y, w, h, SSD1306_COLOR_INVERT);
+}
+
+// Trộn n byte (đã dịch và che mặt nạ) của một trang nguồn vào một trang đích.
+// shift > 0: dịch lên bit cao (phần trên của byte nguồn rơi vào trang này),
+// shift < 0: dịch xuống bit thấp (phần dưới tràn sang trang kế).
+SSD1306_PANEL_INLINE void ssd1306_blit_row(uint8_t *dst, const uint8_t *src, int n, int shift, uint8_t valid, int mode) {
+    uint8_t mask = shift >= 0 ? (uint8_t)(valid << shift) : (uint8_t)(valid >> -shift);
+    int i = 0;
+
+#if SSD1306_WORD_OPS
+    uint8_t keep = shift >= 0 ? (uint8_t)(0xFF << shift) : (uint8_t)(0xFF >> -shift);
+    uint64_t keep64 = SSD1306_BYTES_X8(keep);
+    uint64_t mask64 = SSD1306_BYTES_X8(mask);
+    for (; i + 8 <= n; i += 8) {
+        uint64_t s, d;
+        memcpy(&s, src + i, 8);
+        memcpy(&d, dst + i, 8);
+        // Dịch cả 8 byte cùng lúc; bit tràn sang byte bên cạnh bị keep64 loại bỏ
+        s = (shift >= 0 ? (s << shift) : (s >> -shift)) & keep64 & mask64;
+        switch (mode) {
+        case SSD1306_BLIT_OR:  d |= s; break;
+        case SSD1306_BLIT_AND: d &= s | ~mask64; break;
+        case SSD1306_BLIT_XOR: d ^= s; break;
+        default:               d = (d & ~mask64) | s; break;
+        }
+        memcpy(dst + i, &d, 8);
+    }
+#endif
+    for (; i < n; ++i) {
+        uint8_t s = (uint8_t)(shift >= 0 ? (src[i] << shift) : (src[i] >> -shift)) & mask;
+        switch (mode) {
+        case SSD1306_BLIT_OR:  dst[i] |= s; break;
+        case SSD1306_BLIT_AND: dst[i] &= s | (uint8_t)~mask; break;
+        case SSD1306_BLIT_XOR: dst[i] ^= s; break;
+        default:               dst[i] = (dst[i] & (uint8_t)~mask) | s; break;
+        }
+    }
+}
+
+// Phần lõi của ssd1306_blit() trên màn hình W cột, P trang. Nếu mark = 0 thì không đánh
+// dấu bẩn, để người gọi đánh dấu một lần cho cả vùng (ví dụ cả dòng chữ).
+SSD1306_PANEL_INLINE void ssd1306_blit_pages(ssd1306_t *dev, const uint8_t *bitmap, int bw, int bh, int x, int y,
+                                             int mode, int mark, const int W, const int P) {
+    int sx0 = x < 0 ? -x : 0;
+    int dx0 = x + sx0;
+    int n = bw - sx0;
+    if (dx0 + n > W) n = W - dx0;
+    if (n <= 0 || bh <= 0) return;
+
+    int src_pages = (bh + 7) >> 3;
+    for (int sp = 0; sp < src_pages; ++sp) {
+        const uint8_t *src = bitmap + sp * bw + sx0;
+        uint8_t valid = (sp == src_pages - 1 && (bh & 7)) ? (uint8_t)((1 << (bh & 7)) - 1) : 0xFF;
+        int top = y + sp * 8;                    // hàng màn hình của bit 0
+        int page = top >= 0 ? top >> 3 : -((7 - top) >> 3);
+        int shift = top - page * 8;              // 0..7
+
+        if (page >= 0 && page < P) {
+            ssd1306_blit_row(dev->display_buffer + page * SSD1306_WIDTH + dx0, src, n, shift, valid, mode);
+            if (mark) ssd1306_mark_span(dev, page, dx0, dx0 + n - 1);
+        }
+        if (shift != 0 && page + 1 >= 0 && page + 1 < P) {
+            ssd1306_blit_row(dev->display_buffer + (page + 1) * SSD1306_WIDTH + dx0, src, n, shift - 8, valid, mode);
+            if (mark) ssd1306_mark_span(dev, page + 1, dx0, dx0 + n - 1);
+        }
+    }
+}
+
+// Vẽ ảnh 1-bit bw x bh tại (x, y) bất kỳ. Ảnh có cùng bố cục với display_buffer:
+// mỗi byte là 8 pixel dọc của một cột, các trang ảnh nối tiếp nhau (bitmap[page * bw + col]).
+// Khi y không chia hết cho 8, mỗi trang ảnh được dịch bit và tách sang hai trang màn hình.
+void ssd1306_blit(ssd1306_t *dev, const uint8_t *bitmap, int bw, int bh, int x, int y, int mode) {
+    dev->panel->ops->blit(dev, bitmap, bw, bh, x, y, mode, 1);
+}
+
+// Thay cả khung bằng frame (bố cục trang, SSD1306_BUFFER_SIZE byte), so 8 cột mỗi vòng và
+// chỉ đánh dấu bẩn các byte khác khung trước -> flush chỉ gửi phần thay đổi. Chỉ phần
+// W cột x P trang của panel được chép. Trả về số byte đã thay đổi.
+SSD1306_PANEL_INLINE int ssd1306_load_frame_panel(ssd1306_t *dev, const uint8_t *frame, const int W, const int P) {
+    int changed = 0;
+    for (int page = 0; page < P; ++page) {
+        uint8_t *dst = dev->display_buffer + page * SSD1306_WIDTH;
+        const uint8_t *src = frame + page * SSD1306_WIDTH;
+        for (int x = 0; x < W; x += 8) {
+            uint64_t a, b;
+            memcpy(&a, dst + x, 8);
+            memcpy(&b, src + x, 8);
+            uint64_t d = a ^ b;
+            if (d == 0) continue;
+
+            // Gộp mỗi byte khác nhau thành bit 0 của byte đó để đếm và tìm đoạn khác
+            uint64_t m = d | (d >> 4);
+            m |= m >> 2;
+            m |= m >> 1;
+            m &= 0x0101010101010101ULL;
+            changed += __builtin_popcountll(m);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            int lo = x + (__builtin_ctzll(m) >> 3);
+            int hi = x + 7 - (__builtin_clzll(m) >> 3);
+#else
+            int lo = x, hi = x + 7;
+#endif
+            memcpy(dst + x, &b, 8);
+            ssd1306_mark_span(dev, page, lo, hi);
+        }
+    }
+    return changed;
+}
+
+int ssd1306_load_frame(ssd1306_t *dev, const uint8_t *frame) {
+    return dev->panel->ops->load_frame(dev, frame);
+}
+
+// So sánh khung với shadow theo từng từ 64-bit (8 cột), đánh dấu các cột khác nhau trong
+// W cột x P trang của panel
+SSD1306_PANEL_INLINE void ssd1306_diff_frame(const uint8_t *frame, const uint8_t *shadow, ssd1306_dirty_t dirty,
+                                             const int W, const int P) {
+    memset(dirty, 0, sizeof(ssd1306_dirty_t));
+    for (int page = 0; page < P; ++page) {
+        for (int x = 0; x < W; x += 8) {
+            int i = page * SSD1306_WIDTH + x;
+            uint64_t a, b;
+            memcpy(&a, frame + i, 8);
+            memcpy(&b, shadow + i, 8);
+            if (a == b) continue;
+            for (int k = 0; k < 8; ++k) {
+                if (frame[i + k] != shadow[i + k]) {
+                    dirty[page][(x + k) >> 6] |= 1ULL << ((x + k) & 63);
+                }
+            }
+        }
+    }
+}
+
+// =========================================================================
+// Vẽ chữ: tra glyph O(1) trong bảng phông (ssd1306_font.h), blit tại y bất kỳ.
+// ssd1306_draw_string() đo cả dòng trước, vẽ các glyph không đánh dấu bẩn, rồi đánh
+// dấu một lần cho hình chữ nhật của dòng -> mỗi trang chỉ có một đoạn cột bẩn liền
+// (kể cả cột khoảng cách giữa các chữ), flush thành một cửa sổ duy nhất.
+// =========================================================================
+
+// Đọc một ký tự từ chuỗi và tiến *s. Nhận UTF-8 (mã > 0xFF sẽ dùng glyph thay thế);
+// byte không phải UTF-8 hợp lệ được hiểu là Latin-1 thô.
+uint32_t ssd1306_next_codepoint(const char **s) {
+    const uint8_t *p = (const uint8_t *)*s;
+    uint32_t cp = p[0];
+    int n = cp >= 0xF0 ? 4 : cp >= 0xE0 ? 3 : cp >= 0xC0 ? 2 : 1;
+
+    for (int i = 1; i < n; ++i) {
+        if ((p[i] & 0xC0) != 0x80) { n = 1; break; } // không phải UTF-8: Latin-1
+    }
+    if (n > 1) {
+        cp &= 0x7F >> n;
+        for (int i = 1; i < n; ++i) cp = (cp << 6) | (p[i] & 0x3F);
+    }
+    *s += n;
+    return cp;
+}
+
+// Độ rộng (pixel) của chuỗi khi vẽ bằng font, không tính khoảng cách sau ký tự cuối
+int ssd1306_text_width(const ssd1306_font_t *font, const char *str) {
+    int count = 0;
+    while (*str) {
+        ssd1306_next_codepoint(&str);
+        ++count;
+    }
+    return count ? count * ssd1306_font_advance(font) - font->spacing : 0;
+}
+
+// Vẽ một ký tự tại (x, y). Trả về độ rộng bước tiến.
+int ssd1306_draw_char(ssd1306_t *dev, const ssd1306_font_t *font, int x, int y, uint32_t cp, int mode) {
+    ssd1306_blit(dev, ssd1306_font_glyph(font, cp), font->width, font->height, x, y, mode);
+    return ssd1306_font_advance(font);
+}
+
+// Vẽ chuỗi tại (x, y). Với SSD1306_BLIT_COPY nền của cả dòng (gồm khoảng cách) được xóa,
+// các chế độ khác chỉ trộn glyph. Trả về x ngay sau ký tự cuối.
+int ssd1306_draw_string(ssd1306_t *dev, const ssd1306_font_t *font, int x, int y, const char *str, int mode) {
+    const uint8_t *glyphs[SSD1306_WIDTH];
+    int advance = ssd1306_font_advance(font);
+    int skipped = 0, count = 0, total = 0;
+
+    // Bước đo: tra glyph cho các ký tự rơi vào màn hình, phần bị cắt hai bên chỉ được đếm
+    while (*str) {
+        uint32_t cp = ssd1306_next_codepoint(&str);
+        int cx = x + total++ * advance;
+        if (cx + font->width <= 0) {
+            ++skipped;
+        } else if (cx < dev->width) {
+            glyphs[count++] = ssd1306_font_glyph(font, cp);
+        }
+    }
+    if (count == 0) return x + total * advance;
+
+    int x0 = x + skipped * advance;
+    int w = count * advance - font->spacing;
+    if (mode == SSD1306_BLIT_COPY) {
+        // Xóa nền một lần rồi OR glyph: như COPY từng glyph nhưng gồm cả cột khoảng cách
+        ssd1306_fill_rect(dev, x0, y, w, font->height, SSD1306_COLOR_BLACK);
+        mode = SSD1306_BLIT_OR;
+    }
+    for (int i = 0; i < count; ++i) {
+        dev->panel->ops->blit(dev, glyphs[i], font->width, font->height, x0 + i * advance, y, mode, 0);
+    }
+    ssd1306_mark_dirty(dev, x0, x0 + w - 1, y >> 3, (y + font->height - 1) >> 3);
+    return x + total * advance;
+}
+
+// =========================================================================
+// Hình học panel
+// Bộ đệm luôn có hàng dài SSD1306_WIDTH byte (đúng một trang GDDRAM), panel chỉ dùng W cột
+// đầu của P trang đầu. Mỗi panel có một bản riêng của các vòng lặp nóng, sinh từ cùng một
+// thân hàm với W, H là hằng số, nên panel 128x64 chạy đúng mã như khi kích thước còn cố
+// định lúc biên dịch; hàm công khai chỉ thêm một lần gọi qua dev->panel->ops.
+// =========================================================================
+
+#define SSD1306_PANEL_OPS(id, W, H)                                                                 \
+    static int ssd1306_plan_##id(ssd1306_dirty_t dirty, ssd1306_window_t *windows, int max_windows) { \
+        return ssd1306_plan_dirty(dirty, windows, max_windows, W, (H) / 8);                         \
+    }                                                                                               \
+    static int ssd1306_send_frame_##id(ssd1306_t *dev, uint8_t *frame, ssd1306_dirty_t dirty) {     \
+        return ssd1306_send_frame(dev, frame, dirty, W, (H) / 8);                                   \
+    }                                                                                               \
+    static void ssd1306_fill_rect_##id(ssd1306_t *dev, int x, int y, int w, int h, int color) {     \
+        ssd1306_fill_rect_panel(dev, x, y, w, h, color, W, H);                                      \
+    }                                                                                               \
+    static void ssd1306_blit_##id(ssd1306_t *dev, const uint8_t *bitmap, int bw, int bh, int x, int y, \
+                                  int mode, int mark) {                                             \
+        ssd1306_blit_pages(dev, bitmap, bw, bh, x, y, mode, mark, W, (H) / 8);                      \
+    }                                                                                               \
+    static int ssd1306_load_frame_##id(ssd1306_t *dev, const uint8_t *frame) {                      \
+        return ssd1306_load_frame_panel(dev, frame, W, (H) / 8);                                    \
+    }                                                                                               \
+    static void ssd1306_diff_frame_##id(const uint8_t *frame, const uint8_t *shadow, ssd1306_dirty_t dirty) { \
+        ssd1306_diff_frame(frame, shadow, dirty, W, (H) / 8);                                       \
+    }                                                                                               \
+    static const ssd1306_panel_ops_t ssd1306_ops_##id = {                                           \
+        ssd1306_plan_##id, ssd1306_send_frame_##id, ssd1306_fill_rect_##id,                         \
+        ssd1306_blit_##id, ssd1306_load_frame_##id, ssd1306_diff_frame_##id,                        \
+    };
+
+SSD1306_PANEL_OPS(128x64, 128, 64)
+SSD1306_PANEL_OPS(128x32, 128, 32)
+SSD1306_PANEL_OPS(64x48, 64, 48)
+SSD1306_PANEL_OPS(96x16, 96, 16)
+
+// col_offset: cột GDDRAM của cột 0 khi remap 0xA1 (theo u8g2). com_pins: 0x12 cho panel nối
+// COM xen kẽ, 0x02 cho panel nối tuần tự.
+const ssd1306_panel_t ssd1306_panels[] = {
+    { "128x64", 128, 64, 0,  0x12, &ssd1306_ops_128x64 },
+    { "128x32", 128, 32, 0,  0x02, &ssd1306_ops_128x32 },
+    { "64x48",  64,  48, 32, 0x12, &ssd1306_ops_64x48 },
+    { "96x16",  96,  16, 0,  0x02, &ssd1306_ops_96x16 },
+};
+const int ssd1306_panel_count = sizeof(ssd1306_panels) / sizeof(ssd1306_panels[0]);
+
+// Tìm panel theo tên ("128x64", ...). Trả về NULL nếu không có.
+const ssd1306_panel_t *ssd1306_panel_find(const char *name) {
+    for (int i = 0; name != NULL && i < ssd1306_panel_count; ++i) {
+        if (strcmp(ssd1306_panels[i].name, name) == 0) return &ssd1306_panels[i];
+    }
+    return NULL;
+}
+
+// Panel mặc định: biến môi trường SSD1306_PANEL, nếu không có thì SSD1306_DEFAULT_PANEL
+const ssd1306_panel_t *ssd1306_default_panel(void) {
+    const char *name = getenv("SSD1306_PANEL");
+    const ssd1306_panel_t *panel = ssd1306_panel_find(name);
+    if (name != NULL && panel == NULL) {
+        fprintf(stderr, "Error: Unknown panel '%s' in SSD1306_PANEL, using %s.\n", name, SSD1306_DEFAULT_PANEL);
+    }
+    if (panel == NULL) panel = ssd1306_panel_find(SSD1306_DEFAULT_PANEL);
+    return panel != NULL ? panel : &ssd1306_panels[0];
+}
+
+// Đổi panel của màn hình. Gọi trước ssd1306_init() (multiplex, chân COM lấy từ panel);
+// không dùng khi luồng flush nền đang chạy hoặc đang cuộn phần cứng. Trả về 0/-1.
+int ssd1306_set_panel(ssd1306_t *dev, const ssd1306_panel_t *panel) {
+    if (panel == NULL) {
+        fprintf(stderr, "Error: Invalid panel.\n");
+        return -1;
+    }
+    if (atomic_load(&dev->bus->flusher_running) || dev->hw_scroll_active) {
+        fprintf(stderr, "Error: Cannot change panel while flushing or scrolling.\n");
+        return -1;
+    }
+    dev->panel = panel;
+    dev->width = panel->width;
+    dev->height = panel->height;
+    dev->pages = panel->height / 8;
+    dev->col_offset = ssd1306_panel_col_offset(panel, dev->orientation);
+    ssd1306_mark_all_dirty(dev);
+    return 0;
+}
+
+// =========================================================================
+// Bước 5: Luồng flush nền (triple buffering không khóa), một luồng cho mỗi bus
+// Bên vẽ ghi vào display_buffer (bộ đệm sau) rồi gọi ssd1306_present().
+// present() công bố khung bằng một atomic_exchange lên ô "ready" của màn hình; luồng
+// flush của bus luôn lấy khung mới nhất, các khung trung gian bị bỏ qua khi bên vẽ
+// nhanh hơn bus. Các bus khác nhau flush song song.
+// Trên cùng một bus, luồng flush phục vụ các màn hình theo vòng round-robin, mỗi lượt
+// mỗi màn hình gửi tối đa một khung, nên một màn hình present liên tục không chiếm bus
+// của các màn hình còn lại.
+// Khi luồng flush đang chạy, chỉ luồng đó được gửi khung lên bus.
+// =========================================================================
+
+static uint8_t *ssd1306_slot(ssd1306_t *dev, int slot) {
+    return dev->storage[slot] + SSD1306_TX_HEADROOM;
+}
+
+// Lấy và gửi khung mới nhất của dev nếu có. Trả về 1 nếu đã lấy một khung, 0 nếu không có khung mới.
+// Chỉ khung gửi thành công được tính vào frames_flushed; khung lỗi tăng metrics.frames_failed.
+static int ssd1306_flush_pending(ssd1306_t *dev) {
+    if (!(atomic_load(&dev->frame_ready) & SSD1306_SLOT_NEW)) {
+        return 0;
+    }
+    unsigned int prev = atomic_exchange(&dev->frame_ready, (unsigned int)dev->frame_front);
+    dev->frame_front = prev & SSD1306_SLOT_INDEX_MASK;
+
+    const uint8_t *frame = ssd1306_slot(dev, dev->frame_front);
+    uint8_t *shadow = dev->shadow_storage + SSD1306_TX_HEADROOM;
+    ssd1306_dirty_t dirty;
+
+    if (dev->shadow_valid) {
+        dev->panel->ops->diff_frame(frame, shadow, dirty);
+    } else {
+        memset(dirty, 0xFF, sizeof(dirty));
+    }
+    memcpy(shadow, frame, SSD1306_BUFFER_SIZE);
+    if (ssd1306_bus_acquire(dev) == 0) {
+        dev->shadow_valid = ssd1306_flush_frame(dev, shadow, dirty) >= 0;
+        if (!dev->shadow_valid) dev->metrics.frames_failed++;
+        ssd1306_bus_release(dev);
+    } else {
+        // Bus chưa mở hoặc không đặt được địa chỉ: metrics chỉ ghi khi giữ khóa bus
+        dev->shadow_valid = 0;
+        pthread_mutex_lock(&dev->bus->lock);
+        dev->metrics.frames_failed++;
+        pthread_mutex_unlock(&dev->bus->lock);
+    }
+    if (dev->shadow_valid) {
+        atomic_fetch_add(&dev->frames_flushed, 1);
+    }
+    return 1;
+}
+
+static void *ssd1306_bus_flusher_main(void *arg) {
+    ssd1306_bus_t *bus = arg;
+
+    for (;;) {
+        while (sem_wait(&bus->frame_sem) != 0) {
+            // EINTR: chờ tiếp
+        }
+        // Quét các màn hình theo vòng cho tới khi không còn khung chờ: mỗi lượt xét mỗi màn
+        // hình đúng một lần, điểm bắt đầu xoay sau mỗi lượt có gửi để màn hình đứng đầu danh sách
+        // không luôn được ưu tiên
+        int served;
+        do {
+            const int n = bus->display_count, start = bus->next_display;
+            served = 0;
+            for (int i = 0; i < n; ++i) {
+                if (ssd1306_flush_pending(bus->displays[(start + i) % n])) {
+                    ++served;
+                }
+            }
+            if (served > 0) bus->next_display = (start + 1) % n;
+        } while (served > 0);
+        // Các lần post còn lại ứng với khung đã được lấy ở lượt trên (present bị gộp)
+        if (!atomic_load(&bus->flusher_running)) break;
+    }
+    return NULL;
+}
+
+// Chuyển các màn hình trên bus sang chế độ flush nền. Lần gửi đầu tiên của mỗi màn hình luôn là toàn khung.
+int ssd1306_bus_start_flusher(ssd1306_bus_t *bus) {
+    if (atomic_load(&bus->flusher_running)) return 0;
+    if (!ssd1306_transport_is_open(&bus->t)) {
+        fprintf(stderr, "Error: I2C not initialized for flusher.\n");
+        return -1;
+    }
+    for (int i = 0; i < bus->display_count; ++i) {
+        if (bus->displays[i]->hw_scroll_active) {
+            fprintf(stderr, "Error: Cannot start flusher while hardware scroll is active.\n");
+            return -1;
+        }
+    }
+
+    for (int i = 0; i < bus->display_count; ++i) {
+        ssd1306_t *dev = bus->displays[i];
+        dev->frame_front = (dev->frame_back + 1) % SSD1306_FRAME_SLOTS;
+        atomic_store(&dev->frame_ready, (unsigned int)((dev->frame_back + 2) % SSD1306_FRAME_SLOTS));
+        dev->shadow_valid = 0;
+    }
+    bus->next_display = 0;
+    if (sem_init(&bus->frame_sem, 0, 0) != 0) {
+        perror("Failed to init flusher semaphore");
+        return -1;
+    }
+    atomic_store(&bus->flusher_running, 1);
+    if (pthread_create(&bus->flusher_thread, NULL, ssd1306_bus_flusher_main, bus) != 0) {
+        perror("Failed to start flusher thread");
+        atomic_store(&bus->flusher_running, 0);
+        sem_destroy(&bus->frame_sem);
+        return -1;
+    }
+    return 0;
+}
+
+// Công bố display_buffer làm khung mới nhất. Không chờ bus (chỉ giữ render_lock trong vài lệnh);
+// nếu luồng flush của bus không chạy thì gửi trực tiếp như ssd1306_display_buffer().
+int ssd1306_present(ssd1306_t *dev) {
+    ssd1306_bus_t *bus = dev->bus;
+    if (!atomic_load(&bus->flusher_running)) {
+        return ssd1306_display_buffer(dev) < 0 ? -1 : 0;
+    }
+
+    // Không giữ khóa bus (luồng flush có thể đang gửi): render_lock chỉ bao vài lệnh,
+    // đủ để ssd1306_get_metrics() không đọc histogram đang ghi dở
+    uint64_t now = ssd1306_metrics_now();
+    pthread_mutex_lock(&dev->render_lock);
+    if (dev->metrics.last_call_ns != 0) {
+        ssd1306_hist_add(&dev->metrics.render_ns, now - dev->metrics.last_call_ns);
+    }
+    dev->metrics.last_call_ns = now;
+    pthread_mutex_unlock(&dev->render_lock);
+
+    int published = dev->frame_back;
+    unsigned int prev = atomic_exchange(&dev->frame_ready, (unsigned int)published | SSD1306_SLOT_NEW);
+    if (prev & SSD1306_SLOT_NEW) {
+        atomic_fetch_add(&dev->frames_dropped, 1);
+    }
+    atomic_fetch_add(&dev->frames_presented, 1);
+
+    // Bộ đệm sau mới đang chứa một khung cũ: chép khung vừa công bố để tiếp tục vẽ tăng dần
+    dev->frame_back = prev & SSD1306_SLOT_INDEX_MASK;
+    memcpy(ssd1306_slot(dev, dev->frame_back), ssd1306_slot(dev, published), SSD1306_BUFFER_SIZE);
+    dev->display_buffer = ssd1306_slot(dev, dev->frame_back);
+
+    sem_post(&bus->frame_sem);
+    return 0;
+}
+
+// Dừng luồng flush sau khi gửi các khung đang chờ (nếu có) và quay lại chế độ flush trực tiếp
+void ssd1306_bus_stop_flusher(ssd1306_bus_t *bus) {
+    if (!atomic_load(&bus->flusher_running)) return;
+    atomic_store(&bus->flusher_running, 0);
+    sem_post(&bus->frame_sem);
+    pthread_join(bus->flusher_thread, NULL);
+    sem_destroy(&bus->frame_sem);
+
+    // Dấu bẩn của chế độ trực tiếp = phần khác nhau giữa display_buffer và màn hình
+    for (int i = 0; i < bus->display_count; ++i) {
+        ssd1306_t *dev = bus->displays[i];
+        if (dev->shadow_valid) {
+            dev->panel->ops->diff_frame(dev->display_buffer, dev->shadow_storage + SSD1306_TX_HEADROOM, dev->dirty_cols);
+        } else {
+            ssd1306_mark_all_dirty(dev);
+        }
+    }
+}
+
+void ssd1306_get_frame_stats(ssd1306_t *dev, ssd1306_frame_stats_t *stats) {
+    stats->presented = atomic_load(&dev->frames_presented);
+    stats->flushed = atomic_load(&dev->frames_flushed);
+    stats->dropped = atomic_load(&dev->frames_dropped);
+}
+
+// Bản sao nhất quán của bộ đo (lấy khóa bus nên chờ lần gửi đang chạy xong)
+void ssd1306_get_metrics(ssd1306_t *dev, ssd1306_metrics_t *out) {
+    pthread_mutex_lock(&dev->bus->lock);
+    pthread_mutex_lock(&dev->render_lock);
+    *out = dev->metrics;
+    pthread_mutex_unlock(&dev->render_lock);
+    pthread_mutex_unlock(&dev->bus->lock);
+}
+
+void ssd1306_get_bus_metrics(ssd1306_bus_t *bus, ssd1306_transport_metrics_t *out) {
+    pthread_mutex_lock(&bus->lock);
+    *out = bus->t.metrics;
+    pthread_mutex_unlock(&bus->lock);
+}
+
+void ssd1306_reset_metrics(ssd1306_bus_t *bus) {
+    pthread_mutex_lock(&bus->lock);
+    memset(&bus->t.metrics, 0, sizeof(bus->t.metrics));
+    bus->t.metrics.start_ns = ssd1306_metrics_now();
+    for (int i = 0; i < bus->display_count; ++i) {
+        pthread_mutex_lock(&bus->displays[i]->render_lock);
+        memset(&bus->displays[i]->metrics, 0, sizeof(bus->displays[i]->metrics));
+        pthread_mutex_unlock(&bus->displays[i]->render_lock);
+    }
+    pthread_mutex_unlock(&bus->lock);
+}
+
+// =========================================================================
+// Nhiều màn hình: mở N màn hình rải trên nhiều bus, mỗi bus một luồng flush
+// =========================================================================
+
+void ssd1306_group_close(ssd1306_group_t *g) {
+    for (int i = 0; i < g->bus_count; ++i) {
+        ssd1306_bus_close(g->buses[i]);
+    }
+    memset(g, 0, sizeof(*g));
+}
+
+// Mở và khởi tạo n màn hình. Các spec cùng path dùng chung một bus.
+// Trả về 0 nếu thành công; nếu lỗi thì đóng mọi thứ đã mở và trả về -1.
+int ssd1306_group_open(ssd1306_group_t *g, const char *backend, uint32_t bus_hz,
+                       const ssd1306_display_spec_t *specs, int n) {
+    memset(g, 0, sizeof(*g));
+    if (n > SSD1306_MAX_BUSES * SSD1306_MAX_BUS_DISPLAYS) {
+        fprintf(stderr, "Error: Too many displays (%d).\n", n);
+        return -1;
+    }
+    for (int i = 0; i < n; ++i) {
+        ssd1306_bus_t *bus = NULL;
+        for (int k = 0; k < g->bus_count; ++k) {
+            if (strcmp(g->buses[k]->path, specs[i].path) == 0) bus = g->buses[k];
+        }
+        if (bus == NULL) {
+            if (g->bus_count == SSD1306_MAX_BUSES ||
+                (bus = ssd1306_bus_open(backend, specs[i].path, bus_hz)) == NULL) {
+                ssd1306_group_close(g);
+                return -1;
+            }
+            g->buses[g->bus_count++] = bus;
+        }
+
+        ssd1306_t *dev = ssd1306_open(bus, specs[i].addr);
+        if (dev != NULL && specs[i].panel != NULL) {
+            const ssd1306_panel_t *panel = ssd1306_panel_find(specs[i].panel);
+            if (panel == NULL) fprintf(stderr, "Error: Unknown panel '%s'.\n", specs[i].panel);
+            if (panel == NULL || ssd1306_set_panel(dev, panel) != 0) dev = NULL; // bus vẫn giữ dev để đóng
+        }
+        if (dev == NULL || ssd1306_init(dev) != 0) {
+            ssd1306_group_close(g);
+            return -1;
+        }
+        g->displays[g->display_count++] = dev;
+    }
+    return 0;
+}
+
+int ssd1306_group_start_flushers(ssd1306_group_t *g) {
+    for (int i = 0; i < g->bus_count; ++i) {
+        if (ssd1306_bus_start_flusher(g->buses[i]) != 0) {
+            while (--i >= 0) ssd1306_bus_stop_flusher(g->buses[i]);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void ssd1306_group_stop_flushers(ssd1306_group_t *g) {
+    for (int i = 0; i < g->bus_count; ++i) {
+        ssd1306_bus_stop_flusher(g->buses[i]);
+    }
+}
+
+// =========================================================================
+// Cuộn bằng phần cứng
+//   - Dịch dọc: start line (0x40 | n) và display offset (0xD3). display_buffer được quay
+//     theo nên vẫn là hình đang hiển thị; mỗi bước chỉ tốn 2-3 byte lệnh thay vì cả khung.
+//   - Cuộn liên tục ngang (0x26/0x27) và chéo (0x29/0x2A): panel tự dịch GDDRAM, trong lúc
+//     đó không được ghi GDDRAM; khi dừng, các trang bị cuộn được gửi lại từ display_buffer.
+// Không dùng khi luồng flush nền đang chạy.
+// =========================================================================
+
+static int ssd1306_scroll_check(ssd1306_t *dev) {
+    if (!ssd1306_transport_is_open(&dev->bus->t)) {
+        fprintf(stderr, "Error: I2C bus not open for scrolling.\n");
+        return -1;
+    }
+    if (atomic_load(&dev->bus->flusher_running)) {
+        fprintf(stderr, "Error: Cannot scroll while the background flusher is running.\n");
+        return -1;
+    }
+    return 0;
+}
+
+// Quay display_buffer và dấu bẩn lên rows hàng (0 < rows < dev->height):
+// hàng y mới là hàng (y + rows) cũ, các hàng trên cùng quay vòng xuống dưới
+static void ssd1306_rotate_buffer(ssd1306_t *dev, int rows) {
+    uint8_t old_buffer[SSD1306_BUFFER_SIZE]; // trên stack: các màn hình có thể cuộn đồng thời từ nhiều luồng
+    ssd1306_dirty_t old_dirty;
+
+    memcpy(old_buffer, dev->display_buffer, SSD1306_BUFFER_SIZE);
+    memcpy(old_dirty, dev->dirty_cols, sizeof(old_dirty));
+    for (int page = 0; page < dev->pages; ++page) {
+        int first = (page * 8 + rows) % dev->height;
+        int p1 = first >> 3;
+        int p2 = ((first + 8) % dev->height) >> 3;
+
+        ssd1306_compose_rows(dev->display_buffer + page * SSD1306_WIDTH, old_buffer, dev->pages, first, dev->height,
+                             0, dev->width);
+        for (int w = 0; w < SSD1306_DIRTY_WORDS; ++w) {
+            dev->dirty_cols[page][w] = old_dirty[p1][w] | ((first & 7) ? old_dirty[p2][w] : 0);
+        }
+    }
+}
+
+// Đặt start line và display offset trong một giao dịch rồi quay display_buffer theo.
+// GDDRAM quay vòng theo 64 hàng: với panel thấp hơn 64 hàng, các hàng mới lộ ra chưa từng
+// được ghi nên trang chứa chúng được đánh dấu bẩn để lần flush sau gửi bù.
+static int ssd1306_set_vertical_shift(ssd1306_t *dev, int start_line, int offset) {
+    if (ssd1306_scroll_check(dev) != 0) return -1;
+    start_line &= SSD1306_RAM_ROWS - 1;
+    offset &= SSD1306_RAM_ROWS - 1;
+
+    uint8_t cmds[3];
+    int n = 0;
+    if (start_line != dev->start_line) {
+        cmds[n++] = SSD1306_SET_DISPLAY_START_LINE_CMD | start_line;
+    }
+    if (offset != dev->display_offset) {
+        cmds[n++] = SSD1306_SET_DISPLAY_OFFSET;
+        cmds[n++] = offset;
+    }
+    if (n == 0) return 0;
+
+    int delta = (start_line + offset - ssd1306_scroll_shift(dev)) & (SSD1306_RAM_ROWS - 1);
+    if (ssd1306_send_command_sequence(dev, cmds, n) != 0) {
+        return -1;
+    }
+    dev->start_line = start_line;
+    dev->display_offset = offset;
+
+    if (delta % dev->height != 0) {
+        ssd1306_rotate_buffer(dev, delta % dev->height);
+    }
+    for (int page = 0; page < dev->pages; ++page) {
+        // Hàng y hiện hàng GDDRAM của hàng cũ (y + delta) % 64; hàng cũ >= dev->height thì chưa có
+        int last = (page * 8 + 7 + delta) & (SSD1306_RAM_ROWS - 1);
+        int first = (page * 8 + delta) & (SSD1306_RAM_ROWS - 1);
+        if (first >= dev->height || last >= dev->height || last < first) {
+            ssd1306_mark_dirty(dev, 0, dev->width - 1, page, page);
+        }
+    }
+    return 0;
+}
+
+// Đặt thanh ghi start line (0..63)
+int ssd1306_set_start_line(ssd1306_t *dev, int line) {
+    return ssd1306_set_vertical_shift(dev, line, dev->display_offset);
+}
+
+// Đặt thanh ghi display offset 0xD3 (0..63)
+int ssd1306_set_display_offset(ssd1306_t *dev, int offset) {
+    return ssd1306_set_vertical_shift(dev, dev->start_line, offset);
+}
+
+// Dịch nội dung lên rows hàng (âm: dịch xuống) chỉ bằng lệnh start line. Các hàng trôi qua
+// mép trên quay vòng xuống dưới như trong GDDRAM; người gọi vẽ đè dòng mới vào đó rồi
+// flush, ví dụ một khung log hoặc chữ chạy dọc.
+int ssd1306_pan(ssd1306_t *dev, int rows) {
+    return ssd1306_set_start_line(dev, dev->start_line + rows);
+}
+
+static int ssd1306_check_scroll_pages(int page0, int page1) {
+    if (page0 < 0 || page1 >= SSD1306_RAM_ROWS / 8 || page0 > page1) {
+        fprintf(stderr, "Error: Invalid scroll pages %d..%d.\n", page0, page1);
+        return -1;
+    }
+    return 0;
+}
+
+// Bắt đầu cuộn ngang liên tục các trang GDDRAM [page0, page1].
+// dir > 0: sang phải (0x26), dir < 0: sang trái (0x27); interval: SSD1306_SCROLL_FRAMES_*.
+// Các vùng bẩn được gửi trước vì trong lúc cuộn không được ghi GDDRAM.
+int ssd1306_start_scroll(ssd1306_t *dev, int dir, int page0, int page1, uint8_t interval) {
+    if (ssd1306_scroll_check(dev) != 0 || ssd1306_check_scroll_pages(page0, page1) != 0) return -1;
+    if (!dev->hw_scroll_active && ssd1306_display_buffer(dev) < 0) return -1;
+
+    const uint8_t cmds[] = {
+        SSD1306_DEACTIVATE_SCROLL, // Phải dừng trước khi đổi tham số cuộn
+        dir > 0 ? SSD1306_RIGHT_HORIZONTAL_SCROLL : SSD1306_LEFT_HORIZONTAL_SCROLL,
+        0x00, (uint8_t)page0, (uint8_t)(interval & 0x07), (uint8_t)page1, 0x00, 0xFF,
+        SSD1306_ACTIVATE_SCROLL,
+    };
+    if (ssd1306_send_command_sequence(dev, cmds, sizeof(cmds)) != 0) {
+        return -1;
+    }
+    dev->hw_scroll_active = 1;
+    dev->hw_scroll_page0 = page0;
+    dev->hw_scroll_page1 = page1;
+    dev->hw_scroll_vertical = 0;
+    return 0;
+}
+
+// Bắt đầu cuộn chéo: các trang [page0, page1] cuộn ngang, đồng thời vùng hàng
+// [area_top, area_top + area_rows) cuộn dọc rows_per_step hàng mỗi bước.
+// dir > 0: dọc + phải (0x29), dir < 0: dọc + trái (0x2A).
+int ssd1306_start_scroll_diagonal(ssd1306_t *dev, int dir, int page0, int page1, uint8_t interval,
+                                  int rows_per_step, int area_top, int area_rows) {
+    if (ssd1306_scroll_check(dev) != 0 || ssd1306_check_scroll_pages(page0, page1) != 0) return -1;
+    if (area_top < 0 || area_rows <= 0 || area_top + area_rows > dev->height ||
+        rows_per_step <= 0 || rows_per_step >= area_rows) {
+        fprintf(stderr, "Error: Invalid vertical scroll area.\n");
+        return -1;
+    }
+    if (!dev->hw_scroll_active && ssd1306_display_buffer(dev) < 0) return -1;
+
+    const uint8_t cmds[] = {
+        SSD1306_DEACTIVATE_SCROLL,
+        SSD1306_SET_VERTICAL_SCROLL_AREA, (uint8_t)area_top, (uint8_t)area_rows,
+        dir > 0 ? SSD1306_VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL : SSD1306_VERTICAL_AND_LEFT_HORIZONTAL_SCROLL,
+        0x00, (uint8_t)page0, (uint8_t)(interval & 0x07), (uint8_t)page1, (uint8_t)rows_per_step,
+        SSD1306_ACTIVATE_SCROLL,
+    };
+    if (ssd1306_send_command_sequence(dev, cmds, sizeof(cmds)) != 0) {
+        return -1;
+    }
+    dev->hw_scroll_active = 1;
+    dev->hw_scroll_page0 = page0;
+    dev->hw_scroll_page1 = page1;
+    dev->hw_scroll_vertical = 1;
+    return 0;
+}
+
+// Dừng cuộn liên tục (0x2E). Cuộn phần cứng đã dịch nội dung GDDRAM, nên các trang bị cuộn
+// được gửi lại từ display_buffer ngay sau đó. Trả về số byte như ssd1306_display_buffer().
+int ssd1306_stop_scroll(ssd1306_t *dev) {
+    if (ssd1306_scroll_check(dev) != 0) return -1;
+    if (!dev->hw_scroll_active) return 0;
+
+    const uint8_t cmds[] = {
+        SSD1306_DEACTIVATE_SCROLL,
+        (uint8_t)(SSD1306_SET_DISPLAY_START_LINE_CMD | dev->start_line),
+    };
+    if (ssd1306_send_command_sequence(dev, cmds, sizeof(cmds)) != 0) {
+        return -1;
+    }
+    dev->hw_scroll_active = 0;
+
+    if (dev->hw_scroll_vertical || ssd1306_scroll_shift(dev) != 0) {
+        ssd1306_mark_all_dirty(dev);
+    } else {
+        ssd1306_mark_dirty(dev, 0, dev->width - 1, dev->hw_scroll_page0, dev->hw_scroll_page1);
+    }
+    return ssd1306_display_buffer(dev);
+}
+
+#ifndef SSD1306_NO_MAIN // Các chương trình khác (benchmark) liên kết driver mà không cần main
+
+// Hai màn hình (0x3C, 0x3D) trên mỗi bus mô phỏng, mỗi khung đổi toàn bộ nội dung.
+// In số khung/giây tổng và của từng màn hình: tổng tăng theo số bus, các màn hình cùng bus chia đều.
+static void ssd1306_multi_display_demo(int buses, uint32_t bus_hz) {
+    ssd1306_display_spec_t specs[SSD1306_MAX_BUSES * 2];
+    char paths[SSD1306_MAX_BUSES][16];
+    int n = 0;
+    for (int b = 0; b < buses; ++b) {
+        snprintf(paths[b], sizeof(paths[b]), "/dev/i2c-%d", b + 1);
+        specs[n++] = (ssd1306_display_spec_t){ paths[b], SSD1306_I2C_ADDR, NULL };
+        specs[n++] = (ssd1306_display_spec_t){ paths[b], SSD1306_I2C_ADDR_ALT, NULL };
+    }
+
+    ssd1306_group_t group;
+    if (ssd1306_group_open(&group, "mem", bus_hz, specs, n) != 0) return;
+    for (int b = 0; b < group.bus_count; ++b) {
+        group.buses[b]->t.mem.realtime = 1;
+    }
+    if (ssd1306_group_start_flushers(&group) != 0) {
+        ssd1306_group_close(&group);
         return;
     }
 
-    if (color) { // Bật pixel (trắng)
-        display_buffer[byte_index_in_buffer] |= (1 << bit_offset_in_page);
-    } else { // Tắt pixel (đen)
-        display_buffer[byte_index_in_buffer] &= ~(1 << bit_offset_in_page);
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int frame = 0; frame < 200; ++frame) {
+        for (int i = 0; i < group.display_count; ++i) {
+            ssd1306_invert_rect(group.displays[i], 0, 0, group.displays[i]->width, group.displays[i]->height);
+            ssd1306_present(group.displays[i]);
+        }
+        delay_ms(5);
     }
+    ssd1306_group_stop_flushers(&group);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    double seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    uint64_t total = 0, min_flushed = UINT64_MAX, max_flushed = 0;
+    for (int i = 0; i < group.display_count; ++i) {
+        ssd1306_frame_stats_t fs;
+        ssd1306_get_frame_stats(group.displays[i], &fs);
+        total += fs.flushed;
+        if (fs.flushed < min_flushed) min_flushed = fs.flushed;
+        if (fs.flushed > max_flushed) max_flushed = fs.flushed;
+    }
+    printf("%d bus(es), %d displays: %.1f frames/s total, %.1f..%.1f frames/s per display\n",
+           group.bus_count, group.display_count, total / seconds,
+           min_flushed / seconds, max_flushed / seconds);
+    ssd1306_group_close(&group);
 }
 
 // =========================================================================
-// Bước 5: Hàm main để thử nghiệm
+// Bước 6: Hàm main để thử nghiệm
 // =========================================================================
-int main() {
+// Cách dùng: ./ssd1306_c_driver [auto|dev|rdwr|smbus|mem] [tốc độ bus mô phỏng, Hz]
+// Biên dịch: make ssd1306_c_driver
+int main(int argc, char *argv[]) {
+    const char *backend = argc > 1 ? argv[1] : "auto";
+    uint32_t bus_hz = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : SSD1306_BUS_400KHZ;
+
     printf("Starting SSD1306 C driver test...\n");
 
-    if (ssd1306_open_i2c() != 0) {
+    ssd1306_bus_t *bus = ssd1306_bus_open(backend, I2C_BUS_PATH, bus_hz);
+    if (bus == NULL) {
         return 1;
     }
 
-    if (ssd1306_init() != 0) {
+    ssd1306_t *dev = ssd1306_open(bus, SSD1306_I2C_ADDR);
+    if (dev == NULL || ssd1306_init(dev) != 0) {
         fprintf(stderr, "Failed to initialize SSD1306.\n");
-        ssd1306_close_i2c();
+        ssd1306_bus_close(bus);
         return 1;
     }
     
     // Xóa buffer sau khi init (init có thể đã làm nhưng để chắc chắn)
-    ssd1306_clear_buffer();
-    ssd1306_display_buffer(); // Hiển thị màn hình trống
+    ssd1306_clear_buffer(dev);
+    ssd1306_display_buffer(dev); // Hiển thị màn hình trống
     delay_ms(500); // Chờ 0.5 giây
 
     // 1. Xóa màn hình (đổ màu đen vào buffer và hiển thị)
     printf("Clearing screen (setting buffer to 0x00)...\n");
-    ssd1306_clear_buffer();
-    ssd1306_display_buffer();
+    ssd1306_clear_buffer(dev);
+    ssd1306_display_buffer(dev);
     delay_ms(1000); // Chờ 1 giây
 
     // 2. Vẽ một vài pixel
     printf("Drawing pixels...\n");
-    ssd1306_draw_pixel(0, 0, 1);                            // Góc trên trái
-    ssd1306_draw_pixel(SSD1306_WIDTH - 1, 0, 1);            // Góc trên phải
-    ssd1306_draw_pixel(0, SSD1306_HEIGHT - 1, 1);           // Góc dưới trái
-    ssd1306_draw_pixel(SSD1306_WIDTH - 1, SSD1306_HEIGHT - 1, 1); // Góc dưới phải
-    ssd1306_draw_pixel(SSD1306_WIDTH / 2, SSD1306_HEIGHT / 2, 1); // Điểm giữa
+    ssd1306_draw_pixel(dev, 0, 0, 1);                            // Góc trên trái
+    ssd1306_draw_pixel(dev, dev->width - 1, 0, 1);            // Góc trên phải
+    ssd1306_draw_pixel(dev, 0, dev->height - 1, 1);           // Góc dưới trái
+    ssd1306_draw_pixel(dev, dev->width - 1, dev->height - 1, 1); // Góc dưới phải
+    ssd1306_draw_pixel(dev, dev->width / 2, dev->height / 2, 1); // Điểm giữa
 
-    // Vẽ đường chéo từ (0,0) đến (HEIGHT-1, HEIGHT-1)
-    for (int i = 0; i < SSD1306_HEIGHT; ++i) {
-        if (i < SSD1306_WIDTH) { // Đảm bảo không vẽ ra ngoài nếu màn hình không vuông
-             ssd1306_draw_pixel(i, i, 1);
+    // Vẽ đường chéo từ (0,0) đến (height-1, height-1)
+    for (int i = 0; i < dev->height; ++i) {
+        if (i < dev->width) { // Đảm bảo không vẽ ra ngoài nếu màn hình không vuông
+             ssd1306_draw_pixel(dev, i, i, 1);
         }
     }
-    ssd1306_display_buffer(); // Hiển thị các pixel đã vẽ
+    int sent = ssd1306_display_buffer(dev); // Hiển thị các pixel đã vẽ (chỉ gửi vùng thay đổi)
+    printf("Partial flush sent %d bytes.\n", sent);
     delay_ms(2000); // Chờ 2 giây
 
     // 3. Đổ đầy màn hình (tất cả pixel màu trắng)
     printf("Filling screen (setting buffer to 0xFF)...\n");
-    ssd1306_fill_buffer(0xFF); // 0xFF để bật tất cả các pixel
-    ssd1306_display_buffer();
+    ssd1306_fill_buffer(dev, 0xFF); // 0xFF để bật tất cả các pixel
+    ssd1306_display_buffer(dev);
     delay_ms(2000); // Chờ 2 giây
 
     // 4. Xóa lại màn hình
     printf("Clearing screen again...\n");
-    ssd1306_clear_buffer();
-    ssd1306_display_buffer();
+    ssd1306_clear_buffer(dev);
+    ssd1306_display_buffer(dev);
     delay_ms(1000);
 
+    // 5. Vẽ chữ: mỗi dòng là một đoạn cột bẩn liền, y không cần chia hết cho 8
+    printf("Drawing text...\n");
+    const char *title = "SSD1306";
+    int title_x = (dev->width - ssd1306_text_width(&ssd1306_font_8x16, title)) / 2;
+    ssd1306_draw_string(dev, &ssd1306_font_8x16, title_x, 3, title, SSD1306_BLIT_COPY);
+    ssd1306_draw_string(dev, &ssd1306_font_5x7, 0, 21, "Latin-1: \xC0\xE9\xF1\xFC\xDF \xA9\xB0", SSD1306_BLIT_COPY);
+    ssd1306_draw_string(dev, &ssd1306_font_5x7, 0, 30, "UTF-8: \u00C5ngstr\u00F6m \u00BD", SSD1306_BLIT_COPY);
+    sent = ssd1306_display_buffer(dev);
+    printf("Text flush sent %d bytes.\n", sent);
+    delay_ms(2000);
+    ssd1306_clear_buffer(dev);
+    ssd1306_display_buffer(dev);
+
+    // 6. Console chữ (21x8 trên màn 128x64): chỉ gửi các ô đổi, xuống dòng ở đáy cuộn bằng start line
+    printf("Scrolling log on the text console...\n");
+    ssd1306_console_t con;
+    ssd1306_console_init(&con, dev);
+    for (int line = 0; line < 12; ++line) {
+        ssd1306_console_printf(&con, "%slog line %d", line ? "\n" : "", line);
+        ssd1306_console_print_at(&con, 0, con.cols - 3, SSD1306_ATTR_INVERSE, line & 1 ? "RX" : "TX");
+        sent = ssd1306_console_update(&con);
+        if (line == con.rows) printf("Console scroll step sent %d bytes + 2 command bytes.\n", sent);
+        delay_ms(200);
+    }
+    ssd1306_start_scroll(dev, -1, 0, dev->pages - 1, SSD1306_SCROLL_FRAMES_2);
+    delay_ms(2000);
+    ssd1306_stop_scroll(dev);
+    ssd1306_set_start_line(dev, 0);
+    ssd1306_clear_buffer(dev);
+    ssd1306_display_buffer(dev);
+
+    // 7. Chế độ flush nền: vẽ một khối chạy ngang, luồng flush gộp các khung khi bus chậm hơn
+    printf("Animating with background flusher...\n");
+    if (ssd1306_bus_start_flusher(bus) == 0) {
+        for (int frame = 0; frame < dev->width - 8; ++frame) {
+            for (int y = dev->height / 2 - 8; y < dev->height / 2 + 8; ++y) {
+                ssd1306_draw_pixel(dev, frame, y, 0);
+                ssd1306_draw_pixel(dev, frame + 8, y, 1);
+            }
+            ssd1306_present(dev);
+            delay_ms(5);
+        }
+        ssd1306_bus_stop_flusher(bus);
+
+        ssd1306_frame_stats_t fs;
+        ssd1306_get_frame_stats(dev, &fs);
+        printf("Frames: %llu presented, %llu flushed, %llu dropped\n",
+               (unsigned long long)fs.presented, (unsigned long long)fs.flushed,
+               (unsigned long long)fs.dropped);
+    }
+
     // Tùy chọn: Tắt màn hình khi kết thúc
     // printf("Turning display OFF.\n");
     // ssd1306_send_single_command(SSD1306_DISPLAY_OFF);
 
-    ssd1306_close_i2c();
+    if (strcmp(bus->t.ops->name, "mem") == 0) {
+        ssd1306_mem_print_stats(&bus->t, stdout);
+
+        // Đo chi phí CPU và số byte phải sao chép cho mỗi lần flush toàn khung
+        const int frames = 200;
+        ssd1306_tx_stats_t before = dev->tx_stats;
+        uint64_t t0 = ssd1306_cpu_time_ns();
+        for (int i = 0; i < frames; ++i) {
+            ssd1306_mem_reset(&bus->t);
+            ssd1306_display_buffer_full(dev);
+        }
+        uint64_t t1 = ssd1306_cpu_time_ns();
+        printf("Full flush: %.0f ns CPU/frame, %.1f transactions/frame, %.0f bytes copied/frame\n",
+               (double)(t1 - t0) / frames,
+               (double)(dev->tx_stats.transactions - before.transactions) / frames,
+               (double)(dev->tx_stats.copied_bytes - before.copied_bytes) / frames);
+
+        // So sánh tốc độ vẽ: từng pixel với ssd1306_draw_pixel() và theo khối với ssd1306_fill_rect()
+        const int rounds = 200;
+        const double pixels = (double)rounds * dev->width * dev->height;
+        t0 = ssd1306_cpu_time_ns();
+        for (int r = 0; r < rounds; ++r) {
+            for (int y = 0; y < dev->height; ++y) {
+                for (int x = 0; x < dev->width; ++x) {
+                    ssd1306_draw_pixel(dev, x, y, r & 1);
+                }
+            }
+        }
+        t1 = ssd1306_cpu_time_ns();
+        // Mỗi vòng: một hình lệch trang (W-2)x(H-5) và một hình kín màn hình
+        const double rect_pixels = (double)rounds * ((dev->width - 2) * (dev->height - 5) + dev->width * dev->height);
+        uint64_t t2 = ssd1306_cpu_time_ns();
+        for (int r = 0; r < rounds; ++r) {
+            ssd1306_fill_rect(dev, 1, 3, dev->width - 2, dev->height - 5, r & 1);
+            ssd1306_fill_rect(dev, 0, 0, dev->width, dev->height, r & 1);
+        }
+        uint64_t t3 = ssd1306_cpu_time_ns();
+        printf("Drawing: draw_pixel %.1f Mpx/s, fill_rect %.1f Mpx/s\n",
+               pixels / ((t1 - t0) / 1e9) / 1e6, rect_pixels / ((t3 - t2) / 1e9) / 1e6);
+    }
+
+    // Bộ đo của cả phiên chạy: độ trễ từng syscall, byte/giao dịch mỗi flush, fps, lỗi
+    printf("Metrics:\n");
+    ssd1306_metrics_print(bus, stdout);
+    ssd1306_bus_close(bus);
+
+    // 8. Nhiều màn hình: thông lượng tổng theo số bus (bus mô phỏng chạy theo thời gian thật)
+    if (strcmp(backend, "mem") == 0) {
+        for (int buses = 1; buses <= 4; buses *= 2) {
+            ssd1306_multi_display_demo(buses, bus_hz);
+        }
+    }
+
     printf("SSD1306 C driver test finished.\n");
     return 0;
 }
+
+#endif // SSD1306_NO_MAIN
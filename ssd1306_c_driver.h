@@ -0,0 +1,360 @@
+#ifndef SSD1306_C_DRIVER_H
+#define SSD1306_C_DRIVER_H
+
+#include <stdint.h>
+#include <pthread.h>        // For luồng flush nền
+#include <semaphore.h>      // For sem_post() khi present
+#include <stdatomic.h>      // For trao đổi bộ đệm không khóa
+
+#include "ssd1306_transport.h"
+#include "ssd1306_font.h"
+
+// =========================================================================
+// Driver SSD1306 userspace: hằng số, kiểu dữ liệu và các hàm công khai
+// Dùng chung cho chương trình thử nghiệm (ssd1306_c_driver.c) và benchmark.
+// =========================================================================
+
+// Địa chỉ I2C của SSD1306 (thường là 0x3C, kiểm tra bằng i2cdetect -y 1)
+#define SSD1306_I2C_ADDR         0x3C
+#define SSD1306_I2C_ADDR_ALT     0x3D // Chân SA0/D/C# nối lên VCC
+
+// Tên file device I2C (thường là /dev/i2c-1 trên Raspberry Pi)
+#define I2C_BUS_PATH             "/dev/i2c-1"
+
+// Kích thước GDDRAM (128x64), cũng là bố cục của display_buffer: hàng trang kế tiếp luôn
+// cách SSD1306_WIDTH byte. Kích thước thật của từng màn hình (dev->width, dev->height,
+// dev->pages) chọn lúc chạy từ bảng ssd1306_panels[]; panel nhỏ hơn dùng góc trên trái.
+#define SSD1306_WIDTH            128
+#define SSD1306_HEIGHT           64
+#define SSD1306_PAGES            (SSD1306_HEIGHT / 8)
+#define SSD1306_BUFFER_SIZE      (SSD1306_WIDTH * SSD1306_PAGES)
+
+// Panel mặc định khi mở màn hình; biến môi trường SSD1306_PANEL (ví dụ "128x32") đổi
+// được lúc chạy mà không cần sửa chương trình
+#ifndef SSD1306_DEFAULT_PANEL
+#define SSD1306_DEFAULT_PANEL    "128x64"
+#endif
+
+// Control byte
+#define SSD1306_COMMAND_MODE     0x00 // Co = 0, D/C# = 0
+#define SSD1306_DATA_MODE        0x40 // Co = 0, D/C# = 1
+
+// Fundamental Command Table
+#define SSD1306_SET_CONTRAST                  0x81
+#define SSD1306_DISPLAY_ALL_ON_RESUME         0xA4
+#define SSD1306_DISPLAY_ALL_ON_IGNORE_RAM     0xA5
+#define SSD1306_NORMAL_DISPLAY                0xA6
+#define SSD1306_INVERT_DISPLAY                0xA7
+#define SSD1306_DISPLAY_OFF                   0xAE
+#define SSD1306_DISPLAY_ON                    0xAF
+
+// Addressing Setting Command Table
+#define SSD1306_SET_MEMORY_ADDR_MODE          0x20
+#define SSD1306_SET_COLUMN_ADDR               0x21
+#define SSD1306_SET_PAGE_ADDR                 0x22
+// For Page Addressing Mode only
+#define SSD1306_SET_PAGE_START_ADDR_CM        0xB0 // For command mode, add page number (0-7)
+
+// Hardware Configuration Command Table
+#define SSD1306_SET_DISPLAY_START_LINE_CMD    0x40 // Add line number (0-63)
+#define SSD1306_SET_SEGMENT_REMAP_NORMAL      0xA0 // Column 0 maps to SEG0
+#define SSD1306_SET_SEGMENT_REMAP_REVERSE     0xA1 // Column 127 maps to SEG0 (default for many modules)
+#define SSD1306_SET_MULTIPLEX_RATIO           0xA8
+#define SSD1306_SET_COM_OUTPUT_SCAN_DIR_NORMAL 0xC0 // Scan from COM0 to COM[N-1]
+#define SSD1306_SET_COM_OUTPUT_SCAN_DIR_REMAPPED 0xC8 // Scan from COM[N-1] to COM0 (default for many modules)
+#define SSD1306_SET_DISPLAY_OFFSET            0xD3
+#define SSD1306_SET_COM_PINS_HW_CONFIG        0xDA
+#define SSD1306_RAM_ROWS                      64   // GDDRAM luôn có 64 hàng, start line/offset quay vòng theo 64
+
+// Scrolling Command Table
+#define SSD1306_RIGHT_HORIZONTAL_SCROLL       0x26
+#define SSD1306_LEFT_HORIZONTAL_SCROLL        0x27
+#define SSD1306_VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL 0x29
+#define SSD1306_VERTICAL_AND_LEFT_HORIZONTAL_SCROLL  0x2A
+#define SSD1306_DEACTIVATE_SCROLL             0x2E
+#define SSD1306_ACTIVATE_SCROLL               0x2F
+#define SSD1306_SET_VERTICAL_SCROLL_AREA      0xA3
+
+// Khoảng thời gian giữa hai bước cuộn (tính theo số khung hình)
+#define SSD1306_SCROLL_FRAMES_5               0x00
+#define SSD1306_SCROLL_FRAMES_64              0x01
+#define SSD1306_SCROLL_FRAMES_128             0x02
+#define SSD1306_SCROLL_FRAMES_256             0x03
+#define SSD1306_SCROLL_FRAMES_3               0x04
+#define SSD1306_SCROLL_FRAMES_4               0x05
+#define SSD1306_SCROLL_FRAMES_25              0x06
+#define SSD1306_SCROLL_FRAMES_2               0x07
+
+// Timing & Driving Scheme Setting Command Table
+#define SSD1306_SET_DISPLAY_CLOCK_DIV         0xD5
+#define SSD1306_SET_PRECHARGE_PERIOD          0xD9
+#define SSD1306_SET_VCOMH_DESELECT_LEVEL      0xDB
+#define SSD1306_NOP                           0xE3
+
+// Charge Pump Command Table
+#define SSD1306_CHARGE_PUMP_SETTING           0x8D
+#define SSD1306_CHARGE_PUMP_ENABLE            0x14
+#define SSD1306_CHARGE_PUMP_DISABLE           0x10
+
+// Mô hình chi phí cho bộ lập kế hoạch flush (đơn vị: byte trên bus).
+// Mỗi giao dịch I2C tốn 1 byte địa chỉ + 1 control byte (bỏ qua START/STOP).
+#define SSD1306_TXN_OVERHEAD     2
+// Mở một cửa sổ = 6 byte lệnh (0x21, 0x22) mã hóa Co = 1 (mỗi byte kèm một control byte)
+// nằm chung giao dịch với dữ liệu
+#define SSD1306_WINDOW_OVERHEAD  (2 * 6 + SSD1306_TXN_OVERHEAD)
+
+// Khoảng trống đặt trước display_buffer: đủ cho 6 byte lệnh cửa sổ mã hóa Co = 1 (12 byte)
+// + control byte dữ liệu, để flush ghi header ngay trước dữ liệu và gửi không cần sao chép
+#define SSD1306_TX_HEADROOM      (2 * 6 + 1)
+
+// Lặp một byte thành 8 byte của một từ 64-bit (xử lý 8 cột cùng lúc)
+#define SSD1306_BYTES_X8(b)      ((uint64_t)(uint8_t)(b) * 0x0101010101010101ULL)
+
+// Vòng lặp 8 cột/từ của fill/blit/ghép hàng: mặt nạ lặp đủ 8 byte và bit dịch tràn sang byte
+// bên cạnh bị mặt nạ loại bỏ, nên đúng với cả little- lẫn big-endian. Thứ tự byte khác, hoặc
+// trình biên dịch không cho biết __BYTE_ORDER__, thì chỉ dùng vòng lặp từng byte.
+#if defined(__BYTE_ORDER__) && \
+    (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ || __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define SSD1306_WORD_OPS         1
+#else
+#define SSD1306_WORD_OPS         0
+#endif
+
+// Chuyển vị ma trận bit 8x8 chứa trong một từ 64-bit (byte i = hàng i, bit j = cột j):
+// bit (8i + j) -> bit (8j + i). Ba bước hoán đổi khối 1x1, 2x2, 4x4.
+static inline uint64_t ssd1306_transpose8x8(uint64_t x) {
+    uint64_t t;
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x ^= t ^ (t << 28);
+    return x;
+}
+
+// Bitmap "cột bẩn": mỗi trang có một bit cho mỗi cột đã thay đổi kể từ lần flush trước
+#define SSD1306_DIRTY_WORDS      ((SSD1306_WIDTH + 63) / 64)
+#define SSD1306_MAX_WINDOWS      (SSD1306_PAGES * (SSD1306_WIDTH / 2))
+
+// Bitmap cột bẩn cho toàn màn hình
+typedef uint64_t ssd1306_dirty_t[SSD1306_PAGES][SSD1306_DIRTY_WORDS];
+
+// Ba bộ đệm khung hình cho chế độ flush nền (triple buffering)
+#define SSD1306_FRAME_SLOTS      3
+#define SSD1306_SLOT_NEW         0x4 // ô ready chứa khung chưa được flush
+#define SSD1306_SLOT_INDEX_MASK  0x3
+
+// Một cửa sổ (hình chữ nhật cột x trang) cần gửi lên màn hình
+typedef struct {
+    uint8_t col_start, col_end;   // cột đầu/cuối (bao gồm)
+    uint8_t page_start, page_end; // trang đầu/cuối (bao gồm)
+} ssd1306_window_t;
+
+// Bộ đếm của đường truyền (tăng dần, không reset)
+typedef struct {
+    uint64_t flushes;       // số lần ssd1306_display_buffer() gửi ít nhất một cửa sổ
+    uint64_t transactions;  // số giao dịch I2C thật sự lên bus (kể cả phần transport chia nhỏ)
+    uint64_t bytes;         // số byte lên bus (không kể byte địa chỉ)
+    uint64_t copied_bytes;  // số byte payload phải sao chép trước khi gửi
+} ssd1306_tx_stats_t;
+
+typedef struct {
+    uint64_t presented; // số khung đã công bố
+    uint64_t flushed;   // số khung đã gửi lên màn hình
+    uint64_t dropped;   // số khung bị khung mới hơn thay thế trước khi kịp gửi
+} ssd1306_frame_stats_t;
+
+// Mô tả một loại panel. Chuỗi khởi tạo (multiplex, cấu hình chân COM), số trang và cột
+// GDDRAM của cửa sổ gửi đều suy ra từ đây. ops (trong ssd1306_c_driver.c) là các vòng lặp
+// nóng (flush, fill, blit, so khung) biên dịch riêng cho kích thước của panel.
+typedef struct ssd1306_panel_ops ssd1306_panel_ops_t;
+
+typedef struct {
+    const char *name;        // "WxH", tên dùng cho SSD1306_PANEL và ssd1306_panel_find()
+    uint8_t width, height;   // số cột/hàng trên kính (height là bội của 8)
+    uint8_t col_offset;      // cột GDDRAM của cột 0 với segment remap 0xA1 (mặc định)
+    uint8_t com_pins;        // tham số của 0xDA: 0x12 nối xen kẽ, 0x02 nối tuần tự
+    const ssd1306_panel_ops_t *ops;
+} ssd1306_panel_t;
+
+extern const ssd1306_panel_t ssd1306_panels[];
+extern const int ssd1306_panel_count;
+
+// Giới hạn số bus và số màn hình trên mỗi bus (SSD1306 chỉ có 0x3C/0x3D, thêm chỗ cho bộ chia kênh)
+#define SSD1306_MAX_BUSES        8
+#define SSD1306_MAX_BUS_DISPLAYS 8
+
+typedef struct ssd1306_bus ssd1306_bus_t;
+
+// Ngữ cảnh của một màn hình. Mọi hàm vẽ/flush nhận con trỏ này thay cho biến toàn cục,
+// nên một tiến trình có thể điều khiển nhiều màn hình cùng lúc.
+typedef struct {
+    ssd1306_bus_t *bus;
+    uint16_t addr;          // địa chỉ slave (0x3C hoặc 0x3D)
+    const ssd1306_panel_t *panel;
+    int width, height, pages; // kích thước panel (chép từ panel)
+    int col_offset;         // cột GDDRAM của cột 0 theo hướng hiện tại
+
+    uint8_t storage[SSD1306_FRAME_SLOTS][SSD1306_TX_HEADROOM + SSD1306_BUFFER_SIZE];
+    // Bộ đệm màn hình (bộ đệm sau khi chạy luồng flush nền); các hàm vẽ luôn ghi vào đây
+    uint8_t *display_buffer;
+    ssd1306_dirty_t dirty_cols; // Vùng đã thay đổi chưa gửi
+    ssd1306_tx_stats_t tx_stats;
+    ssd1306_metrics_t metrics;  // ghi khi giữ khóa bus, đọc bằng ssd1306_get_metrics()
+    pthread_mutex_t render_lock; // present() bất đồng bộ ghi render_ns/last_call_ns dưới khóa này
+
+    // Trạng thái cuộn của panel. display_buffer luôn là hình đang hiển thị (hàng 0 ở trên cùng);
+    // hàng y của nó nằm ở hàng GDDRAM (y + start_line + display_offset) % 64.
+    int start_line;         // giá trị thanh ghi 0x40 | n
+    int display_offset;     // giá trị thanh ghi 0xD3
+    int hw_scroll_active;   // đang cuộn liên tục bằng 0x2F: cấm ghi GDDRAM
+    int hw_scroll_page0, hw_scroll_page1; // các trang GDDRAM đang cuộn liên tục
+    int hw_scroll_vertical; // cuộn chéo: mọi hàng trong vùng cuộn dọc đều dịch
+    int orientation;        // SSD1306_ORIENT_*, gửi lại trong ssd1306_init()
+
+    // Triple buffering với luồng flush của bus (Bước 5)
+    atomic_uint frame_ready; // chỉ số ô ready | SSD1306_SLOT_NEW
+    int frame_back;          // ô của bên vẽ (display_buffer)
+    int frame_front;         // ô của luồng flush
+    atomic_uint_fast64_t frames_presented, frames_flushed, frames_dropped;
+    // Nội dung màn hình sau lần gửi cuối; chỉ luồng flush ghi vào, có headroom để gửi zero-copy
+    uint8_t shadow_storage[SSD1306_TX_HEADROOM + SSD1306_BUFFER_SIZE];
+    int shadow_valid;
+} ssd1306_t;
+
+// Một bus I2C: transport dùng chung cho mọi màn hình trên bus, khóa bus và luồng flush nền.
+// Giao dịch của các màn hình trên cùng bus được tuần tự hóa bằng lock; các bus khác nhau
+// chạy song song.
+struct ssd1306_bus {
+    ssd1306_transport_t t;   // Bus I2C (dev/rdwr/mem), chưa mở khi ops == NULL
+    char path[64];
+    pthread_mutex_t lock;    // giữ trong suốt một lệnh hoặc một lần flush
+    ssd1306_batch_t batch;   // Bộ dựng giao dịch dùng chung, chỉ dùng khi giữ lock
+    ssd1306_t *displays[SSD1306_MAX_BUS_DISPLAYS];
+    int display_count;
+
+    atomic_bool flusher_running;
+    pthread_t flusher_thread;
+    sem_t frame_sem;         // được post mỗi lần một màn hình trên bus present
+    int next_display;        // màn hình được xét đầu tiên ở lượt round-robin kế tiếp
+};
+
+// Hướng panel: chỉ đổi segment remap (0xA0/0xA1) và hướng quét COM (0xC0/0xC8), không
+// tốn gì mỗi khung. Bit 0 lật trái-phải, bit 1 lật trên-dưới. Xoay 90/270: ssd1306_portrait.h
+#define SSD1306_ORIENT_0         0x0 // 0xA1, 0xC8 (mặc định)
+#define SSD1306_ORIENT_MIRROR_X  0x1 // 0xA0, 0xC8
+#define SSD1306_ORIENT_MIRROR_Y  0x2 // 0xA1, 0xC0
+#define SSD1306_ORIENT_180       0x3 // 0xA0, 0xC0
+
+// Chế độ màu cho fill/line/rect
+#define SSD1306_COLOR_BLACK      0
+#define SSD1306_COLOR_WHITE      1
+#define SSD1306_COLOR_INVERT     2
+
+// Cách trộn ảnh khi blit
+#define SSD1306_BLIT_COPY        0 // ghi đè vùng ảnh
+#define SSD1306_BLIT_OR          1 // bật các pixel bật của ảnh
+#define SSD1306_BLIT_AND         2 // tắt các pixel tắt của ảnh
+#define SSD1306_BLIT_XOR         3 // đảo các pixel bật của ảnh
+
+// Nhiều màn hình: mở N màn hình rải trên nhiều bus, mỗi bus một luồng flush
+typedef struct {
+    const char *path;   // file device của bus, ví dụ "/dev/i2c-1"
+    uint16_t addr;      // 0x3C hoặc 0x3D
+    const char *panel;  // tên panel, NULL: panel mặc định
+} ssd1306_display_spec_t;
+
+typedef struct {
+    ssd1306_bus_t *buses[SSD1306_MAX_BUSES];
+    int bus_count;
+    ssd1306_t *displays[SSD1306_MAX_BUSES * SSD1306_MAX_BUS_DISPLAYS]; // theo thứ tự specs
+    int display_count;
+} ssd1306_group_t;
+
+// =========================================================================
+// Hàm công khai (định nghĩa trong ssd1306_c_driver.c)
+// Các hàm trả về int: 0 (hoặc số byte đã gửi) nếu thành công, -1 nếu lỗi.
+// =========================================================================
+
+void delay_ms(long milliseconds);
+uint64_t ssd1306_cpu_time_ns(void);
+
+// Bus và màn hình
+ssd1306_bus_t *ssd1306_bus_open(const char *backend, const char *path, uint32_t bus_hz);
+void ssd1306_bus_close(ssd1306_bus_t *bus);
+ssd1306_t *ssd1306_open(ssd1306_bus_t *bus, uint16_t addr);
+void ssd1306_close(ssd1306_t *dev);
+int ssd1306_init(ssd1306_t *dev);
+// Panel theo tên ("128x64", "128x32", "64x48", "96x16"), NULL nếu không có
+const ssd1306_panel_t *ssd1306_panel_find(const char *name);
+// Panel của SSD1306_PANEL, hoặc SSD1306_DEFAULT_PANEL nếu biến không đặt
+const ssd1306_panel_t *ssd1306_default_panel(void);
+// Đổi loại panel của dev (ssd1306_open() dùng panel mặc định); gọi ssd1306_init() sau đó
+int ssd1306_set_panel(ssd1306_t *dev, const ssd1306_panel_t *panel);
+// Đổi hướng panel (SSD1306_ORIENT_*). Lật trái-phải gửi lại cả khung ở lần flush kế tiếp
+// (segment remap chỉ áp dụng cho dữ liệu ghi sau lệnh). Không dùng khi luồng flush nền chạy.
+int ssd1306_set_orientation(ssd1306_t *dev, int orientation);
+
+// Gửi lệnh/dữ liệu thô
+int ssd1306_send_single_command(ssd1306_t *dev, uint8_t command);
+int ssd1306_send_command_1param(ssd1306_t *dev, uint8_t command, uint8_t param1);
+int ssd1306_send_command_2params(ssd1306_t *dev, uint8_t command, uint8_t param1, uint8_t param2);
+int ssd1306_send_command_sequence(ssd1306_t *dev, const uint8_t *commands, int len);
+// data nằm trong display_buffer thì được gửi zero-copy: không vẽ từ luồng khác trong lúc gọi
+int ssd1306_send_data(ssd1306_t *dev, const uint8_t *data, int len);
+
+// Bộ đệm và flush
+void ssd1306_mark_dirty(ssd1306_t *dev, int x0, int x1, int page0, int page1);
+void ssd1306_mark_all_dirty(ssd1306_t *dev);
+void ssd1306_clear_buffer(ssd1306_t *dev);
+void ssd1306_fill_buffer(ssd1306_t *dev, uint8_t pattern);
+int ssd1306_plan_flush(ssd1306_t *dev, ssd1306_window_t *windows, int max_windows);
+int ssd1306_display_buffer(ssd1306_t *dev);
+int ssd1306_display_buffer_full(ssd1306_t *dev);
+
+// Vẽ
+void ssd1306_draw_pixel(ssd1306_t *dev, int x, int y, int color);
+void ssd1306_fill_rect(ssd1306_t *dev, int x, int y, int w, int h, int color);
+void ssd1306_draw_hline(ssd1306_t *dev, int x, int y, int w, int color);
+void ssd1306_draw_vline(ssd1306_t *dev, int x, int y, int h, int color);
+void ssd1306_draw_rect(ssd1306_t *dev, int x, int y, int w, int h, int color);
+void ssd1306_invert_rect(ssd1306_t *dev, int x, int y, int w, int h);
+void ssd1306_blit(ssd1306_t *dev, const uint8_t *bitmap, int bw, int bh, int x, int y, int mode);
+int ssd1306_load_frame(ssd1306_t *dev, const uint8_t *frame);
+uint32_t ssd1306_next_codepoint(const char **s); // UTF-8, byte lẻ hiểu là Latin-1
+int ssd1306_text_width(const ssd1306_font_t *font, const char *str);
+int ssd1306_draw_char(ssd1306_t *dev, const ssd1306_font_t *font, int x, int y, uint32_t cp, int mode);
+int ssd1306_draw_string(ssd1306_t *dev, const ssd1306_font_t *font, int x, int y, const char *str, int mode);
+
+// Luồng flush nền
+int ssd1306_bus_start_flusher(ssd1306_bus_t *bus);
+int ssd1306_present(ssd1306_t *dev);
+void ssd1306_bus_stop_flusher(ssd1306_bus_t *bus);
+void ssd1306_get_frame_stats(ssd1306_t *dev, ssd1306_frame_stats_t *stats);
+
+// Đo đạc (ssd1306_metrics.h, in và báo cáo định kỳ trong ssd1306_metrics.c)
+void ssd1306_get_metrics(ssd1306_t *dev, ssd1306_metrics_t *out);
+void ssd1306_get_bus_metrics(ssd1306_bus_t *bus, ssd1306_transport_metrics_t *out);
+void ssd1306_reset_metrics(ssd1306_bus_t *bus); // bus và mọi màn hình trên bus
+void ssd1306_metrics_print(ssd1306_bus_t *bus, FILE *out);
+int ssd1306_metrics_start_reporter(ssd1306_bus_t *const *buses, int n, FILE *out, int interval_ms, int signo);
+void ssd1306_metrics_stop_reporter(void);
+
+// Nhiều màn hình
+int ssd1306_group_open(ssd1306_group_t *g, const char *backend, uint32_t bus_hz,
+                       const ssd1306_display_spec_t *specs, int n);
+void ssd1306_group_close(ssd1306_group_t *g);
+int ssd1306_group_start_flushers(ssd1306_group_t *g);
+void ssd1306_group_stop_flushers(ssd1306_group_t *g);
+
+// Cuộn
+int ssd1306_set_start_line(ssd1306_t *dev, int line);
+int ssd1306_set_display_offset(ssd1306_t *dev, int offset);
+int ssd1306_pan(ssd1306_t *dev, int rows);
+int ssd1306_start_scroll(ssd1306_t *dev, int dir, int page0, int page1, uint8_t interval);
+int ssd1306_start_scroll_diagonal(ssd1306_t *dev, int dir, int page0, int page1, uint8_t interval,
+                                  int rows_per_step, int area_top, int area_rows);
+int ssd1306_stop_scroll(ssd1306_t *dev);
+
+#endif // SSD1306_C_DRIVER_H
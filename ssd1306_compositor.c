@@ -0,0 +1,308 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ssd1306_compositor.h"
+
+_Static_assert(SSD1306_WIDTH % 8 == 0, "compositor works on groups of 8 columns"); // mọi panel cũng vậy
+
+// =========================================================================
+// Vùng hư hỏng
+// =========================================================================
+
+// Đánh dấu các cột x0..x1 của các trang page0..page1 (đã cắt theo màn hình)
+static void comp_damage_span(ssd1306_compositor_t *comp, int x0, int x1, int page0, int page1) {
+    if (x0 < 0) x0 = 0;
+    if (x1 >= comp->dev->width) x1 = comp->dev->width - 1;
+    if (page0 < 0) page0 = 0;
+    if (page1 >= comp->dev->pages) page1 = comp->dev->pages - 1;
+    if (x0 > x1 || page0 > page1) return;
+
+    for (int w = x0 >> 6; w <= x1 >> 6; ++w) {
+        int lo = w == x0 >> 6 ? x0 & 63 : 0;
+        int hi = w == x1 >> 6 ? x1 & 63 : 63;
+        uint64_t bits = (~0ULL << lo) & (~0ULL >> (63 - hi));
+        for (int page = page0; page <= page1; ++page) {
+            comp->damage[page][w] |= bits;
+        }
+    }
+}
+
+void ssd1306_comp_damage(ssd1306_compositor_t *comp, int x, int y, int w, int h) {
+    if (w <= 0 || h <= 0) return;
+    // y có thể âm: làm tròn trang xuống bằng dịch số học
+    comp_damage_span(comp, x, x + w - 1, y >> 3, (y + h - 1) >> 3);
+}
+
+static void comp_damage_sprite(ssd1306_compositor_t *comp, const ssd1306_sprite_t *s) {
+    if (s->visible) ssd1306_comp_damage(comp, s->x, s->y, s->w, s->h);
+}
+
+static ssd1306_sprite_t *comp_sprite(ssd1306_compositor_t *comp, int id) {
+    if (id < 0 || id >= SSD1306_MAX_SPRITES || comp->sprites[id].bitmap == NULL) {
+        fprintf(stderr, "Error: Invalid sprite id %d.\n", id);
+        return NULL;
+    }
+    return &comp->sprites[id];
+}
+
+// Sắp lại thứ tự z (chèn, ổn định theo id); số sprite nhỏ nên không cần gì hơn
+static void comp_sort(ssd1306_compositor_t *comp) {
+    int n = 0;
+    for (int id = 0; id < SSD1306_MAX_SPRITES; ++id) {
+        if (comp->sprites[id].bitmap == NULL) continue;
+        int k = n++;
+        while (k > 0 && comp->sprites[comp->order[k - 1]].z > comp->sprites[id].z) {
+            comp->order[k] = comp->order[k - 1];
+            --k;
+        }
+        comp->order[k] = (uint8_t)id;
+    }
+    comp->sprite_count = n;
+}
+
+// =========================================================================
+// Nền và sprite
+// =========================================================================
+
+int ssd1306_comp_init(ssd1306_compositor_t *comp, ssd1306_t *dev) {
+    if (comp == NULL || dev == NULL) {
+        fprintf(stderr, "Error: Invalid compositor arguments.\n");
+        return -1;
+    }
+    memset(comp, 0, sizeof(*comp));
+    comp->dev = dev;
+    memcpy(comp->background, dev->display_buffer, SSD1306_BUFFER_SIZE);
+    return 0;
+}
+
+void ssd1306_comp_set_background(ssd1306_compositor_t *comp, const uint8_t *frame) {
+    for (int page = 0; page < comp->dev->pages; ++page) {
+        uint8_t *dst = comp->background + page * SSD1306_WIDTH;
+        const uint8_t *src = frame + page * SSD1306_WIDTH;
+        for (int x = 0; x < comp->dev->width; ++x) {
+            if (dst[x] != src[x]) {
+                dst[x] = src[x];
+                comp->damage[page][x >> 6] |= 1ULL << (x & 63);
+            }
+        }
+    }
+}
+
+uint8_t *ssd1306_comp_background(ssd1306_compositor_t *comp) {
+    return comp->background;
+}
+
+int ssd1306_comp_add_sprite(ssd1306_compositor_t *comp, const uint8_t *bitmap, const uint8_t *mask,
+                            int w, int h, int x, int y, int z, int mode) {
+    if (bitmap == NULL || w <= 0 || h <= 0) {
+        fprintf(stderr, "Error: Invalid sprite.\n");
+        return -1;
+    }
+    for (int id = 0; id < SSD1306_MAX_SPRITES; ++id) {
+        ssd1306_sprite_t *s = &comp->sprites[id];
+        if (s->bitmap != NULL) continue;
+        *s = (ssd1306_sprite_t){ bitmap, mask, w, h, x, y, z, mode, 1 };
+        comp_sort(comp);
+        comp_damage_sprite(comp, s);
+        return id;
+    }
+    fprintf(stderr, "Error: Too many sprites (max %d).\n", SSD1306_MAX_SPRITES);
+    return -1;
+}
+
+void ssd1306_comp_remove_sprite(ssd1306_compositor_t *comp, int id) {
+    ssd1306_sprite_t *s = comp_sprite(comp, id);
+    if (s == NULL) return;
+    comp_damage_sprite(comp, s);
+    memset(s, 0, sizeof(*s));
+    comp_sort(comp);
+}
+
+void ssd1306_comp_move(ssd1306_compositor_t *comp, int id, int x, int y) {
+    ssd1306_sprite_t *s = comp_sprite(comp, id);
+    if (s == NULL || (s->x == x && s->y == y)) return;
+    comp_damage_sprite(comp, s);
+    s->x = x;
+    s->y = y;
+    comp_damage_sprite(comp, s);
+}
+
+void ssd1306_comp_show(ssd1306_compositor_t *comp, int id, int visible) {
+    ssd1306_sprite_t *s = comp_sprite(comp, id);
+    if (s == NULL || s->visible == !!visible) return;
+    s->visible = !!visible;
+    ssd1306_comp_damage(comp, s->x, s->y, s->w, s->h);
+}
+
+void ssd1306_comp_set_bitmap(ssd1306_compositor_t *comp, int id, const uint8_t *bitmap, const uint8_t *mask) {
+    ssd1306_sprite_t *s = comp_sprite(comp, id);
+    if (s == NULL || bitmap == NULL || (s->bitmap == bitmap && s->mask == mask)) return;
+    s->bitmap = bitmap;
+    s->mask = mask;
+    comp_damage_sprite(comp, s);
+}
+
+void ssd1306_comp_set_z(ssd1306_compositor_t *comp, int id, int z) {
+    ssd1306_sprite_t *s = comp_sprite(comp, id);
+    if (s == NULL || s->z == z) return;
+    s->z = z;
+    comp_sort(comp);
+    comp_damage_sprite(comp, s);
+}
+
+// =========================================================================
+// Ghép
+// =========================================================================
+
+// Hệ số của phép trộn tổng quát v = ((v & (~(m & km) | (b & kb))) | (b & om)) ^ (b & xm),
+// với b là bit ảnh trong mask m: một vòng lặp không rẽ nhánh cho mọi kiểu trộn
+typedef struct {
+    uint64_t km, kb, om, xm;
+} comp_blend_t;
+
+static comp_blend_t comp_blend_coeffs(int mode) {
+    switch (mode) {
+    case SSD1306_BLIT_OR:  return (comp_blend_t){ 0, 0, ~0ULL, 0 };
+    case SSD1306_BLIT_AND: return (comp_blend_t){ ~0ULL, ~0ULL, 0, 0 };
+    case SSD1306_BLIT_XOR: return (comp_blend_t){ 0, 0, 0, ~0ULL };
+    default:               return (comp_blend_t){ ~0ULL, 0, ~0ULL, 0 }; // COPY
+    }
+}
+
+// Đọc/ghi n <= 8 byte thành một từ 64-bit. Các phép trộn chỉ làm việc trong từng byte nên
+// thứ tự byte trong từ không quan trọng, chỉ cần đọc và ghi cùng một cách.
+static inline uint64_t comp_load(const uint8_t *p, int n) {
+    uint64_t v = 0;
+    if (n == 8) {
+        memcpy(&v, p, 8);
+    } else {
+        for (int j = 0; j < n; ++j) v |= (uint64_t)p[j] << (8 * j);
+    }
+    return v;
+}
+
+static inline void comp_store(uint8_t *p, uint64_t v, int n) {
+    if (n == 8) {
+        memcpy(p, &v, 8);
+    } else {
+        for (int j = 0; j < n; ++j) p[j] = (uint8_t)(v >> (8 * j));
+    }
+}
+
+// n cột (n <= 8) của hàng ảnh bắt đầu ở trang màn hình: hai trang ảnh q và q + 1 ghép lại,
+// mỗi byte = (lo >> shift) | (hi << (8 - shift)). Trang không tồn tại bị che bằng lo_keep/hi_keep.
+static inline uint64_t comp_rows8(const uint8_t *lo, const uint8_t *hi, int n,
+                                  uint64_t lo_keep, uint64_t hi_keep, int shift) {
+    uint64_t a = comp_load(lo, n) & lo_keep;
+    uint64_t b = comp_load(hi, n) & hi_keep;
+    return ((a >> shift) & SSD1306_BYTES_X8(0xFF >> shift)) |
+           ((b << (8 - shift)) & SSD1306_BYTES_X8(0xFF << (8 - shift)));
+}
+
+// Ghép các cột x0..x1 của trang page vào row (đã chứa nền), 8 cột mỗi vòng
+static void comp_apply_sprites(const ssd1306_compositor_t *comp, int page, int x0, int x1, uint8_t *row) {
+    for (int k = 0; k < comp->sprite_count; ++k) {
+        const ssd1306_sprite_t *s = &comp->sprites[comp->order[k]];
+        int dy = page * 8 - s->y;   // hàng của sprite ở bit 0 của trang
+        if (!s->visible || dy <= -8 || dy >= s->h) continue;
+        int c0 = s->x > x0 ? s->x : x0;
+        int c1 = s->x + s->w - 1 < x1 ? s->x + s->w - 1 : x1;
+        if (c0 > c1) continue;
+
+        // Bit của các hàng nằm trong sprite
+        int lo_rows = dy < 0 ? -dy : 0;
+        int hi_rows = s->h - dy < 8 ? s->h - dy : 8;
+        uint64_t valid = SSD1306_BYTES_X8(((1u << hi_rows) - 1) & ~((1u << lo_rows) - 1));
+
+        // Trang ảnh q = floor(dy / 8) và q + 1; trang không tồn tại đọc trang 0 rồi bị che.
+        // Không có mask thì đọc chính ảnh rồi OR 0xFF.
+        int pages = (s->h + 7) >> 3;
+        int q = dy >> 3, shift = dy & 7;
+        int lo_page = q >= 0 ? q : 0;
+        int hi_page = q + 1 < pages ? q + 1 : 0;
+        uint64_t lo_keep = q >= 0 ? ~0ULL : 0;
+        uint64_t hi_keep = q + 1 < pages && shift != 0 ? ~0ULL : 0;
+        uint64_t no_mask = s->mask == NULL ? ~0ULL : 0;
+        const uint8_t *mask = s->mask != NULL ? s->mask : s->bitmap;
+
+        int sc = c0 - s->x, n = c1 - c0 + 1;
+        const uint8_t *lo = s->bitmap + lo_page * s->w + sc, *hi = s->bitmap + hi_page * s->w + sc;
+        const uint8_t *mlo = mask + lo_page * s->w + sc, *mhi = mask + hi_page * s->w + sc;
+        comp_blend_t f = comp_blend_coeffs(s->mode);
+
+        for (int i = 0; i < n; i += 8) {
+            int len = n - i < 8 ? n - i : 8;
+            uint64_t m = (comp_rows8(mlo + i, mhi + i, len, lo_keep, hi_keep, shift) | no_mask) & valid;
+            uint64_t b = comp_rows8(lo + i, hi + i, len, lo_keep, hi_keep, shift) & m;
+            uint64_t d = comp_load(row + c0 + i, len);
+            d = ((d & (~(m & f.km) | (b & f.kb))) | (b & f.om)) ^ (b & f.xm);
+            comp_store(row + c0 + i, d, len);
+        }
+    }
+}
+
+// Ghép một đoạn cột hư hỏng x0..x1 (cùng một từ của bitmap), ghi vào display_buffer và
+// đánh dấu bẩn đúng các byte đổi. Đoạn được nới ra bội của 8 cột để mọi bước đi theo từ
+// 64-bit: ghép lại một byte không hư hỏng cho ra đúng giá trị đang có nên không đổi gì.
+// Bitmap byte đổi được OR thẳng vào dirty_cols (cùng bố cục với damage).
+static int comp_compose_run(ssd1306_compositor_t *comp, int page, int x0, int x1) {
+    uint8_t row[SSD1306_WIDTH];
+    const uint8_t *bg = comp->background + page * SSD1306_WIDTH;
+    uint8_t *dst = comp->dev->display_buffer + page * SSD1306_WIDTH;
+
+    x0 &= ~7;
+    x1 |= 7;
+    for (int x = x0; x <= x1; x += 8) {
+        memcpy(row + x, bg + x, 8);
+    }
+    comp_apply_sprites(comp, page, x0, x1, row);
+
+    uint64_t changed = 0;
+    for (int x = x0; x <= x1; x += 8) {
+        uint64_t a, b;
+        memcpy(&a, dst + x, 8);
+        memcpy(&b, row + x, 8);
+        uint64_t d = a ^ b;
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        d = __builtin_bswap64(d); // byte thứ i trong bộ nhớ về bit 8i
+#endif
+        // Gộp mỗi byte khác nhau thành bit 0 của byte đó, rồi gom 8 bit về một byte
+        d |= d >> 4;
+        d |= d >> 2;
+        d |= d >> 1;
+        d &= 0x0101010101010101ULL;
+        changed |= ((d * 0x0102040810204080ULL) >> 56) << (x & 63);
+        memcpy(dst + x, &b, 8);
+    }
+    comp->dev->dirty_cols[page][x0 >> 6] |= changed;
+    return __builtin_popcountll(changed);
+}
+
+int ssd1306_comp_compose(ssd1306_compositor_t *comp) {
+    int changed = 0;
+    for (int page = 0; page < comp->dev->pages; ++page) {
+        for (int w = 0; w < SSD1306_DIRTY_WORDS; ++w) {
+            uint64_t bits = comp->damage[page][w];
+            comp->damage[page][w] = 0;
+            // Từng đoạn bit 1 liền nhau
+            while (bits) {
+                int s = __builtin_ctzll(bits);
+                uint64_t rest = ~(bits >> s);
+                int n = rest ? __builtin_ctzll(rest) : 64;
+                changed += comp_compose_run(comp, page, w * 64 + s, w * 64 + s + n - 1);
+                bits = s + n >= 64 ? 0 : bits & (~0ULL << (s + n));
+            }
+        }
+    }
+    return changed;
+}
+
+int ssd1306_comp_update(ssd1306_compositor_t *comp) {
+    ssd1306_comp_compose(comp);
+    if (atomic_load(&comp->dev->bus->flusher_running)) {
+        return ssd1306_present(comp->dev);
+    }
+    return ssd1306_display_buffer(comp->dev);
+}
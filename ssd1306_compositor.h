@@ -0,0 +1,65 @@
+#ifndef SSD1306_COMPOSITOR_H
+#define SSD1306_COMPOSITOR_H
+
+#include <stdint.h>
+
+#include "ssd1306_c_driver.h"
+
+// =========================================================================
+// Bộ ghép lớp: nền tĩnh + các sprite 1-bit xếp theo z (con trỏ nhấp nháy, biểu tượng
+// quay, huy hiệu cảnh báo...) trên display_buffer.
+// Mỗi thay đổi (di chuyển, ẩn/hiện, đổi hình, đổi z, sửa nền) chỉ đánh dấu "hư hỏng"
+// các byte (cột x trang) của hình chữ nhật cũ và mới. ssd1306_comp_compose() chỉ ghép lại
+// các byte hư hỏng: nền rồi lần lượt các sprite phủ lên byte đó theo z tăng dần, và chỉ
+// đánh dấu bẩn các byte thật sự đổi -> chi phí tỷ lệ với phần thay đổi, không với cả màn hình.
+// Bộ ghép sở hữu display_buffer: muốn vẽ thêm thì vẽ vào nền (ssd1306_comp_background()
+// + ssd1306_comp_damage(), hoặc ssd1306_comp_set_background()).
+// =========================================================================
+
+#define SSD1306_MAX_SPRITES      16
+
+typedef struct {
+    const uint8_t *bitmap;  // bố cục trang như ssd1306_blit(): bitmap[page * w + col]
+    const uint8_t *mask;    // cùng bố cục, bit 1 là pixel thuộc sprite; NULL: cả hình chữ nhật
+    int w, h;
+    int x, y;               // góc trên trái, có thể nằm ngoài màn hình
+    int z;                  // lớn hơn thì nằm trên; bằng nhau thì sprite thêm sau nằm trên
+    int mode;               // SSD1306_BLIT_COPY/OR/AND/XOR, chỉ trong mask
+    int visible;
+} ssd1306_sprite_t;
+
+typedef struct {
+    ssd1306_t *dev;
+    uint8_t background[SSD1306_BUFFER_SIZE];
+    ssd1306_sprite_t sprites[SSD1306_MAX_SPRITES];
+    int sprite_count;
+    uint8_t order[SSD1306_MAX_SPRITES]; // chỉ số sprite theo z tăng dần
+    ssd1306_dirty_t damage;             // byte cần ghép lại, cùng bố cục với dirty_cols
+} ssd1306_compositor_t;
+
+// Gắn bộ ghép vào màn hình; nội dung hiện tại của display_buffer trở thành nền. Trả về 0/-1.
+int ssd1306_comp_init(ssd1306_compositor_t *comp, ssd1306_t *dev);
+
+// Nền: thay cả khung (chỉ các byte khác bị hư hỏng), hoặc sửa trực tiếp rồi báo vùng đã sửa
+void ssd1306_comp_set_background(ssd1306_compositor_t *comp, const uint8_t *frame);
+uint8_t *ssd1306_comp_background(ssd1306_compositor_t *comp);
+void ssd1306_comp_damage(ssd1306_compositor_t *comp, int x, int y, int w, int h);
+
+// Sprite: trả về id (>= 0) hoặc -1. Sprite mới hiện ngay tại (x, y); bitmap/mask
+// phải còn sống tới khi gỡ sprite.
+int ssd1306_comp_add_sprite(ssd1306_compositor_t *comp, const uint8_t *bitmap, const uint8_t *mask,
+                            int w, int h, int x, int y, int z, int mode);
+void ssd1306_comp_remove_sprite(ssd1306_compositor_t *comp, int id);
+void ssd1306_comp_move(ssd1306_compositor_t *comp, int id, int x, int y);
+void ssd1306_comp_show(ssd1306_compositor_t *comp, int id, int visible);
+// Đổi hình (ví dụ khung kế tiếp của biểu tượng quay), cùng kích thước
+void ssd1306_comp_set_bitmap(ssd1306_compositor_t *comp, int id, const uint8_t *bitmap, const uint8_t *mask);
+void ssd1306_comp_set_z(ssd1306_compositor_t *comp, int id, int z);
+
+// Ghép lại các byte hư hỏng vào display_buffer. Trả về số byte đã đổi.
+int ssd1306_comp_compose(ssd1306_compositor_t *comp);
+// Ghép rồi gửi. Trả về số byte đã gửi như ssd1306_display_buffer() (0 khi đã present()
+// cho luồng flush nền), -1 nếu lỗi.
+int ssd1306_comp_update(ssd1306_compositor_t *comp);
+
+#endif // SSD1306_COMPOSITOR_H
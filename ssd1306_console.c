@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdarg.h>         // For ssd1306_console_printf()
+
+#include "ssd1306_console.h"
+
+// =========================================================================
+// Lưới ô
+// =========================================================================
+
+int ssd1306_console_init(ssd1306_console_t *con, ssd1306_t *dev) {
+    if (con == NULL || dev == NULL) {
+        fprintf(stderr, "Error: Invalid console arguments.\n");
+        return -1;
+    }
+    memset(con, 0, sizeof(*con));
+    con->dev = dev;
+    con->rows = dev->pages;
+    con->cols = dev->width / SSD1306_CONSOLE_CELL_W;
+    ssd1306_console_clear(con);
+    // Ô trống (' ', không thuộc tính) là 6 byte 0, khớp với bộ đệm vừa xóa
+    memcpy(con->shown_chars, con->chars, sizeof(con->chars));
+    memset(con->shown_attrs, 0, sizeof(con->shown_attrs));
+    ssd1306_clear_buffer(dev);
+    return 0;
+}
+
+void ssd1306_console_clear(ssd1306_console_t *con) {
+    memset(con->chars, ' ', sizeof(con->chars));
+    memset(con->attrs, 0, sizeof(con->attrs));
+    con->row = 0;
+    con->col = 0;
+}
+
+void ssd1306_console_clear_line(ssd1306_console_t *con, int row) {
+    if (row < 0 || row >= con->rows) return;
+    memset(con->chars[row], ' ', SSD1306_CONSOLE_COLS);
+    memset(con->attrs[row], 0, SSD1306_CONSOLE_COLS);
+}
+
+void ssd1306_console_goto(ssd1306_console_t *con, int row, int col) {
+    con->row = row < 0 ? 0 : row >= con->rows ? con->rows - 1 : row;
+    con->col = col < 0 ? 0 : col >= con->cols ? con->cols - 1 : col;
+}
+
+void ssd1306_console_set_attr(ssd1306_console_t *con, uint8_t attr) {
+    con->attr = attr;
+}
+
+// Cuộn lưới lên một dòng; panel được dịch theo ở lần update kế tiếp
+static void console_scroll(ssd1306_console_t *con) {
+    memmove(con->chars[0], con->chars[1], (con->rows - 1) * SSD1306_CONSOLE_COLS);
+    memmove(con->attrs[0], con->attrs[1], (con->rows - 1) * SSD1306_CONSOLE_COLS);
+    ssd1306_console_clear_line(con, con->rows - 1);
+    if (con->pending_scroll < con->rows) con->pending_scroll++;
+}
+
+static void console_newline(ssd1306_console_t *con) {
+    con->col = 0;
+    if (con->row == con->rows - 1) {
+        console_scroll(con);
+    } else {
+        con->row++;
+    }
+}
+
+static uint8_t console_cell_char(uint32_t cp) {
+    return cp > 0xFF ? ssd1306_font_5x7.fallback : (uint8_t)cp;
+}
+
+void ssd1306_console_putc(ssd1306_console_t *con, uint32_t cp) {
+    switch (cp) {
+    case '\n': console_newline(con); return;
+    case '\r': con->col = 0; return;
+    case '\b': if (con->col > 0) con->col--; return;
+    case '\f': ssd1306_console_clear(con); return;
+    case '\t':
+        do {
+            ssd1306_console_putc(con, ' ');
+        } while (con->col % SSD1306_CONSOLE_TAB != 0 && con->col < con->cols);
+        return;
+    default: break;
+    }
+    if (con->col >= con->cols) {
+        console_newline(con); // xuống dòng trễ: ký tự ở cột cuối chưa làm cuộn
+    }
+    con->chars[con->row][con->col] = console_cell_char(cp);
+    con->attrs[con->row][con->col] = con->attr;
+    con->col++;
+}
+
+void ssd1306_console_write(ssd1306_console_t *con, const char *str) {
+    while (*str) {
+        ssd1306_console_putc(con, ssd1306_next_codepoint(&str));
+    }
+}
+
+int ssd1306_console_printf(ssd1306_console_t *con, const char *fmt, ...) {
+    char text[256];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(text, sizeof(text), fmt, ap);
+    va_end(ap);
+    if (n < 0) return -1;
+    ssd1306_console_write(con, text);
+    return n;
+}
+
+int ssd1306_console_print_at(ssd1306_console_t *con, int row, int col, uint8_t attr, const char *str) {
+    if (row < 0 || row >= con->rows || col < 0) return 0;
+    int n = 0;
+    while (*str && col < con->cols) {
+        con->chars[row][col] = console_cell_char(ssd1306_next_codepoint(&str));
+        con->attrs[row][col++] = attr;
+        ++n;
+    }
+    return n;
+}
+
+// =========================================================================
+// Vẽ và gửi
+// =========================================================================
+
+// Vẽ ô (row, col) vào display_buffer; chỉ các cột có byte đổi bị đánh dấu bẩn
+static void console_render_cell(ssd1306_console_t *con, int row, int col) {
+    uint8_t cell[SSD1306_CONSOLE_CELL_W];
+    uint8_t attr = con->attrs[row][col];
+    const uint8_t *glyph = ssd1306_font_glyph(&ssd1306_font_5x7, con->chars[row][col]);
+
+    memcpy(cell, glyph, ssd1306_font_5x7.width);
+    memset(cell + ssd1306_font_5x7.width, 0, SSD1306_CONSOLE_CELL_W - ssd1306_font_5x7.width);
+    for (int k = 0; k < SSD1306_CONSOLE_CELL_W; ++k) {
+        if (attr & SSD1306_ATTR_UNDERLINE) cell[k] |= 0x80;
+        if (attr & SSD1306_ATTR_INVERSE) cell[k] ^= 0xFF;
+    }
+
+    int x = col * SSD1306_CONSOLE_CELL_W;
+    uint8_t *dst = con->dev->display_buffer + row * SSD1306_WIDTH + x;
+    int first = -1, last = -1;
+    for (int k = 0; k < SSD1306_CONSOLE_CELL_W; ++k) {
+        if (dst[k] != cell[k]) {
+            dst[k] = cell[k];
+            if (first < 0) first = k;
+            last = k;
+        }
+    }
+    if (first >= 0) {
+        ssd1306_mark_dirty(con->dev, x + first, x + last, row, row);
+    }
+    con->shown_chars[row][col] = con->chars[row][col];
+    con->shown_attrs[row][col] = attr;
+}
+
+// Dịch panel theo số dòng lưới đã cuộn. ssd1306_pan() quay cả display_buffer: dòng r mới
+// là dòng (r + rows) cũ, nên các ô đã vẽ được quay theo và chỉ dòng mới lộ ra phải vẽ.
+static int console_apply_scroll(ssd1306_console_t *con) {
+    int rows = con->pending_scroll;
+    con->pending_scroll = 0;
+    if (rows >= con->rows || atomic_load(&con->dev->bus->flusher_running)) {
+        return 0; // cuộn hết màn hình hoặc không được đổi start line: vẽ lại các ô đổi
+    }
+    if (ssd1306_pan(con->dev, rows * 8) != 0) {
+        return -1;
+    }
+
+    uint8_t chars[SSD1306_CONSOLE_ROWS][SSD1306_CONSOLE_COLS];
+    uint8_t attrs[SSD1306_CONSOLE_ROWS][SSD1306_CONSOLE_COLS];
+    memcpy(chars, con->shown_chars, sizeof(chars));
+    memcpy(attrs, con->shown_attrs, sizeof(attrs));
+    for (int r = 0; r < con->rows; ++r) {
+        memcpy(con->shown_chars[r], chars[(r + rows) % con->rows], SSD1306_CONSOLE_COLS);
+        memcpy(con->shown_attrs[r], attrs[(r + rows) % con->rows], SSD1306_CONSOLE_COLS);
+    }
+    return 0;
+}
+
+int ssd1306_console_update(ssd1306_console_t *con) {
+    if (con->pending_scroll > 0 && console_apply_scroll(con) != 0) {
+        return -1;
+    }
+    for (int r = 0; r < con->rows; ++r) {
+        // So nhanh cả dòng trước (phần lớn các dòng không đổi giữa hai lần update)
+        if (memcmp(con->chars[r], con->shown_chars[r], SSD1306_CONSOLE_COLS) == 0 &&
+            memcmp(con->attrs[r], con->shown_attrs[r], SSD1306_CONSOLE_COLS) == 0) {
+            continue;
+        }
+        for (int c = 0; c < con->cols; ++c) {
+            if (con->chars[r][c] != con->shown_chars[r][c] || con->attrs[r][c] != con->shown_attrs[r][c]) {
+                console_render_cell(con, r, c);
+            }
+        }
+    }
+    if (atomic_load(&con->dev->bus->flusher_running)) {
+        return ssd1306_present(con->dev);
+    }
+    return ssd1306_display_buffer(con->dev);
+}
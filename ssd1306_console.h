@@ -0,0 +1,64 @@
+#ifndef SSD1306_CONSOLE_H
+#define SSD1306_CONSOLE_H
+
+#include <stdint.h>
+
+#include "ssd1306_c_driver.h"
+
+// =========================================================================
+// Console chữ trên SSD1306: lưới ô ký tự 5x7 (ô 6x8, mỗi dòng một trang)
+// Bên viết chỉ sửa lưới ô (ký tự + thuộc tính). ssd1306_console_update() so lưới với
+// các ô đã vẽ, chỉ vẽ lại ô khác vào display_buffer, và chỉ đánh dấu bẩn các cột thật sự
+// đổi của ô đó -> bộ lập kế hoạch flush gửi những cửa sổ cột x trang sát nhất.
+// Xuống dòng ở dòng cuối cuộn lưới; lần update kế tiếp dịch panel bằng thanh ghi start
+// line (ssd1306_pan(), chỉ 1 byte lệnh) thay vì gửi lại cả màn hình, rồi chỉ vẽ dòng mới.
+// Khi bus đang chạy luồng flush nền thì không cuộn bằng start line mà vẽ lại các ô đổi.
+// Kích thước lưới theo panel của màn hình (rows x cols); ROWS/COLS là sức chứa tối đa.
+// =========================================================================
+
+#define SSD1306_CONSOLE_CELL_W   6                                   // glyph 5 cột + 1 cột cách
+#define SSD1306_CONSOLE_COLS     (SSD1306_WIDTH / SSD1306_CONSOLE_CELL_W) // 21
+#define SSD1306_CONSOLE_ROWS     SSD1306_PAGES                       // 8
+#define SSD1306_CONSOLE_TAB      4                                   // khoảng cách điểm dừng tab
+
+// Thuộc tính ô
+#define SSD1306_ATTR_NORMAL      0x00
+#define SSD1306_ATTR_INVERSE     0x01 // đảo cả ô (kể cả cột cách)
+#define SSD1306_ATTR_UNDERLINE   0x02 // hàng dưới cùng của ô
+
+typedef struct {
+    ssd1306_t *dev;
+    uint8_t chars[SSD1306_CONSOLE_ROWS][SSD1306_CONSOLE_COLS];  // Latin-1
+    uint8_t attrs[SSD1306_CONSOLE_ROWS][SSD1306_CONSOLE_COLS];
+    // Nội dung các ô đang có trong display_buffer
+    uint8_t shown_chars[SSD1306_CONSOLE_ROWS][SSD1306_CONSOLE_COLS];
+    uint8_t shown_attrs[SSD1306_CONSOLE_ROWS][SSD1306_CONSOLE_COLS];
+    int rows, cols;         // kích thước lưới: 8x21 với 128x64, 4x21 với 128x32, 2x16 với 96x16
+    int row, col;           // con trỏ; col == cols: ký tự kế tiếp sẽ xuống dòng
+    uint8_t attr;           // thuộc tính cho các ký tự viết tiếp
+    int pending_scroll;     // số dòng lưới đã cuộn nhưng panel chưa dịch theo
+} ssd1306_console_t;
+
+// Gắn console vào màn hình và xóa màn hình (gửi ở lần update đầu). Trả về 0/-1.
+int ssd1306_console_init(ssd1306_console_t *con, ssd1306_t *dev);
+// Xóa lưới, con trỏ về (0, 0)
+void ssd1306_console_clear(ssd1306_console_t *con);
+void ssd1306_console_clear_line(ssd1306_console_t *con, int row);
+void ssd1306_console_goto(ssd1306_console_t *con, int row, int col);
+void ssd1306_console_set_attr(ssd1306_console_t *con, uint8_t attr);
+
+// Viết tại con trỏ (UTF-8 hoặc Latin-1 như ssd1306_draw_string()). Hiểu '\n' (xuống dòng,
+// cuộn ở dòng cuối), '\r', '\b', '\t' và '\f' (xóa); tự xuống dòng khi hết cột.
+void ssd1306_console_putc(ssd1306_console_t *con, uint32_t cp);
+void ssd1306_console_write(ssd1306_console_t *con, const char *str);
+int ssd1306_console_printf(ssd1306_console_t *con, const char *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+// Ghi đè một trường cố định (dòng trạng thái): không di chuyển con trỏ, không cuộn,
+// cắt ở cuối dòng. Trả về số ô đã ghi.
+int ssd1306_console_print_at(ssd1306_console_t *con, int row, int col, uint8_t attr, const char *str);
+
+// Vẽ các ô đã đổi và gửi. Trả về số byte đã gửi như ssd1306_display_buffer()
+// (0 khi đã present() cho luồng flush nền), -1 nếu lỗi.
+int ssd1306_console_update(ssd1306_console_t *con);
+
+#endif // SSD1306_CONSOLE_H
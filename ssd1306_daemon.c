@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>           // For clock_nanosleep()
+#include <signal.h>         // For SIGINT, SIGTERM, SIGUSR1
+#include <unistd.h>         // For getopt()
+
+#include "ssd1306_c_driver.h"
+#include "ssd1306_shm.h"
+#include "ssd1306_emu.h"
+
+// =========================================================================
+// Daemon giữ bus, cho nhiều tiến trình cùng vẽ lên một màn hình qua khung dùng chung
+// Cách dùng (daemon):
+//   ./ssd1306_daemon [-t backend] [-b bus_hz] [-a addr] [-n shm] [-f hz] [-M ms] [-e out.pbm]
+//                    [-r tên:x,y,WxH ...]
+//   -r         : khai báo vùng (y, H là bội của 8), lặp lại cho nhiều vùng; mặc định một vùng
+//                "screen" phủ cả màn hình
+//   -f         : số nhịp làm tươi tối đa mỗi giây; mọi vùng đổi trong một nhịp gộp thành một flush
+//   -e         : (mem) gắn bộ mô phỏng, ghi ảnh trên panel ra file khi dừng
+// Cách dùng (client, không bao giờ chạm vào bus):
+//   ./ssd1306_daemon [-n shm] -w vùng dòng1 [dòng2 ...]
+//   viết mỗi dòng chữ 5x7 vào một hàng trang của vùng
+// =========================================================================
+
+#define DAEMON_DEFAULT_HZ        30
+#define DAEMON_IDLE_WAIT_MS      500 // thời gian ngủ tối đa khi không có client nào ghi
+
+static volatile sig_atomic_t daemon_stop;
+
+static void daemon_on_signal(int signo) {
+    (void)signo;
+    daemon_stop = 1;
+}
+
+static uint64_t daemon_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void daemon_sleep_until(uint64_t ns) {
+    struct timespec ts = { (time_t)(ns / 1000000000ULL), (long)(ns % 1000000000ULL) };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR && !daemon_stop) {
+    }
+}
+
+// Client: mỗi dòng chữ vào một hàng trang của vùng, phần còn lại của vùng được xóa
+static int daemon_client_write(const char *shm_name, const char *region, char **lines, int count) {
+    ssd1306_shm_t *shm = ssd1306_shm_attach(shm_name);
+    if (shm == NULL) return -1;
+    int id = ssd1306_shm_claim(shm, region);
+    if (id < 0) {
+        ssd1306_shm_detach(shm);
+        return -1;
+    }
+
+    const ssd1306_shm_region_t *r = &shm->regions[id];
+    const ssd1306_font_t *font = &ssd1306_font_5x7;
+    uint8_t *dst = ssd1306_shm_begin(shm, id);
+    for (int p = 0; p < r->pages; ++p) {
+        uint8_t *row = dst + p * SSD1306_WIDTH;
+        memset(row, 0, r->w);
+        const char *s = p < count ? lines[p] : "";
+        for (int x = 0; *s && x < r->w; x += ssd1306_font_advance(font)) {
+            const uint8_t *glyph = ssd1306_font_glyph(font, ssd1306_next_codepoint(&s));
+            for (int k = 0; k < font->width && x + k < r->w; ++k) row[x + k] = glyph[k];
+        }
+    }
+    ssd1306_shm_end(shm, id);
+    ssd1306_shm_release(shm, id);
+    ssd1306_shm_detach(shm);
+    return 0;
+}
+
+static int daemon_add_region(ssd1306_shm_t *shm, const char *spec) {
+    char name[SSD1306_SHM_NAME_MAX];
+    int x, y, w, h;
+    if (sscanf(spec, "%15[^:]:%d,%d,%dx%d", name, &x, &y, &w, &h) != 5) {
+        fprintf(stderr, "Error: -r expects name:x,y,WxH, e.g. status:0,0,128x16\n");
+        return -1;
+    }
+    return ssd1306_shm_add_region(shm, name, x, y, w, h) < 0 ? -1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    const char *backend = "auto", *shm_name = SSD1306_SHM_NAME, *emu_path = NULL, *client_region = NULL;
+    const char *regions[SSD1306_SHM_MAX_REGIONS];
+    int region_count = 0, hz = DAEMON_DEFAULT_HZ, metrics_ms = 0, opt;
+    uint32_t bus_hz = SSD1306_BUS_400KHZ;
+    uint16_t addr = SSD1306_I2C_ADDR;
+
+    while ((opt = getopt(argc, argv, "t:b:a:n:f:M:e:r:w:")) != -1) {
+        switch (opt) {
+        case 't': backend = optarg; break;
+        case 'b': bus_hz = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'a': addr = (uint16_t)strtoul(optarg, NULL, 16); break;
+        case 'n': shm_name = optarg; break;
+        case 'f': hz = atoi(optarg); break;
+        case 'M': metrics_ms = atoi(optarg); break;
+        case 'e': emu_path = optarg; break;
+        case 'r':
+            if (region_count == SSD1306_SHM_MAX_REGIONS) {
+                fprintf(stderr, "Error: At most %d regions.\n", SSD1306_SHM_MAX_REGIONS);
+                return 2;
+            }
+            regions[region_count++] = optarg;
+            break;
+        case 'w': client_region = optarg; break;
+        default:
+            fprintf(stderr, "Usage: %s [-t auto|dev|rdwr|smbus|mem] [-b bus_hz] [-a addr] [-n shm] [-f hz] "
+                            "[-M ms] [-e out.pbm] [-r name:x,y,WxH ...]\n"
+                            "       %s [-n shm] -w region line...\n", argv[0], argv[0]);
+            return 2;
+        }
+    }
+    if (client_region != NULL) {
+        return daemon_client_write(shm_name, client_region, argv + optind, argc - optind) == 0 ? 0 : 1;
+    }
+    if (hz <= 0 || (emu_path != NULL && strcmp(backend, "mem") != 0)) {
+        fprintf(stderr, "Error: invalid refresh rate, or -e without the mem transport.\n");
+        return 2;
+    }
+
+    const ssd1306_panel_t *panel = ssd1306_default_panel();
+    ssd1306_shm_t *shm = ssd1306_shm_create(shm_name, panel->width, panel->height);
+    if (shm == NULL) {
+        return 1;
+    }
+    int rc = 0;
+    for (int i = 0; i < region_count && rc == 0; ++i) {
+        rc = daemon_add_region(shm, regions[i]);
+    }
+    if (region_count == 0) {
+        rc = ssd1306_shm_add_region(shm, "screen", 0, 0, panel->width, panel->height) < 0 ? -1 : 0;
+    }
+    ssd1306_bus_t *bus = rc == 0 ? ssd1306_bus_open(backend, I2C_BUS_PATH, bus_hz) : NULL;
+    if (bus == NULL) {
+        ssd1306_shm_destroy(shm, shm_name);
+        return 1;
+    }
+    bus->t.mem.realtime = 1; // bus mô phỏng chiếm đúng thời gian như bus thật
+    static ssd1306_emu_t emu;
+    if (emu_path != NULL) {
+        ssd1306_emu_init(&emu, addr, panel->width, panel->height, panel->col_offset);
+        ssd1306_emu_attach(&emu, &bus->t);
+    }
+    ssd1306_t *dev = ssd1306_open(bus, addr);
+    if (dev == NULL || ssd1306_init(dev) != 0 || ssd1306_display_buffer_full(dev) < 0) {
+        fprintf(stderr, "Failed to initialize SSD1306.\n");
+        ssd1306_bus_close(bus);
+        ssd1306_shm_destroy(shm, shm_name);
+        return 1;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = daemon_on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    if (ssd1306_metrics_start_reporter(&bus, 1, stderr, metrics_ms, SIGUSR1) != 0) {
+        fprintf(stderr, "Failed to start metrics reporter.\n");
+        ssd1306_bus_close(bus);
+        ssd1306_shm_destroy(shm, shm_name);
+        return 1;
+    }
+    ssd1306_shm_publish(shm);
+    printf("Serving %s: %d region(s), up to %d refreshes/s.\n", shm_name, shm->region_count, hz);
+    fflush(stdout);
+
+    // Có client ghi thì lấy ngay, rồi ít nhất một chu kỳ mới lấy tiếp: các vùng đổi trong
+    // lúc chờ dồn vào cùng một flush. Không ai ghi thì ngủ trên futex, không thức dậy định kỳ.
+    uint64_t period = 1000000000ULL / (uint64_t)hz, next = daemon_now();
+    uint64_t flushes = 0;
+    while (!daemon_stop) {
+        unsigned seen = atomic_load(&shm->wake);
+        if (ssd1306_shm_collect(shm, dev) > 0) {
+            int sent = ssd1306_display_buffer(dev);
+            if (sent < 0) {
+                fprintf(stderr, "Failed to flush shared framebuffer.\n");
+                rc = -1;
+                break;
+            }
+            if (sent > 0) flushes++;
+            next += period;
+            uint64_t now = daemon_now();
+            if (next < now) next = now;
+            daemon_sleep_until(next);
+        }
+        if (atomic_load(&shm->wake) == seen) {
+            ssd1306_shm_wait(shm, seen, DAEMON_IDLE_WAIT_MS);
+        }
+    }
+
+    ssd1306_metrics_stop_reporter();
+    printf("Stopped: %llu ticks, %llu region updates, %llu flushes.\n",
+           (unsigned long long)atomic_load(&shm->ticks), (unsigned long long)atomic_load(&shm->updates),
+           (unsigned long long)flushes);
+    ssd1306_metrics_print(bus, stderr);
+    ssd1306_shm_destroy(shm, shm_name);
+    if (emu_path != NULL && ssd1306_emu_write_pbm(&emu, emu_path) != 0) {
+        rc = -1;
+    }
+    ssd1306_bus_close(bus);
+    return rc == 0 ? 0 : 1;
+}
@@ -0,0 +1,370 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "ssd1306_emu.h"
+
+// Số khung giữa hai bước cuộn theo mã khoảng thời gian 0..7 (datasheet, lệnh 0x26)
+static const uint16_t emu_scroll_frames[8] = { 5, 64, 128, 256, 3, 4, 25, 2 };
+
+void ssd1306_emu_init(ssd1306_emu_t *e, uint16_t addr, int width, int height, int seg_offset) {
+    memset(e, 0, sizeof(*e));
+    e->addr = addr;
+    e->width = width > 0 && width <= SSD1306_EMU_COLS ? width : SSD1306_EMU_COLS;
+    e->height = height > 0 && height <= 64 && height % 8 == 0 ? height : 64;
+    e->seg_offset = seg_offset >= 0 && seg_offset + e->width <= SSD1306_EMU_COLS ? seg_offset : 0;
+
+    // GDDRAM sau khi cấp nguồn không xác định: dùng rác giả ngẫu nhiên cố định
+    uint32_t seed = 0x1306u;
+    for (int p = 0; p < SSD1306_EMU_PAGES; ++p) {
+        for (int c = 0; c < SSD1306_EMU_COLS; ++c) {
+            seed = seed * 1664525u + 1013904223u;
+            e->gddram[p][c] = (uint8_t)(seed >> 24);
+        }
+    }
+
+    // Giá trị reset của các thanh ghi
+    e->addr_mode = 2;
+    e->col_end = SSD1306_EMU_COLS - 1;
+    e->page_end = SSD1306_EMU_PAGES - 1;
+    e->mux_ratio = 63;
+    e->com_pins = 0x12;
+    e->contrast = 0x7F;
+    e->clock_div = 0x80;
+    e->precharge = 0x22;
+    e->vcomh = 0x20;
+    e->vscroll_rows = 64;
+}
+
+// =========================================================================
+// Ghi GDDRAM và con trỏ địa chỉ
+// =========================================================================
+
+static void emu_write_data(ssd1306_emu_t *e, uint8_t value) {
+    if (e->scroll_active) {
+        e->scroll_ram_writes++;
+    }
+    // Segment remap áp dụng lúc ghi: GDDRAM lưu theo cột trên kính (SEG), đổi 0xA0/0xA1
+    // không làm đổi dữ liệu đã ghi
+    int col = e->col & 127;
+    e->gddram[e->page & 7][e->seg_remap ? col : SSD1306_EMU_COLS - 1 - col] = value;
+    e->data_bytes++;
+
+    switch (e->addr_mode) {
+    case 0: // ngang: hết cột thì sang trang kế, hết cửa sổ thì quay về đầu
+        if (++e->col > e->col_end || e->col >= SSD1306_EMU_COLS) {
+            e->col = e->col_start;
+            if (++e->page > e->page_end || e->page >= SSD1306_EMU_PAGES) e->page = e->page_start;
+        }
+        break;
+    case 1: // dọc: hết trang thì sang cột kế
+        if (++e->page > e->page_end || e->page >= SSD1306_EMU_PAGES) {
+            e->page = e->page_start;
+            if (++e->col > e->col_end || e->col >= SSD1306_EMU_COLS) e->col = e->col_start;
+        }
+        break;
+    default: // trang: chỉ cột tăng, quay về cột bắt đầu, trang giữ nguyên
+        if (++e->col >= SSD1306_EMU_COLS) e->col = e->page_mode_col;
+        break;
+    }
+}
+
+// =========================================================================
+// Giải mã lệnh
+// =========================================================================
+
+// Số byte tham số theo sau opcode
+static int emu_cmd_params(uint8_t op) {
+    switch (op) {
+    case 0x81: case 0x8D: case 0x20: case 0xA8: case 0xD3:
+    case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+        return 1;
+    case 0x21: case 0x22: case 0xA3:
+        return 2;
+    case 0x29: case 0x2A:
+        return 5;
+    case 0x26: case 0x27:
+        return 6;
+    default:
+        return 0;
+    }
+}
+
+static void emu_exec(ssd1306_emu_t *e) {
+    const uint8_t *c = e->cmd;
+    uint8_t op = c[0];
+
+    if (op <= 0x0F) {                       // cột thấp (chế độ trang)
+        e->page_mode_col = (e->page_mode_col & 0xF0) | op;
+        if (e->addr_mode == 2) e->col = e->page_mode_col;
+        return;
+    }
+    if (op <= 0x1F) {                       // cột cao (chế độ trang)
+        e->page_mode_col = (uint8_t)(((op & 0x07) << 4) | (e->page_mode_col & 0x0F));
+        if (e->addr_mode == 2) e->col = e->page_mode_col;
+        return;
+    }
+    if (op >= 0x40 && op <= 0x7F) {         // start line
+        e->start_line = op & 0x3F;
+        return;
+    }
+    if (op >= 0xB0 && op <= 0xB7) {         // trang (chế độ trang)
+        if (e->addr_mode == 2) e->page = op & 0x07;
+        return;
+    }
+
+    switch (op) {
+    case 0x20:
+        if ((c[1] & 0x03) == 0x03) {
+            e->protocol_errors++;
+        } else {
+            e->addr_mode = c[1] & 0x03;
+        }
+        break;
+    case 0x21: // chỉ có tác dụng ở chế độ ngang/dọc; đặt luôn con trỏ về đầu cửa sổ
+        if (e->addr_mode != 2) {
+            e->col_start = c[1] & 0x7F;
+            e->col_end = c[2] & 0x7F;
+            e->col = e->col_start;
+        }
+        break;
+    case 0x22:
+        if (e->addr_mode != 2) {
+            e->page_start = c[1] & 0x07;
+            e->page_end = c[2] & 0x07;
+            e->page = e->page_start;
+        }
+        break;
+    case 0x81: e->contrast = c[1]; break;
+    case 0x8D: e->charge_pump = (c[1] & 0x04) != 0; break;
+    case 0xA0: case 0xA1: e->seg_remap = op & 1; break;
+    case 0xA4: case 0xA5: e->all_on = op & 1; break;
+    case 0xA6: case 0xA7: e->inverse = op & 1; break;
+    case 0xA8:
+        if ((c[1] & 0x3F) < 15) {
+            e->protocol_errors++; // MUX 0..14 không hợp lệ
+        } else {
+            e->mux_ratio = c[1] & 0x3F;
+        }
+        break;
+    case 0xAE: case 0xAF: e->display_on = op & 1; break;
+    case 0xC0: case 0xC8: e->com_remap = (op & 0x08) != 0; break;
+    case 0xD3: e->display_offset = c[1] & 0x3F; break;
+    case 0xD5: e->clock_div = c[1]; break;
+    case 0xD9: e->precharge = c[1]; break;
+    case 0xDA: e->com_pins = c[1] & 0x32; break;
+    case 0xDB: e->vcomh = c[1]; break;
+    case 0xE3: break; // NOP
+    case 0x26: case 0x27:
+        e->scroll_dir = op == 0x26 ? 1 : -1;
+        e->scroll_vertical = 0;
+        e->scroll_page0 = c[2] & 0x07;
+        e->scroll_interval = c[3] & 0x07;
+        e->scroll_page1 = c[4] & 0x07;
+        e->scroll_voffset = 0;
+        break;
+    case 0x29: case 0x2A:
+        e->scroll_dir = op == 0x29 ? 1 : -1;
+        e->scroll_vertical = 1;
+        e->scroll_page0 = c[2] & 0x07;
+        e->scroll_interval = c[3] & 0x07;
+        e->scroll_page1 = c[4] & 0x07;
+        e->scroll_voffset = c[5] & 0x3F;
+        break;
+    case 0xA3:
+        e->vscroll_top = c[1] & 0x3F;
+        e->vscroll_rows = c[2] & 0x7F;
+        break;
+    case 0x2E:
+        e->scroll_active = 0;
+        e->vscroll_pos = 0;
+        break;
+    case 0x2F:
+        e->scroll_active = 1;
+        e->scroll_frames = 0;
+        e->vscroll_pos = 0;
+        break;
+    default:
+        e->unknown_cmds++;
+        break;
+    }
+}
+
+static void emu_write_cmd(ssd1306_emu_t *e, uint8_t byte) {
+    e->cmd_bytes++;
+    if (e->cmd_len == 0) {
+        e->cmd_need = emu_cmd_params(byte);
+    }
+    e->cmd[e->cmd_len++] = byte;
+    if (e->cmd_len > e->cmd_need) {
+        emu_exec(e);
+        e->cmd_len = 0;
+    }
+}
+
+void ssd1306_emu_write(ssd1306_emu_t *e, const uint8_t *buf, size_t len) {
+    size_t i = 0;
+    e->txns++;
+    while (i < len) {
+        uint8_t control = buf[i++];
+        if ((control & 0x3F) != 0) {
+            e->protocol_errors++; // 6 bit thấp của control byte phải bằng 0
+        }
+        int is_data = (control & 0x40) != 0;
+        size_t end = (control & 0x80) ? i + 1 : len; // Co = 1: đúng một byte rồi tới control byte mới
+        if (end > len) {
+            e->protocol_errors++; // control byte Co = 1 ở cuối giao dịch
+            break;
+        }
+        for (; i < end; ++i) {
+            if (!is_data) {
+                emu_write_cmd(e, buf[i]);
+                continue;
+            }
+            if (e->cmd_len != 0) {
+                e->protocol_errors++; // dữ liệu đến khi lệnh còn thiếu tham số: bỏ lệnh
+                e->cmd_len = 0;
+            }
+            emu_write_data(e, buf[i]);
+        }
+    }
+}
+
+// =========================================================================
+// Gắn vào bus mem
+// =========================================================================
+
+static void emu_endpoint(void *ctx, uint16_t addr, const uint8_t *buf, size_t len) {
+    for (ssd1306_emu_t *e = ctx; e != NULL; e = e->next) {
+        if (e->addr == addr) {
+            ssd1306_emu_write(e, buf, len);
+        }
+    }
+}
+
+void ssd1306_emu_attach(ssd1306_emu_t *e, ssd1306_transport_t *t) {
+    e->next = t->mem.endpoint == emu_endpoint ? t->mem.endpoint_ctx : NULL;
+    t->mem.endpoint = emu_endpoint;
+    t->mem.endpoint_ctx = e;
+}
+
+size_t ssd1306_emu_replay(ssd1306_emu_t *e, const ssd1306_transport_t *t) {
+    size_t n = 0;
+    for (size_t i = 0; i < t->mem.txn_count; ++i) {
+        const ssd1306_mem_txn_t *txn = &t->mem.txns[i];
+        if (txn->addr != e->addr) continue;
+        ssd1306_emu_write(e, t->mem.log + txn->offset, txn->len);
+        n++;
+    }
+    return n;
+}
+
+// =========================================================================
+// Cuộn liên tục: chip dịch chính nội dung GDDRAM mỗi bước
+// =========================================================================
+
+static void emu_scroll_step(ssd1306_emu_t *e) {
+    for (int p = e->scroll_page0; p <= e->scroll_page1; ++p) {
+        uint8_t *row = e->gddram[p];
+        if (e->scroll_dir > 0) {
+            uint8_t last = row[SSD1306_EMU_COLS - 1];
+            memmove(row + 1, row, SSD1306_EMU_COLS - 1);
+            row[0] = last;
+        } else {
+            uint8_t first = row[0];
+            memmove(row, row + 1, SSD1306_EMU_COLS - 1);
+            row[SSD1306_EMU_COLS - 1] = first;
+        }
+    }
+    if (e->scroll_vertical && e->vscroll_rows != 0) {
+        e->vscroll_pos = (e->vscroll_pos + e->scroll_voffset) % e->vscroll_rows;
+    }
+}
+
+void ssd1306_emu_advance_frames(ssd1306_emu_t *e, int frames) {
+    if (!e->scroll_active) return;
+    for (int i = 0; i < frames; ++i) {
+        if (++e->scroll_frames >= emu_scroll_frames[e->scroll_interval]) {
+            e->scroll_frames = 0;
+            emu_scroll_step(e);
+        }
+    }
+}
+
+// =========================================================================
+// Ảnh hiển thị
+// =========================================================================
+
+// Hàng kính y được quét ở hàng thứ mấy (0..mux) của bộ đếm hàng, -1 nếu không được quét.
+// Module cao hơn 32 hàng (128x64, 64x48) nối chân COM xen kẽ (khớp 0xDA 0x12), module
+// 128x32, 96x16 nối tuần tự (0xDA 0x02); cấu hình 0xDA khác với cách nối sẽ làm các hàng
+// bị xáo trộn như trên panel thật.
+static int emu_scan_row(const ssd1306_emu_t *e, int y) {
+    int n = e->mux_ratio + 1;
+    int half = e->height / 2;
+    int pin = e->height > 32 ? (y < half ? 2 * y : 2 * (y - half) + 1) : y;
+
+    int k;
+    if (e->com_pins & 0x10) {               // cấu hình xen kẽ
+        int even = (pin & 1) == ((e->com_pins & 0x20) ? 1 : 0);
+        k = even ? pin / 2 : n / 2 + pin / 2;
+    } else {                                // cấu hình tuần tự
+        k = pin;
+        if (e->com_pins & 0x20) k = (k + n / 2) % n;
+    }
+    if (k >= n) return -1;
+    return e->com_remap ? k : n - 1 - k;
+}
+
+int ssd1306_emu_pixel(const ssd1306_emu_t *e, int x, int y) {
+    if (x < 0 || x >= e->width || y < 0 || y >= e->height) return 0;
+    if (!e->display_on || !e->charge_pump) return 0; // module dùng charge pump nội: không có VCC thì tối
+
+    int r = emu_scan_row(e, y);
+    if (r < 0) return 0;
+    if (e->all_on) return 1;
+
+    // Cuộn dọc (0x29/0x2A) chỉ dịch các hàng trong vùng 0xA3
+    if (e->scroll_active && e->scroll_vertical &&
+        r >= e->vscroll_top && r < e->vscroll_top + e->vscroll_rows) {
+        r = e->vscroll_top + (r - e->vscroll_top + e->vscroll_pos) % e->vscroll_rows;
+    }
+    int row = (r + e->start_line + e->display_offset) & 63;
+    return ((e->gddram[row >> 3][e->seg_offset + x] >> (row & 7)) & 1) ^ e->inverse;
+}
+
+void ssd1306_emu_render(const ssd1306_emu_t *e, uint8_t *out) {
+    memset(out, 0, SSD1306_EMU_COLS * (e->height / 8));
+    for (int y = 0; y < e->height; ++y) {
+        for (int x = 0; x < e->width; ++x) {
+            if (ssd1306_emu_pixel(e, x, y)) {
+                out[(y >> 3) * SSD1306_EMU_COLS + x] |= (uint8_t)(1u << (y & 7));
+            }
+        }
+    }
+}
+
+// PBM: bit 1 là màu đen. Pixel sáng của OLED được ghi thành trắng để ảnh giống panel.
+int ssd1306_emu_write_pbm(const ssd1306_emu_t *e, const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        perror("Failed to open PBM file");
+        return -1;
+    }
+    fprintf(f, "P4\n%d %d\n", e->width, e->height);
+    for (int y = 0; y < e->height; ++y) {
+        uint8_t row[SSD1306_EMU_COLS / 8];
+        for (int b = 0; b < (e->width + 7) / 8; ++b) {
+            uint8_t bits = 0;
+            for (int i = 0; i < 8; ++i) {
+                bits = (uint8_t)((bits << 1) | !ssd1306_emu_pixel(e, b * 8 + i, y));
+            }
+            row[b] = bits;
+        }
+        fwrite(row, 1, (e->width + 7) / 8, f);
+    }
+    if (fclose(f) != 0) {
+        perror("Failed to write PBM file");
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,98 @@
+#ifndef SSD1306_EMU_H
+#define SSD1306_EMU_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "ssd1306_transport.h"
+
+// =========================================================================
+// Bộ mô phỏng SSD1306 (phần mềm)
+// Nhận đúng các giao dịch I2C mà driver gửi (control byte 0x00/0x80/0x40/0xC0),
+// giải mã lệnh và giữ một mô hình GDDRAM 128x64 cùng các thanh ghi liên quan tới hình:
+//   - chế độ địa chỉ 0x20 (ngang, dọc, trang), cửa sổ 0x21/0x22, con trỏ quay vòng
+//   - start line 0x40|n, display offset 0xD3, multiplex 0xA8, cấu hình chân COM 0xDA
+//   - segment remap 0xA0/0xA1 (như chip thật, chỉ áp dụng cho dữ liệu ghi sau lệnh), hướng quét COM 0xC0/0xC8
+//   - bật/tắt, đảo màu, toàn màn hình sáng, charge pump
+//   - cuộn liên tục 0x26/0x27/0x29/0x2A/0xA3 (dịch GDDRAM như chip thật)
+// Ảnh hiển thị được tính theo cách nối dây của module thông dụng: với cấu hình
+// khởi tạo của driver (0xA1, 0xC8, 0xDA 0x12 cho 64 hàng) ảnh trùng với display_buffer.
+// Tấm kính width x height nối với các SEG seg_offset .. seg_offset + width - 1 (panel hẹp
+// như 64x48, 96x16 chỉ nối một dải SEG); GDDRAM vẫn đủ 128x64.
+//
+// Gắn vào bus mem bằng ssd1306_emu_attach(): mọi giao dịch gửi tới địa chỉ của bộ
+// mô phỏng được xử lý ngay, nên có thể so từng pixel giữa các đường gửi tối ưu
+// và một lần gửi nguyên khung đơn giản.
+// =========================================================================
+
+#define SSD1306_EMU_COLS         128
+#define SSD1306_EMU_PAGES        8
+
+typedef struct ssd1306_emu ssd1306_emu_t;
+
+struct ssd1306_emu {
+    uint16_t addr;              // địa chỉ slave mà bộ mô phỏng trả lời
+    int width, height;          // kích thước tấm kính (128x64, 128x32, 64x48, 96x16, ...)
+    int seg_offset;             // SEG nối với cột 0 của kính
+    uint8_t gddram[SSD1306_EMU_PAGES][SSD1306_EMU_COLS]; // cột theo kính (đã qua segment remap lúc ghi)
+
+    // Con trỏ địa chỉ và cửa sổ
+    uint8_t addr_mode;          // 0: ngang, 1: dọc, 2: trang (mặc định sau reset)
+    uint8_t col_start, col_end, page_start, page_end;
+    uint8_t col, page;          // con trỏ ghi hiện tại
+    uint8_t page_mode_col;      // cột bắt đầu của chế độ trang (0x00-0x1F)
+
+    // Thanh ghi hiển thị
+    uint8_t start_line, display_offset, mux_ratio, com_pins;
+    uint8_t seg_remap, com_remap;   // 0xA1 / 0xC8
+    uint8_t display_on, inverse, all_on, charge_pump;
+    uint8_t contrast, clock_div, precharge, vcomh;
+
+    // Cuộn liên tục
+    uint8_t scroll_active, scroll_vertical;
+    int8_t scroll_dir;          // +1: phải, -1: trái
+    uint8_t scroll_page0, scroll_page1, scroll_interval, scroll_voffset;
+    uint8_t vscroll_top, vscroll_rows;
+    int vscroll_pos;            // số hàng đã cuộn dọc trong vùng 0xA3
+    int scroll_frames;          // số khung từ bước cuộn trước
+
+    // Bộ giải mã lệnh (lệnh nhiều byte có thể kéo dài qua nhiều giao dịch)
+    uint8_t cmd[8];
+    int cmd_len, cmd_need;
+
+    // Thống kê
+    uint64_t txns, cmd_bytes, data_bytes;
+    uint64_t protocol_errors;   // control byte sai, dữ liệu chen giữa tham số lệnh
+    uint64_t unknown_cmds;
+    uint64_t scroll_ram_writes; // ghi GDDRAM khi đang cuộn (datasheet: kết quả không xác định)
+
+    ssd1306_emu_t *next;        // bộ mô phỏng khác trên cùng bus mem
+};
+
+// Trạng thái sau khi cấp nguồn: thanh ghi mặc định theo datasheet, GDDRAM chứa rác
+// (mẫu giả ngẫu nhiên cố định, để lộ ra các vùng driver quên ghi)
+void ssd1306_emu_init(ssd1306_emu_t *e, uint16_t addr, int width, int height, int seg_offset);
+
+// Xử lý một giao dịch (không gồm byte địa chỉ)
+void ssd1306_emu_write(ssd1306_emu_t *e, const uint8_t *buf, size_t len);
+
+// Nhận các giao dịch tới e->addr trên bus mem t (có thể gắn nhiều bộ mô phỏng)
+void ssd1306_emu_attach(ssd1306_emu_t *e, ssd1306_transport_t *t);
+
+// Phát lại các giao dịch tới e->addr đã ghi trong log của bus mem. Trả về số giao dịch.
+size_t ssd1306_emu_replay(ssd1306_emu_t *e, const ssd1306_transport_t *t);
+
+// Cho thời gian trôi qua frames khung hình (chỉ ảnh hưởng tới cuộn liên tục)
+void ssd1306_emu_advance_frames(ssd1306_emu_t *e, int frames);
+
+// Pixel (x, y) trên tấm kính đang sáng hay tắt
+int ssd1306_emu_pixel(const ssd1306_emu_t *e, int x, int y);
+
+// Ảnh đang hiển thị theo bố cục trang của display_buffer (hàng trang dài 128 byte,
+// 128 * height / 8 byte, các cột >= width là 0)
+void ssd1306_emu_render(const ssd1306_emu_t *e, uint8_t *out);
+
+// Ghi ảnh đang hiển thị ra file PBM nhị phân (P4). Trả về 0/-1.
+int ssd1306_emu_write_pbm(const ssd1306_emu_t *e, const char *path);
+
+#endif // SSD1306_EMU_H
@@ -0,0 +1,276 @@
+#include "ssd1306_font.h"
+
+// =========================================================================
+// Bảng glyph 5x7 cho mã 0x20..0xFF, mỗi glyph 5 cột.
+// Bit 0..6 là 7 hàng của chữ; bit 7 chỉ dùng cho phần móc dưới (ç, µ, ¢).
+// Chữ hoa có dấu được nén còn 5 hàng (bỏ hàng 1 và 5) để dấu nằm ở hàng 0..1.
+// =========================================================================
+#define SSD1306_FONT5X7_GLYPHS(X) \
+    X(0x00,0x00,0x00,0x00,0x00) /* 0x20 ' ' */ \
+    X(0x00,0x00,0x5F,0x00,0x00) /* 0x21 '!' */ \
+    X(0x00,0x07,0x00,0x07,0x00) /* 0x22 '"' */ \
+    X(0x14,0x7F,0x14,0x7F,0x14) /* 0x23 '#' */ \
+    X(0x24,0x2A,0x7F,0x2A,0x12) /* 0x24 '$' */ \
+    X(0x23,0x13,0x08,0x64,0x62) /* 0x25 '%' */ \
+    X(0x36,0x49,0x55,0x22,0x50) /* 0x26 '&' */ \
+    X(0x00,0x05,0x03,0x00,0x00) /* 0x27 ''' */ \
+    X(0x00,0x1C,0x22,0x41,0x00) /* 0x28 '(' */ \
+    X(0x00,0x41,0x22,0x1C,0x00) /* 0x29 ')' */ \
+    X(0x08,0x2A,0x1C,0x2A,0x08) /* 0x2A '*' */ \
+    X(0x08,0x08,0x3E,0x08,0x08) /* 0x2B '+' */ \
+    X(0x00,0x50,0x30,0x00,0x00) /* 0x2C ',' */ \
+    X(0x08,0x08,0x08,0x08,0x08) /* 0x2D '-' */ \
+    X(0x00,0x60,0x60,0x00,0x00) /* 0x2E '.' */ \
+    X(0x20,0x10,0x08,0x04,0x02) /* 0x2F '/' */ \
+    X(0x3E,0x51,0x49,0x45,0x3E) /* 0x30 '0' */ \
+    X(0x00,0x42,0x7F,0x40,0x00) /* 0x31 '1' */ \
+    X(0x42,0x61,0x51,0x49,0x46) /* 0x32 '2' */ \
+    X(0x21,0x41,0x45,0x4B,0x31) /* 0x33 '3' */ \
+    X(0x18,0x14,0x12,0x7F,0x10) /* 0x34 '4' */ \
+    X(0x27,0x45,0x45,0x45,0x39) /* 0x35 '5' */ \
+    X(0x3C,0x4A,0x49,0x49,0x30) /* 0x36 '6' */ \
+    X(0x01,0x71,0x09,0x05,0x03) /* 0x37 '7' */ \
+    X(0x36,0x49,0x49,0x49,0x36) /* 0x38 '8' */ \
+    X(0x06,0x49,0x49,0x29,0x1E) /* 0x39 '9' */ \
+    X(0x00,0x36,0x36,0x00,0x00) /* 0x3A ':' */ \
+    X(0x00,0x56,0x36,0x00,0x00) /* 0x3B ';' */ \
+    X(0x08,0x14,0x22,0x41,0x00) /* 0x3C '<' */ \
+    X(0x14,0x14,0x14,0x14,0x14) /* 0x3D '=' */ \
+    X(0x00,0x41,0x22,0x14,0x08) /* 0x3E '>' */ \
+    X(0x02,0x01,0x51,0x09,0x06) /* 0x3F '?' */ \
+    X(0x32,0x49,0x79,0x41,0x3E) /* 0x40 '@' */ \
+    X(0x7E,0x11,0x11,0x11,0x7E) /* 0x41 'A' */ \
+    X(0x7F,0x49,0x49,0x49,0x36) /* 0x42 'B' */ \
+    X(0x3E,0x41,0x41,0x41,0x22) /* 0x43 'C' */ \
+    X(0x7F,0x41,0x41,0x22,0x1C) /* 0x44 'D' */ \
+    X(0x7F,0x49,0x49,0x49,0x41) /* 0x45 'E' */ \
+    X(0x7F,0x09,0x09,0x01,0x01) /* 0x46 'F' */ \
+    X(0x3E,0x41,0x41,0x51,0x32) /* 0x47 'G' */ \
+    X(0x7F,0x08,0x08,0x08,0x7F) /* 0x48 'H' */ \
+    X(0x00,0x41,0x7F,0x41,0x00) /* 0x49 'I' */ \
+    X(0x20,0x40,0x41,0x3F,0x01) /* 0x4A 'J' */ \
+    X(0x7F,0x08,0x14,0x22,0x41) /* 0x4B 'K' */ \
+    X(0x7F,0x40,0x40,0x40,0x40) /* 0x4C 'L' */ \
+    X(0x7F,0x02,0x04,0x02,0x7F) /* 0x4D 'M' */ \
+    X(0x7F,0x04,0x08,0x10,0x7F) /* 0x4E 'N' */ \
+    X(0x3E,0x41,0x41,0x41,0x3E) /* 0x4F 'O' */ \
+    X(0x7F,0x09,0x09,0x09,0x06) /* 0x50 'P' */ \
+    X(0x3E,0x41,0x51,0x21,0x5E) /* 0x51 'Q' */ \
+    X(0x7F,0x09,0x19,0x29,0x46) /* 0x52 'R' */ \
+    X(0x46,0x49,0x49,0x49,0x31) /* 0x53 'S' */ \
+    X(0x01,0x01,0x7F,0x01,0x01) /* 0x54 'T' */ \
+    X(0x3F,0x40,0x40,0x40,0x3F) /* 0x55 'U' */ \
+    X(0x1F,0x20,0x40,0x20,0x1F) /* 0x56 'V' */ \
+    X(0x7F,0x20,0x18,0x20,0x7F) /* 0x57 'W' */ \
+    X(0x63,0x14,0x08,0x14,0x63) /* 0x58 'X' */ \
+    X(0x03,0x04,0x78,0x04,0x03) /* 0x59 'Y' */ \
+    X(0x61,0x51,0x49,0x45,0x43) /* 0x5A 'Z' */ \
+    X(0x00,0x7F,0x41,0x41,0x00) /* 0x5B '[' */ \
+    X(0x02,0x04,0x08,0x10,0x20) /* 0x5C backslash */ \
+    X(0x00,0x41,0x41,0x7F,0x00) /* 0x5D ']' */ \
+    X(0x04,0x02,0x01,0x02,0x04) /* 0x5E '^' */ \
+    X(0x40,0x40,0x40,0x40,0x40) /* 0x5F '_' */ \
+    X(0x00,0x01,0x02,0x04,0x00) /* 0x60 '`' */ \
+    X(0x20,0x54,0x54,0x54,0x78) /* 0x61 'a' */ \
+    X(0x7F,0x48,0x44,0x44,0x38) /* 0x62 'b' */ \
+    X(0x38,0x44,0x44,0x44,0x20) /* 0x63 'c' */ \
+    X(0x38,0x44,0x44,0x48,0x7F) /* 0x64 'd' */ \
+    X(0x38,0x54,0x54,0x54,0x18) /* 0x65 'e' */ \
+    X(0x08,0x7E,0x09,0x01,0x02) /* 0x66 'f' */ \
+    X(0x08,0x54,0x54,0x54,0x3C) /* 0x67 'g' */ \
+    X(0x7F,0x08,0x04,0x04,0x78) /* 0x68 'h' */ \
+    X(0x00,0x44,0x7D,0x40,0x00) /* 0x69 'i' */ \
+    X(0x20,0x40,0x44,0x3D,0x00) /* 0x6A 'j' */ \
+    X(0x7F,0x10,0x28,0x44,0x00) /* 0x6B 'k' */ \
+    X(0x00,0x41,0x7F,0x40,0x00) /* 0x6C 'l' */ \
+    X(0x7C,0x04,0x18,0x04,0x78) /* 0x6D 'm' */ \
+    X(0x7C,0x08,0x04,0x04,0x78) /* 0x6E 'n' */ \
+    X(0x38,0x44,0x44,0x44,0x38) /* 0x6F 'o' */ \
+    X(0x7C,0x14,0x14,0x14,0x08) /* 0x70 'p' */ \
+    X(0x08,0x14,0x14,0x18,0x7C) /* 0x71 'q' */ \
+    X(0x7C,0x08,0x04,0x04,0x08) /* 0x72 'r' */ \
+    X(0x48,0x54,0x54,0x54,0x20) /* 0x73 's' */ \
+    X(0x04,0x3F,0x44,0x40,0x20) /* 0x74 't' */ \
+    X(0x3C,0x40,0x40,0x20,0x7C) /* 0x75 'u' */ \
+    X(0x1C,0x20,0x40,0x20,0x1C) /* 0x76 'v' */ \
+    X(0x3C,0x40,0x30,0x40,0x3C) /* 0x77 'w' */ \
+    X(0x44,0x28,0x10,0x28,0x44) /* 0x78 'x' */ \
+    X(0x0C,0x50,0x50,0x50,0x3C) /* 0x79 'y' */ \
+    X(0x44,0x64,0x54,0x4C,0x44) /* 0x7A 'z' */ \
+    X(0x00,0x08,0x36,0x41,0x00) /* 0x7B '{' */ \
+    X(0x00,0x00,0x7F,0x00,0x00) /* 0x7C '|' */ \
+    X(0x00,0x41,0x36,0x08,0x00) /* 0x7D '}' */ \
+    X(0x08,0x04,0x08,0x10,0x08) /* 0x7E '~' */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x7F 0x7F (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x80 0x80 (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x81 0x81 (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x82 0x82 (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x83 0x83 (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x84 0x84 (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x85 0x85 (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x86 0x86 (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x87 0x87 (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x88 0x88 (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x89 0x89 (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x8A 0x8A (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x8B 0x8B (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x8C 0x8C (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x8D 0x8D (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x8E 0x8E (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x8F 0x8F (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x90 0x90 (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x91 0x91 (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x92 0x92 (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x93 0x93 (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x94 0x94 (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x95 0x95 (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x96 0x96 (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x97 0x97 (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x98 0x98 (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x99 0x99 (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x9A 0x9A (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x9B 0x9B (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x9C 0x9C (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x9D 0x9D (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x9E 0x9E (control, box) */ \
+    X(0x7F,0x41,0x41,0x41,0x7F) /* 0x9F 0x9F (control, box) */ \
+    X(0x00,0x00,0x00,0x00,0x00) /* 0xA0 NBSP */ \
+    X(0x00,0x00,0x7D,0x00,0x00) /* 0xA1 '¡' */ \
+    X(0x38,0x44,0xFE,0x44,0x28) /* 0xA2 '¢' */ \
+    X(0x48,0x7E,0x49,0x41,0x42) /* 0xA3 '£' */ \
+    X(0x5D,0x22,0x22,0x22,0x5D) /* 0xA4 '¤' */ \
+    X(0x29,0x2A,0x7C,0x2A,0x29) /* 0xA5 '¥' */ \
+    X(0x00,0x00,0x77,0x00,0x00) /* 0xA6 '¦' */ \
+    X(0x0A,0x55,0x55,0x55,0x28) /* 0xA7 '§' */ \
+    X(0x00,0x01,0x00,0x01,0x00) /* 0xA8 '¨' */ \
+    X(0x3E,0x5D,0x55,0x41,0x3E) /* 0xA9 '©' */ \
+    X(0x26,0x29,0x29,0x2F,0x28) /* 0xAA 'ª' */ \
+    X(0x08,0x14,0x2A,0x14,0x22) /* 0xAB '«' */ \
+    X(0x08,0x08,0x08,0x08,0x38) /* 0xAC '¬' */ \
+    X(0x00,0x08,0x08,0x08,0x00) /* 0xAD SHY */ \
+    X(0x3E,0x5D,0x4D,0x55,0x3E) /* 0xAE '®' */ \
+    X(0x01,0x01,0x01,0x01,0x01) /* 0xAF '¯' */ \
+    X(0x00,0x06,0x09,0x09,0x06) /* 0xB0 '°' */ \
+    X(0x44,0x44,0x5F,0x44,0x44) /* 0xB1 '±' */ \
+    X(0x00,0x19,0x15,0x12,0x00) /* 0xB2 '²' */ \
+    X(0x00,0x11,0x15,0x0A,0x00) /* 0xB3 '³' */ \
+    X(0x00,0x00,0x02,0x01,0x00) /* 0xB4 '´' */ \
+    X(0xFC,0x40,0x40,0x20,0x7C) /* 0xB5 'µ' */ \
+    X(0x06,0x0F,0x7F,0x01,0x7F) /* 0xB6 '¶' */ \
+    X(0x00,0x00,0x08,0x00,0x00) /* 0xB7 '·' */ \
+    X(0x00,0x00,0x80,0x40,0x00) /* 0xB8 '¸' */ \
+    X(0x00,0x12,0x1F,0x10,0x00) /* 0xB9 '¹' */ \
+    X(0x00,0x26,0x29,0x29,0x26) /* 0xBA 'º' */ \
+    X(0x22,0x14,0x2A,0x14,0x08) /* 0xBB '»' */ \
+    X(0x17,0x08,0x34,0x2A,0x78) /* 0xBC '¼' */ \
+    X(0x17,0x08,0x04,0x6A,0x58) /* 0xBD '½' */ \
+    X(0x15,0x1F,0x28,0x34,0x7A) /* 0xBE '¾' */ \
+    X(0x30,0x48,0x45,0x40,0x20) /* 0xBF '¿' */ \
+    X(0x78,0x25,0x26,0x24,0x78) /* 0xC0 'À' */ \
+    X(0x78,0x24,0x26,0x25,0x78) /* 0xC1 'Á' */ \
+    X(0x78,0x26,0x25,0x26,0x78) /* 0xC2 'Â' */ \
+    X(0x7A,0x25,0x25,0x26,0x79) /* 0xC3 'Ã' */ \
+    X(0x78,0x25,0x24,0x25,0x78) /* 0xC4 'Ä' */ \
+    X(0x78,0x27,0x25,0x27,0x78) /* 0xC5 'Å' */ \
+    X(0x7E,0x09,0x7F,0x49,0x41) /* 0xC6 'Æ' */ \
+    X(0x3E,0x41,0xC1,0xC1,0x22) /* 0xC7 'Ç' */ \
+    X(0x7C,0x55,0x56,0x54,0x44) /* 0xC8 'È' */ \
+    X(0x7C,0x54,0x56,0x55,0x44) /* 0xC9 'É' */ \
+    X(0x7C,0x56,0x55,0x56,0x44) /* 0xCA 'Ê' */ \
+    X(0x7C,0x55,0x54,0x55,0x44) /* 0xCB 'Ë' */ \
+    X(0x00,0x45,0x7E,0x44,0x00) /* 0xCC 'Ì' */ \
+    X(0x00,0x44,0x7E,0x45,0x00) /* 0xCD 'Í' */ \
+    X(0x00,0x46,0x7D,0x46,0x00) /* 0xCE 'Î' */ \
+    X(0x00,0x45,0x7C,0x45,0x00) /* 0xCF 'Ï' */ \
+    X(0x08,0x7F,0x49,0x22,0x1C) /* 0xD0 'Ð' */ \
+    X(0x7E,0x09,0x11,0x22,0x7D) /* 0xD1 'Ñ' */ \
+    X(0x38,0x45,0x46,0x44,0x38) /* 0xD2 'Ò' */ \
+    X(0x38,0x44,0x46,0x45,0x38) /* 0xD3 'Ó' */ \
+    X(0x38,0x46,0x45,0x46,0x38) /* 0xD4 'Ô' */ \
+    X(0x3A,0x45,0x45,0x46,0x39) /* 0xD5 'Õ' */ \
+    X(0x38,0x45,0x44,0x45,0x38) /* 0xD6 'Ö' */ \
+    X(0x22,0x14,0x08,0x14,0x22) /* 0xD7 '×' */ \
+    X(0x5E,0x31,0x49,0x46,0x3D) /* 0xD8 'Ø' */ \
+    X(0x3C,0x41,0x42,0x40,0x3C) /* 0xD9 'Ù' */ \
+    X(0x3C,0x40,0x42,0x41,0x3C) /* 0xDA 'Ú' */ \
+    X(0x3C,0x42,0x41,0x42,0x3C) /* 0xDB 'Û' */ \
+    X(0x3C,0x41,0x40,0x41,0x3C) /* 0xDC 'Ü' */ \
+    X(0x04,0x08,0x72,0x09,0x04) /* 0xDD 'Ý' */ \
+    X(0x7F,0x22,0x22,0x22,0x1C) /* 0xDE 'Þ' */ \
+    X(0x7E,0x01,0x4D,0x52,0x20) /* 0xDF 'ß' */ \
+    X(0x20,0x55,0x56,0x54,0x78) /* 0xE0 'à' */ \
+    X(0x20,0x54,0x56,0x55,0x78) /* 0xE1 'á' */ \
+    X(0x20,0x56,0x55,0x56,0x78) /* 0xE2 'â' */ \
+    X(0x22,0x55,0x55,0x56,0x79) /* 0xE3 'ã' */ \
+    X(0x20,0x55,0x54,0x55,0x78) /* 0xE4 'ä' */ \
+    X(0x20,0x57,0x55,0x57,0x78) /* 0xE5 'å' */ \
+    X(0x24,0x54,0x78,0x54,0x58) /* 0xE6 'æ' */ \
+    X(0x38,0x44,0xC4,0xC4,0x20) /* 0xE7 'ç' */ \
+    X(0x38,0x55,0x56,0x54,0x18) /* 0xE8 'è' */ \
+    X(0x38,0x54,0x56,0x55,0x18) /* 0xE9 'é' */ \
+    X(0x38,0x56,0x55,0x56,0x18) /* 0xEA 'ê' */ \
+    X(0x38,0x55,0x54,0x55,0x18) /* 0xEB 'ë' */ \
+    X(0x00,0x45,0x7E,0x40,0x00) /* 0xEC 'ì' */ \
+    X(0x00,0x44,0x7E,0x41,0x00) /* 0xED 'í' */ \
+    X(0x00,0x46,0x7D,0x42,0x00) /* 0xEE 'î' */ \
+    X(0x00,0x45,0x7C,0x41,0x00) /* 0xEF 'ï' */ \
+    X(0x38,0x45,0x45,0x46,0x3C) /* 0xF0 'ð' */ \
+    X(0x7E,0x09,0x05,0x06,0x79) /* 0xF1 'ñ' */ \
+    X(0x38,0x45,0x46,0x44,0x38) /* 0xF2 'ò' */ \
+    X(0x38,0x44,0x46,0x45,0x38) /* 0xF3 'ó' */ \
+    X(0x38,0x46,0x45,0x46,0x38) /* 0xF4 'ô' */ \
+    X(0x3A,0x45,0x45,0x46,0x39) /* 0xF5 'õ' */ \
+    X(0x38,0x45,0x44,0x45,0x38) /* 0xF6 'ö' */ \
+    X(0x08,0x08,0x2A,0x08,0x08) /* 0xF7 '÷' */ \
+    X(0x58,0x24,0x54,0x48,0x34) /* 0xF8 'ø' */ \
+    X(0x3C,0x41,0x42,0x20,0x7C) /* 0xF9 'ù' */ \
+    X(0x3C,0x40,0x42,0x21,0x7C) /* 0xFA 'ú' */ \
+    X(0x3C,0x42,0x41,0x22,0x7C) /* 0xFB 'û' */ \
+    X(0x3C,0x41,0x40,0x21,0x7C) /* 0xFC 'ü' */ \
+    X(0x0C,0x50,0x52,0x51,0x3C) /* 0xFD 'ý' */ \
+    X(0x7F,0x24,0x44,0x44,0x38) /* 0xFE 'þ' */ \
+    X(0x0C,0x51,0x50,0x51,0x3C) /* 0xFF 'ÿ' */
+
+
+#define SSD1306_GLYPH_5X7(c0, c1, c2, c3, c4) c0, c1, c2, c3, c4,
+
+static const uint8_t font5x7_glyphs[] = {
+    SSD1306_FONT5X7_GLYPHS(SSD1306_GLYPH_5X7)
+};
+
+const ssd1306_font_t ssd1306_font_5x7 = {
+    .width = 5, .height = 8, .spacing = 1, .bytes_per_glyph = 5,
+    .first = 0x20, .last = 0xFF, .fallback = '?',
+    .glyphs = font5x7_glyphs,
+};
+
+// =========================================================================
+// Phông 8x16 được dựng từ chính bảng 5x7 lúc biên dịch:
+//   - mỗi hàng nhân đôi theo chiều dọc (8 hàng -> 16 hàng, hai trang),
+//   - mỗi cột OR với cột bên trái để nét dày 2 pixel (5 cột -> 6 cột),
+//   - cột 0 và cột 7 để trống làm khoảng cách.
+// =========================================================================
+
+// Nhân đôi 4 bit thấp của b thành 8 bit (bit r -> bit 2r và 2r+1)
+#define SSD1306_DBL_LO(b) ((((b) >> 0 & 1) * 0x03) | (((b) >> 1 & 1) * 0x0C) | \
+                           (((b) >> 2 & 1) * 0x30) | (((b) >> 3 & 1) * 0xC0))
+#define SSD1306_DBL_HI(b) SSD1306_DBL_LO((b) >> 4)
+
+#define SSD1306_GLYPH_8X16_PAGE(D, c0, c1, c2, c3, c4) \
+    0x00, D(c0), D((c0) | (c1)), D((c1) | (c2)), D((c2) | (c3)), D((c3) | (c4)), D(c4), 0x00,
+#define SSD1306_GLYPH_8X16(c0, c1, c2, c3, c4) \
+    SSD1306_GLYPH_8X16_PAGE(SSD1306_DBL_LO, c0, c1, c2, c3, c4) \
+    SSD1306_GLYPH_8X16_PAGE(SSD1306_DBL_HI, c0, c1, c2, c3, c4)
+
+static const uint8_t font8x16_glyphs[] = {
+    SSD1306_FONT5X7_GLYPHS(SSD1306_GLYPH_8X16)
+};
+
+const ssd1306_font_t ssd1306_font_8x16 = {
+    .width = 8, .height = 16, .spacing = 0, .bytes_per_glyph = 16,
+    .first = 0x20, .last = 0xFF, .fallback = '?',
+    .glyphs = font8x16_glyphs,
+};
+
+_Static_assert(sizeof(font5x7_glyphs) == (0x100 - 0x20) * 5, "font5x7 must cover 0x20..0xFF");
+_Static_assert(sizeof(font8x16_glyphs) == (0x100 - 0x20) * 16, "font8x16 must cover 0x20..0xFF");
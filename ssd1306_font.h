@@ -0,0 +1,39 @@
+#ifndef SSD1306_FONT_H
+#define SSD1306_FONT_H
+
+#include <stdint.h>
+
+// =========================================================================
+// Phông chữ bitmap cho SSD1306
+// Bảng glyph phủ liên tục mã 0x20..0xFF (ASCII + Latin-1), nên tra glyph chỉ là
+// một phép trừ và một phép nhân. Mã 0x7F..0x9F (ký tự điều khiển) là ô vuông rỗng.
+// Glyph lưu theo bố cục trang của display_buffer: mỗi byte là 8 pixel dọc của
+// một cột (bit 0 ở trên), các trang nối tiếp nhau (glyph[page * width + col]),
+// nên có thể đưa thẳng vào ssd1306_blit().
+// =========================================================================
+
+typedef struct {
+    uint8_t width;            // số cột của một glyph
+    uint8_t height;           // chiều cao ô chữ (bội của 8)
+    uint8_t spacing;          // số cột trống sau mỗi glyph
+    uint8_t bytes_per_glyph;  // width * height / 8
+    uint8_t first, last;      // dải mã có trong bảng
+    uint8_t fallback;         // glyph thay thế cho mã ngoài bảng
+    const uint8_t *glyphs;
+} ssd1306_font_t;
+
+extern const ssd1306_font_t ssd1306_font_5x7;   // 5x7, ô chữ 6x8
+extern const ssd1306_font_t ssd1306_font_8x16;  // 8x16, đã gồm khoảng cách
+
+// Trả về bitmap glyph của mã Latin-1 (hoặc Unicode <= 0xFF) cp
+static inline const uint8_t *ssd1306_font_glyph(const ssd1306_font_t *font, uint32_t cp) {
+    if (cp < font->first || cp > font->last) cp = font->fallback;
+    return font->glyphs + (cp - font->first) * font->bytes_per_glyph;
+}
+
+// Độ rộng bước tiến của một ký tự (glyph + khoảng cách)
+static inline int ssd1306_font_advance(const ssd1306_font_t *font) {
+    return font->width + font->spacing;
+}
+
+#endif // SSD1306_FONT_H
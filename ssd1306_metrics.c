@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>         // For sigaction()
+#include <pthread.h>        // For luồng báo cáo
+#include <semaphore.h>      // For sem_post() trong trình xử lý tín hiệu
+#include <stdatomic.h>
+
+#include "ssd1306_c_driver.h"
+
+// =========================================================================
+// Đọc histogram
+// =========================================================================
+
+uint64_t ssd1306_hist_percentile(const ssd1306_hist_t *h, double q) {
+    if (h->count == 0) return 0;
+    uint64_t rank = (uint64_t)(q * (double)h->count + 0.5);
+    if (rank < 1) rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < SSD1306_HIST_BUCKETS; ++i) {
+        seen += h->buckets[i];
+        if (seen >= rank) {
+            uint64_t upper = i == 0 ? 0 : (1ULL << i) - 1;
+            return i == SSD1306_HIST_BUCKETS - 1 || upper > h->max ? h->max : upper;
+        }
+    }
+    return h->max;
+}
+
+double ssd1306_metrics_fps(const ssd1306_metrics_t *m) {
+    return m->frame_avg_ns ? 1e9 / (double)m->frame_avg_ns : 0.0;
+}
+
+// =========================================================================
+// In ra JSON Lines: một dòng cho bus, một dòng cho mỗi màn hình trên bus
+// Histogram: số mẫu, trung bình, p50/p90/p99 (cận trên của bucket log2) và max,
+// thời gian tính bằng micro giây.
+// =========================================================================
+
+static void metrics_print_hist(FILE *out, const char *name, const ssd1306_hist_t *h, double scale) {
+    fprintf(out, ",\"%s\":{\"count\":%llu,\"mean\":%.2f,\"p50\":%.2f,\"p90\":%.2f,\"p99\":%.2f,\"max\":%.2f}",
+            name, (unsigned long long)h->count,
+            h->count ? (double)h->sum / h->count / scale : 0.0,
+            ssd1306_hist_percentile(h, 0.50) / scale, ssd1306_hist_percentile(h, 0.90) / scale,
+            ssd1306_hist_percentile(h, 0.99) / scale, h->max / scale);
+}
+
+void ssd1306_metrics_print(ssd1306_bus_t *bus, FILE *out) {
+    ssd1306_transport_metrics_t tm;
+    ssd1306_get_bus_metrics(bus, &tm);
+    uint64_t now = ssd1306_metrics_now();
+    double wall_ns = now > tm.start_ns ? (double)(now - tm.start_ns) : 0.0;
+
+    fprintf(out, "{\"bus\":\"%s\",\"transport\":\"%s\",\"syscalls\":%llu,\"txns\":%llu,\"bytes\":%llu,"
+                 "\"busy_pct\":%.1f,\"short_writes\":%llu,\"nacks\":%llu,\"size_rejects\":%llu,"
+                 "\"retries\":%llu,\"errors\":%llu",
+            bus->path, bus->t.ops ? bus->t.ops->name : "closed",
+            (unsigned long long)tm.syscalls, (unsigned long long)tm.txns, (unsigned long long)tm.bytes,
+            wall_ns > 0 ? 100.0 * tm.busy_ns / wall_ns : 0.0,
+            (unsigned long long)tm.short_writes, (unsigned long long)tm.nacks,
+            (unsigned long long)tm.size_rejects, (unsigned long long)tm.retries,
+            (unsigned long long)tm.errors);
+    metrics_print_hist(out, "write_us", &tm.write_ns, 1e3);
+    fprintf(out, "}\n");
+
+    for (int i = 0; i < bus->display_count; ++i) {
+        ssd1306_t *dev = bus->displays[i];
+        ssd1306_metrics_t m;
+        ssd1306_frame_stats_t fs;
+        ssd1306_get_metrics(dev, &m);
+        ssd1306_get_frame_stats(dev, &fs);
+
+        fprintf(out, "{\"display\":\"%s@0x%02X\",\"frames\":%llu,\"fps\":%.1f,\"dropped\":%llu,\"failed\":%llu,\"errors\":%llu",
+                bus->path, dev->addr, (unsigned long long)m.frames, ssd1306_metrics_fps(&m),
+                (unsigned long long)fs.dropped, (unsigned long long)m.frames_failed, (unsigned long long)m.errors);
+        metrics_print_hist(out, "flush_us", &m.flush_ns, 1e3);
+        metrics_print_hist(out, "flush_bytes", &m.flush_bytes, 1.0);
+        metrics_print_hist(out, "flush_txns", &m.flush_txns, 1.0);
+        metrics_print_hist(out, "render_us", &m.render_ns, 1e3);
+        metrics_print_hist(out, "frame_interval_us", &m.frame_interval_ns, 1e3);
+        metrics_print_hist(out, "lock_wait_us", &m.lock_wait_ns, 1e3);
+        metrics_print_hist(out, "cmd_us", &m.cmd_ns, 1e3);
+        metrics_print_hist(out, "data_us", &m.data_ns, 1e3);
+        fprintf(out, "}\n");
+    }
+}
+
+// =========================================================================
+// Báo cáo theo tín hiệu hoặc định kỳ
+// Một luồng chờ trên semaphore: trình xử lý tín hiệu chỉ sem_post() (an toàn trong
+// signal handler), việc lấy khóa bus và in được làm trong luồng. Mỗi tiến trình một bộ báo cáo.
+// =========================================================================
+
+static struct {
+    pthread_t thread;
+    sem_t wake;
+    atomic_bool running;
+    ssd1306_bus_t *buses[SSD1306_MAX_BUSES];
+    int bus_count;
+    FILE *out;
+    int interval_ms;
+    int signo;
+    struct sigaction old_action;
+} metrics_reporter;
+
+static void metrics_on_signal(int signo) {
+    (void)signo;
+    int saved = errno;
+    sem_post(&metrics_reporter.wake);
+    errno = saved;
+}
+
+static void *metrics_reporter_main(void *arg) {
+    (void)arg;
+    for (;;) {
+        int rc;
+        if (metrics_reporter.interval_ms > 0) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline); // sem_timedwait() dùng CLOCK_REALTIME
+            deadline.tv_sec += metrics_reporter.interval_ms / 1000;
+            deadline.tv_nsec += (long)(metrics_reporter.interval_ms % 1000) * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            while ((rc = sem_timedwait(&metrics_reporter.wake, &deadline)) != 0 && errno == EINTR) {
+            }
+        } else {
+            while ((rc = sem_wait(&metrics_reporter.wake)) != 0 && errno == EINTR) {
+            }
+        }
+        if (!atomic_load(&metrics_reporter.running)) break;
+        for (int i = 0; i < metrics_reporter.bus_count; ++i) {
+            ssd1306_metrics_print(metrics_reporter.buses[i], metrics_reporter.out);
+        }
+        fflush(metrics_reporter.out);
+    }
+    return NULL;
+}
+
+// In bộ đo của các bus ra out mỗi interval_ms mili giây (0: không định kỳ) và mỗi khi
+// tiến trình nhận tín hiệu signo (0: không dùng tín hiệu, ví dụ SIGUSR1). Trả về 0/-1.
+int ssd1306_metrics_start_reporter(ssd1306_bus_t *const *buses, int n, FILE *out, int interval_ms, int signo) {
+    if (atomic_load(&metrics_reporter.running)) {
+        fprintf(stderr, "Error: Metrics reporter already running.\n");
+        return -1;
+    }
+    if (n <= 0 || n > SSD1306_MAX_BUSES || out == NULL || (interval_ms <= 0 && signo <= 0)) {
+        fprintf(stderr, "Error: Invalid arguments for metrics reporter.\n");
+        return -1;
+    }
+    memcpy(metrics_reporter.buses, buses, n * sizeof(*buses));
+    metrics_reporter.bus_count = n;
+    metrics_reporter.out = out;
+    metrics_reporter.interval_ms = interval_ms;
+    metrics_reporter.signo = signo;
+    if (sem_init(&metrics_reporter.wake, 0, 0) != 0) {
+        perror("Failed to init metrics semaphore");
+        return -1;
+    }
+    atomic_store(&metrics_reporter.running, 1);
+    if (pthread_create(&metrics_reporter.thread, NULL, metrics_reporter_main, NULL) != 0) {
+        perror("Failed to start metrics reporter");
+        atomic_store(&metrics_reporter.running, 0);
+        sem_destroy(&metrics_reporter.wake);
+        return -1;
+    }
+    if (signo > 0) {
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = metrics_on_signal;
+        sa.sa_flags = SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        if (sigaction(signo, &sa, &metrics_reporter.old_action) != 0) {
+            perror("Failed to install metrics signal handler");
+            metrics_reporter.signo = 0;
+            ssd1306_metrics_stop_reporter();
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void ssd1306_metrics_stop_reporter(void) {
+    if (!atomic_load(&metrics_reporter.running)) return;
+    if (metrics_reporter.signo > 0) {
+        sigaction(metrics_reporter.signo, &metrics_reporter.old_action, NULL);
+    }
+    atomic_store(&metrics_reporter.running, 0);
+    sem_post(&metrics_reporter.wake);
+    pthread_join(metrics_reporter.thread, NULL);
+    sem_destroy(&metrics_reporter.wake);
+}
@@ -0,0 +1,92 @@
+#ifndef SSD1306_METRICS_H
+#define SSD1306_METRICS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+// =========================================================================
+// Đo đạc đường gửi (metrics)
+// Histogram log2 cho thời gian và kích thước: thêm một mẫu chỉ tốn vài lệnh (clz + cộng),
+// thời gian lấy bằng clock_gettime(CLOCK_MONOTONIC) (vDSO, không syscall).
+//   - Bus (ssd1306_transport_t::metrics): mỗi syscall ghi, giao dịch, byte, ghi thiếu,
+//     NACK, giao dịch bị từ chối vì kích thước, lần gửi lại, lỗi, thời gian bus bận
+//   - Màn hình (ssd1306_t::metrics): lệnh, dữ liệu, chờ khóa bus, flush (thời gian, byte,
+//     giao dịch), thời gian vẽ giữa hai lần flush/present, khoảng cách khung và fps
+// Bus chậm: flush_ns gần bằng frame_interval_ns, render_ns nhỏ. Bên vẽ chậm: ngược lại.
+// Biên dịch với -DSSD1306_NO_METRICS để bỏ mọi phép đo thời gian (chỉ còn bộ đếm).
+// Các trường chỉ được ghi khi giữ khóa bus; riêng render_ns/last_call_ns của present() bất
+// đồng bộ được ghi dưới ssd1306_t::render_lock để bên vẽ không phải chờ lần gửi đang chạy.
+// Đọc bằng ssd1306_get_metrics() (giữ cả hai khóa)/ssd1306_get_bus_metrics().
+// =========================================================================
+
+// Bucket i đếm các giá trị v với 2^(i-1) <= v < 2^i (bucket 0: v = 0); bucket cuối gom phần còn lại.
+// Với nano giây, bucket cuối bắt đầu từ ~1.07 s.
+#define SSD1306_HIST_BUCKETS     32
+
+typedef struct {
+    uint64_t count, sum, max;
+    uint64_t buckets[SSD1306_HIST_BUCKETS];
+} ssd1306_hist_t;
+
+typedef struct {
+    ssd1306_hist_t write_ns;  // một syscall ghi (write/ioctl), có thể chứa nhiều giao dịch
+    uint64_t syscalls;
+    uint64_t txns;            // giao dịch I2C đã lên bus
+    uint64_t bytes;           // byte đã lên bus (kể cả control byte, không kể byte địa chỉ)
+    uint64_t busy_ns;         // tổng thời gian trong syscall ghi
+    uint64_t short_writes;    // adapter chỉ nhận một phần giao dịch
+    uint64_t nacks;           // slave không ACK (ENXIO/EREMOTEIO)
+    uint64_t size_rejects;    // giao dịch bị từ chối vì dài hơn giới hạn adapter
+    uint64_t retries;         // gửi tiếp phần còn lại sau ghi thiếu/từ chối
+    uint64_t errors;          // ssd1306_transport_write() thất bại
+    uint64_t start_ns;        // thời điểm bắt đầu đo (mở bus hoặc reset), để tính tỷ lệ bus bận
+} ssd1306_transport_metrics_t;
+
+typedef struct {
+    ssd1306_hist_t cmd_ns;            // ssd1306_send_*command*(): chờ bus + gửi
+    ssd1306_hist_t data_ns;           // ssd1306_send_data()
+    ssd1306_hist_t lock_wait_ns;      // chờ khóa bus (màn hình khác hoặc luồng flush đang gửi)
+    ssd1306_hist_t flush_ns;          // một lần flush có gửi dữ liệu
+    ssd1306_hist_t flush_bytes;       // byte lên bus mỗi lần flush (kể cả phần chia nhỏ)
+    ssd1306_hist_t flush_txns;        // giao dịch I2C mỗi lần flush
+    ssd1306_hist_t render_ns;         // bên vẽ: từ lần display_buffer()/present() trước tới lần này
+    ssd1306_hist_t frame_interval_ns; // giữa hai khung liên tiếp lên màn hình
+    uint64_t frames;                  // số khung đã lên màn hình (flush có gửi dữ liệu)
+    uint64_t errors;                  // lệnh/dữ liệu/flush thất bại
+    uint64_t frames_failed;           // khung của luồng flush nền gửi lỗi (không tính là đã flush)
+    uint64_t frame_avg_ns;            // trung bình trượt (hệ số 1/8) của frame_interval_ns
+    uint64_t last_frame_ns;           // thời điểm khung gần nhất lên màn hình
+    uint64_t last_call_ns;            // thời điểm display_buffer()/present() trước trả về
+} ssd1306_metrics_t;
+
+static inline uint64_t ssd1306_metrics_now(void) {
+#ifdef SSD1306_NO_METRICS
+    return 0;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static inline void ssd1306_hist_add(ssd1306_hist_t *h, uint64_t v) {
+#ifndef SSD1306_NO_METRICS
+    int i = v ? 64 - __builtin_clzll(v) : 0;
+    h->buckets[i < SSD1306_HIST_BUCKETS ? i : SSD1306_HIST_BUCKETS - 1]++;
+    h->count++;
+    h->sum += v;
+    if (v > h->max) h->max = v;
+#else
+    (void)h;
+    (void)v;
+#endif
+}
+
+// Giá trị mà tỷ lệ q (0..1) số mẫu không vượt quá (cận trên của bucket, không quá max)
+uint64_t ssd1306_hist_percentile(const ssd1306_hist_t *h, double q);
+
+// Khung/giây theo trung bình trượt của khoảng cách khung, 0 nếu chưa đủ hai khung
+double ssd1306_metrics_fps(const ssd1306_metrics_t *m);
+
+#endif // SSD1306_METRICS_H
@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>         // For getopt()
+#include <signal.h>         // For SIGUSR1
+
+#include "ssd1306_c_driver.h"
+#include "ssd1306_anim.h"
+
+// =========================================================================
+// Phát chuỗi khung từ file lên SSD1306
+// Cách dùng: ./ssd1306_player [-t backend] [-b bus_hz] [-f fps] [-l vòng] [-r WxH:bpp] [-T ngưỡng] [-d dither] [-a] [-M ms] [-R trace] file
+//   file       : chuỗi PBM (P4) / PGM (P5) nối liền, hoặc raw khi có -r (ví dụ -r 128x64:8)
+//   -l 0       : lặp mãi
+//   -T         : ngưỡng cho ảnh 8 bit (mặc định maxval/2 của PGM, 127 cho raw)
+//   -d         : ảnh 8 bit: threshold (mặc định), bayer, floyd, atkinson
+//   -a         : gửi bằng luồng flush nền (present) thay vì flush đồng bộ
+//   -M         : in bộ đo (JSON Lines, stderr) mỗi ms mili giây; luôn in khi nhận SIGUSR1 và khi kết thúc
+//   -R         : ghi vết mọi giao dịch I2C (kể cả init) vào file để phát lại bằng ssd1306_replay
+// Ví dụ tạo file: ffmpeg -i clip.mp4 -vf scale=128:64 -f image2pipe -vcodec pgm - > clip.pgm
+// =========================================================================
+
+int main(int argc, char *argv[]) {
+    const char *backend = "auto", *trace = NULL;
+    uint32_t bus_hz = SSD1306_BUS_400KHZ;
+    double fps = 30.0;
+    int loops = 1, raw_w = 0, raw_h = 0, raw_bpp = 0, threshold = -1, async = 0;
+    int dither = SSD1306_DITHER_THRESHOLD, metrics_ms = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:b:f:l:r:T:d:aM:R:")) != -1) {
+        switch (opt) {
+        case 't': backend = optarg; break;
+        case 'b': bus_hz = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'f': fps = atof(optarg); break;
+        case 'l': loops = atoi(optarg); break;
+        case 'r':
+            if (sscanf(optarg, "%dx%d:%d", &raw_w, &raw_h, &raw_bpp) != 3) {
+                fprintf(stderr, "Error: -r expects WxH:bpp, e.g. 128x64:1\n");
+                return 1;
+            }
+            break;
+        case 'T': threshold = atoi(optarg); break;
+        case 'd':
+            if (strcmp(optarg, "threshold") == 0) dither = SSD1306_DITHER_THRESHOLD;
+            else if (strcmp(optarg, "bayer") == 0) dither = SSD1306_DITHER_BAYER;
+            else if (strcmp(optarg, "floyd") == 0) dither = SSD1306_DITHER_FLOYD;
+            else if (strcmp(optarg, "atkinson") == 0) dither = SSD1306_DITHER_ATKINSON;
+            else {
+                fprintf(stderr, "Error: unknown dither '%s' (threshold, bayer, floyd, atkinson).\n", optarg);
+                return 1;
+            }
+            break;
+        case 'a': async = 1; break;
+        case 'M': metrics_ms = atoi(optarg); break;
+        case 'R': trace = optarg; break;
+        default:
+            fprintf(stderr, "Usage: %s [-t auto|dev|rdwr|smbus|mem] [-b bus_hz] [-f fps] [-l loops] "
+                            "[-r WxH:bpp] [-T threshold] [-d dither] [-a] [-M ms] [-R trace] file\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc || fps <= 0) {
+        fprintf(stderr, "Error: missing frame file or invalid fps.\n");
+        return 1;
+    }
+
+    ssd1306_frames_t frames;
+    int rc = raw_bpp ? ssd1306_frames_open_raw(&frames, argv[optind], raw_w, raw_h, raw_bpp)
+                     : ssd1306_frames_open(&frames, argv[optind]);
+    if (rc != 0) {
+        return 1;
+    }
+    if (threshold >= 0) {
+        frames.threshold = (uint8_t)threshold;
+    }
+    frames.dither = dither;
+    printf("%s: %zu frames %dx%d, %d bpp\n", argv[optind], frames.frame_count,
+           frames.width, frames.height, frames.bpp);
+
+    ssd1306_bus_t *bus = ssd1306_bus_open(backend, I2C_BUS_PATH, bus_hz);
+    if (bus == NULL) {
+        ssd1306_frames_close(&frames);
+        return 1;
+    }
+    bus->t.mem.realtime = 1; // bus mô phỏng chiếm đúng thời gian như bus thật để thấy khung bị bỏ
+    if (trace != NULL && ssd1306_trace_start(&bus->t, trace) != 0) {
+        ssd1306_bus_close(bus);
+        ssd1306_frames_close(&frames);
+        return 1;
+    }
+
+    ssd1306_t *dev = ssd1306_open(bus, SSD1306_I2C_ADDR);
+    if (dev == NULL || ssd1306_init(dev) != 0 || ssd1306_display_buffer_full(dev) < 0 ||
+        (async && ssd1306_bus_start_flusher(bus) != 0)) {
+        fprintf(stderr, "Failed to initialize SSD1306.\n");
+        ssd1306_bus_close(bus);
+        ssd1306_frames_close(&frames);
+        return 1;
+    }
+
+    if (ssd1306_metrics_start_reporter(&bus, 1, stderr, metrics_ms, SIGUSR1) != 0) {
+        fprintf(stderr, "Failed to start metrics reporter.\n");
+        ssd1306_bus_close(bus);
+        ssd1306_frames_close(&frames);
+        return 1;
+    }
+    ssd1306_play_stats_t st;
+    rc = ssd1306_anim_play(dev, &frames, fps, loops, &st);
+    if (async) {
+        ssd1306_bus_stop_flusher(bus);
+    }
+    ssd1306_metrics_stop_reporter();
+    ssd1306_metrics_print(bus, stderr);
+
+    printf("shown %llu, skipped %llu, %.1f changed bytes/frame, convert %.2f us/frame, max late %.2f ms\n",
+           (unsigned long long)st.shown, (unsigned long long)st.skipped,
+           st.shown ? (double)st.changed_bytes / st.shown : 0.0,
+           st.shown ? st.convert_ns / 1e3 / st.shown : 0.0, st.max_late_ns / 1e6);
+
+    ssd1306_bus_close(bus);
+    ssd1306_frames_close(&frames);
+    return rc == 0 ? 0 : 1;
+}
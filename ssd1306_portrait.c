@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ssd1306_portrait.h"
+
+// =========================================================================
+// Khung logic
+// =========================================================================
+
+int ssd1306_portrait_init(ssd1306_portrait_t *p, ssd1306_t *dev, int rotation) {
+    if (p == NULL || dev == NULL || (rotation != SSD1306_ROTATE_90 && rotation != SSD1306_ROTATE_270)) {
+        fprintf(stderr, "Error: Invalid portrait arguments (rotation must be 90 or 270).\n");
+        return -1;
+    }
+    int orientation = rotation == SSD1306_ROTATE_90 ? SSD1306_ORIENT_0 : SSD1306_ORIENT_180;
+    if (ssd1306_set_orientation(dev, orientation) != 0) {
+        return -1;
+    }
+    p->dev = dev;
+    p->rotation = rotation;
+    p->width = dev->height;
+    p->height = dev->width;
+    ssd1306_portrait_clear(p);
+    return 0;
+}
+
+// Đánh dấu các ô chứa cột [x0, x1] của các trang [page0, page1] (đã cắt theo khung)
+static void portrait_mark(ssd1306_portrait_t *p, int x0, int x1, int page0, int page1) {
+    uint8_t tiles = (uint8_t)((0xFFu << (x0 >> 3)) & (0xFFu >> (7 - (x1 >> 3))));
+    for (int page = page0; page <= page1; ++page) {
+        p->dirty_tiles[page] |= tiles;
+    }
+}
+
+void ssd1306_portrait_mark_dirty(ssd1306_portrait_t *p, int x, int y, int w, int h) {
+    int x1 = x + w - 1, y1 = y + h - 1;
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x1 >= p->width) x1 = p->width - 1;
+    if (y1 >= p->height) y1 = p->height - 1;
+    if (x > x1 || y > y1) return;
+    portrait_mark(p, x, x1, y >> 3, y1 >> 3);
+}
+
+void ssd1306_portrait_clear(ssd1306_portrait_t *p) {
+    memset(p->buffer, 0, sizeof(p->buffer));
+    portrait_mark(p, 0, p->width - 1, 0, p->height / 8 - 1);
+}
+
+// Trộn bits vào các bit mask của byte (page, x)
+static inline void portrait_put(ssd1306_portrait_t *p, int page, int x, uint8_t bits, uint8_t mask, int mode) {
+    uint8_t *d = &p->buffer[page * SSD1306_PORTRAIT_WIDTH + x];
+    switch (mode) {
+    case SSD1306_BLIT_OR:  *d |= bits & mask; break;
+    case SSD1306_BLIT_AND: *d &= bits | (uint8_t)~mask; break;
+    case SSD1306_BLIT_XOR: *d ^= bits & mask; break;
+    default:               *d = (*d & (uint8_t)~mask) | (bits & mask); break;
+    }
+}
+
+// =========================================================================
+// Vẽ
+// =========================================================================
+
+void ssd1306_portrait_fill_rect(ssd1306_portrait_t *p, int x, int y, int w, int h, int color) {
+    int x1 = x + w - 1, y1 = y + h - 1;
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x1 >= p->width) x1 = p->width - 1;
+    if (y1 >= p->height) y1 = p->height - 1;
+    if (x > x1 || y > y1) return;
+
+    // BLACK = COPY 0, WHITE = COPY 1, INVERT = XOR 1 trên các hàng của hình chữ nhật
+    uint8_t bits = color == SSD1306_COLOR_BLACK ? 0x00 : 0xFF;
+    int mode = color == SSD1306_COLOR_INVERT ? SSD1306_BLIT_XOR : SSD1306_BLIT_COPY;
+    for (int page = y >> 3; page <= y1 >> 3; ++page) {
+        int r0 = page * 8 > y ? 0 : y & 7;
+        int r1 = page * 8 + 7 < y1 ? 7 : y1 & 7;
+        uint8_t mask = (uint8_t)((0xFFu << r0) & (0xFFu >> (7 - r1)));
+        for (int c = x; c <= x1; ++c) {
+            portrait_put(p, page, c, bits, mask, mode);
+        }
+    }
+    portrait_mark(p, x, x1, y >> 3, y1 >> 3);
+}
+
+void ssd1306_portrait_draw_pixel(ssd1306_portrait_t *p, int x, int y, int color) {
+    ssd1306_portrait_fill_rect(p, x, y, 1, 1, color);
+}
+
+void ssd1306_portrait_blit(ssd1306_portrait_t *p, const uint8_t *bitmap, int bw, int bh, int x, int y, int mode) {
+    int c0 = x < 0 ? -x : 0;
+    int c1 = x + bw > p->width ? p->width - x : bw;
+    if (c0 >= c1 || bh <= 0 || y >= p->height || y + bh <= 0) return;
+
+    for (int sp = 0; sp * 8 < bh; ++sp) {
+        uint8_t valid = bh - sp * 8 >= 8 ? 0xFF : (uint8_t)((1u << (bh - sp * 8)) - 1);
+        int y0 = y + sp * 8;
+        int shift = y0 & 7;
+        int page = (y0 - shift) / 8;
+        const uint8_t *src = bitmap + sp * bw;
+        for (int c = c0; c < c1; ++c) {
+            uint8_t b = src[c] & valid;
+            if (page >= 0 && page < p->height / 8) {
+                portrait_put(p, page, x + c, (uint8_t)(b << shift), (uint8_t)(valid << shift), mode);
+            }
+            if (shift != 0 && page + 1 >= 0 && page + 1 < p->height / 8) {
+                portrait_put(p, page + 1, x + c, (uint8_t)(b >> (8 - shift)), (uint8_t)(valid >> (8 - shift)), mode);
+            }
+        }
+    }
+    ssd1306_portrait_mark_dirty(p, x + c0, y, c1 - c0, bh);
+}
+
+// Như ssd1306_draw_string(): với SSD1306_BLIT_COPY nền của cả dòng được xóa trước
+int ssd1306_portrait_draw_string(ssd1306_portrait_t *p, const ssd1306_font_t *font, int x, int y,
+                                 const char *str, int mode) {
+    int advance = ssd1306_font_advance(font);
+    if (mode == SSD1306_BLIT_COPY) {
+        int w = ssd1306_text_width(font, str);
+        ssd1306_portrait_fill_rect(p, x, y, w, font->height, SSD1306_COLOR_BLACK);
+        mode = SSD1306_BLIT_OR;
+    }
+    while (*str) {
+        uint32_t cp = ssd1306_next_codepoint(&str);
+        if (x < p->width && x + font->width > 0) {
+            ssd1306_portrait_blit(p, ssd1306_font_glyph(font, cp), font->width, font->height, x, y, mode);
+        }
+        x += advance;
+    }
+    return x;
+}
+
+// =========================================================================
+// Chuyển sang bố cục vật lý
+// =========================================================================
+
+// Điểm logic (x, y) nằm ở điểm vật lý (y, dev->height - 1 - x): ô t của trang logic lp là
+// ô (cột 8 * lp, trang dev->pages - 1 - t) và byte vật lý j có bit c = bit j của byte
+// logic 7 - c. Đảo thứ tự byte rồi chuyển vị bit 8x8 là ra đúng ô vật lý.
+static inline uint64_t portrait_tile(const uint8_t *src) {
+    uint64_t v;
+    memcpy(&v, src, 8);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    v = __builtin_bswap64(v); // big-endian: đọc theo bộ nhớ đã là thứ tự đảo
+#endif
+    v = ssd1306_transpose8x8(v);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v); // byte j (bit 8j) về vị trí j trong bộ nhớ
+#endif
+    return v;
+}
+
+int ssd1306_portrait_convert(ssd1306_portrait_t *p) {
+    ssd1306_t *dev = p->dev;
+    int converted = 0;
+
+    for (int lp = 0; lp < p->height / 8; ++lp) {
+        unsigned tiles = p->dirty_tiles[lp];
+        p->dirty_tiles[lp] = 0;
+        int px = lp * 8;
+        while (tiles) {
+            int t = __builtin_ctz(tiles);
+            tiles &= tiles - 1;
+            converted++;
+
+            int pp = dev->pages - 1 - t;
+            uint8_t *dst = dev->display_buffer + pp * SSD1306_WIDTH + px;
+            uint64_t v = portrait_tile(p->buffer + lp * SSD1306_PORTRAIT_WIDTH + t * 8), old;
+            memcpy(&old, dst, 8);
+            uint64_t d = old ^ v;
+            if (d == 0) continue;
+            memcpy(dst, &v, 8);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            d = __builtin_bswap64(d); // byte thứ i trong bộ nhớ về bit 8i
+#endif
+            // Chỉ các cột có byte đổi bị đánh dấu bẩn
+            d |= d >> 4;
+            d |= d >> 2;
+            d |= d >> 1;
+            d &= 0x0101010101010101ULL;
+            dev->dirty_cols[pp][px >> 6] |= ((d * 0x0102040810204080ULL) >> 56) << (px & 63);
+        }
+    }
+    return converted;
+}
+
+int ssd1306_portrait_update(ssd1306_portrait_t *p) {
+    ssd1306_portrait_convert(p);
+    if (atomic_load(&p->dev->bus->flusher_running)) {
+        return ssd1306_present(p->dev);
+    }
+    return ssd1306_display_buffer(p->dev);
+}
@@ -0,0 +1,56 @@
+#ifndef SSD1306_PORTRAIT_H
+#define SSD1306_PORTRAIT_H
+
+#include <stdint.h>
+
+#include "ssd1306_c_driver.h"
+
+// =========================================================================
+// Vẽ dọc (panel gắn xoay 90/270 độ)
+// Bên vẽ làm việc trên khung logic dev->height x dev->width (64 x 128 với panel 128x64), cùng
+// bố cục trang với display_buffer: buffer[page * SSD1306_PORTRAIT_WIDTH + x]. Mỗi ô 8x8 (8 cột của
+// một trang) của khung logic là đúng một ô 8x8 của khung vật lý, đã chuyển vị: update() chỉ
+// đổi các ô bẩn, mỗi ô một phép chuyển vị bit 8x8 trên một từ 64-bit, và chỉ đánh dấu bẩn
+// các cột vật lý thật sự đổi.
+// 270 độ là 90 độ cộng lật 180 độ bằng remap/hướng quét COM (ssd1306_set_orientation), nên
+// hai chiều dùng chung một phép chuyển và không tốn thêm gì mỗi khung.
+// =========================================================================
+
+// Kích thước tối đa của khung logic (panel 128x64); hàng trang của buffer luôn dài
+// SSD1306_PORTRAIT_WIDTH byte, panel nhỏ hơn chỉ dùng p->width x p->height đầu
+#define SSD1306_PORTRAIT_WIDTH   SSD1306_HEIGHT         // 64
+#define SSD1306_PORTRAIT_HEIGHT  SSD1306_WIDTH          // 128
+#define SSD1306_PORTRAIT_PAGES   (SSD1306_WIDTH / 8)    // 16
+#define SSD1306_PORTRAIT_TILES   (SSD1306_HEIGHT / 8)   // số ô 8x8 trên một trang logic
+
+// Chiều xoay: đỉnh của khung logic nằm ở cạnh trái (90) hoặc cạnh phải (270) của panel
+#define SSD1306_ROTATE_90        90
+#define SSD1306_ROTATE_270       270
+
+typedef struct {
+    ssd1306_t *dev;
+    int rotation;
+    int width, height;      // khung logic: dev->height x dev->width
+    uint8_t buffer[SSD1306_BUFFER_SIZE];
+    uint8_t dirty_tiles[SSD1306_PORTRAIT_PAGES]; // bit t: ô (trang, cột 8t..8t+7) đổi từ lần update trước
+} ssd1306_portrait_t;
+
+// Gắn khung dọc vào màn hình, đặt hướng panel theo rotation và xóa khung. Trả về 0/-1.
+int ssd1306_portrait_init(ssd1306_portrait_t *p, ssd1306_t *dev, int rotation);
+
+// Vẽ trên khung logic (tọa độ dọc, cắt theo khung); màu/chế độ như các hàm của driver
+void ssd1306_portrait_clear(ssd1306_portrait_t *p);
+void ssd1306_portrait_draw_pixel(ssd1306_portrait_t *p, int x, int y, int color);
+void ssd1306_portrait_fill_rect(ssd1306_portrait_t *p, int x, int y, int w, int h, int color);
+void ssd1306_portrait_blit(ssd1306_portrait_t *p, const uint8_t *bitmap, int bw, int bh, int x, int y, int mode);
+int ssd1306_portrait_draw_string(ssd1306_portrait_t *p, const ssd1306_font_t *font, int x, int y,
+                                 const char *str, int mode);
+// Báo vùng đã sửa khi ghi thẳng vào p->buffer
+void ssd1306_portrait_mark_dirty(ssd1306_portrait_t *p, int x, int y, int w, int h);
+
+// Chuyển các ô bẩn vào display_buffer. Trả về số ô đã chuyển.
+int ssd1306_portrait_convert(ssd1306_portrait_t *p);
+// Chuyển rồi gửi. Trả về như ssd1306_display_buffer() (0 khi đã present() cho luồng flush nền).
+int ssd1306_portrait_update(ssd1306_portrait_t *p);
+
+#endif // SSD1306_PORTRAIT_H
@@ -0,0 +1,185 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>           // For clock_nanosleep()
+#include <unistd.h>         // For getopt()
+
+#include "ssd1306_c_driver.h"
+#include "ssd1306_emu.h"
+
+// =========================================================================
+// Phát lại vết I2C đã ghi (player -R, hoặc SSD1306_TRACE=file với mọi chương trình)
+// Cách dùng: ./ssd1306_replay [-t backend] [-p path] [-b bus_hz] [-T] [-l vòng] [-e prefix] trace
+//   -t         : mem (mặc định), dev, rdwr, smbus, auto
+//   -T         : giữ nhịp thời gian gốc thay vì gửi nhanh nhất có thể
+//   -l 0       : lặp mãi
+//   -e prefix  : (mem) gắn bộ mô phỏng cho mỗi địa chỉ trong vết, ghi ảnh cuối ra prefix-<addr>.pbm
+// Kết quả: một dòng JSON trên stdout, cùng kiểu với ssd1306_bench, để so hai phiên bản
+// driver/transport trên cùng một lưu lượng.
+// =========================================================================
+
+#define REPLAY_MAX_EMUS          4
+
+typedef struct {
+    uint64_t txns, bytes, errors;
+    uint64_t recorded_errors;  // giao dịch đã thất bại lúc ghi
+    uint64_t trace_ns;         // độ dài vết gốc (một vòng)
+    uint64_t wall_ns;
+    uint64_t bus_ns;           // mem: thời gian bus mô phỏng
+    uint64_t max_late_ns;      // -T: trễ lớn nhất so với nhịp gốc
+    ssd1306_hist_t write_ns;   // ssd1306_transport_write() khi phát lại
+    ssd1306_hist_t recorded_ns; // ssd1306_transport_write() lúc ghi
+} replay_stats_t;
+
+static uint64_t replay_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void replay_sleep_until(uint64_t ns) {
+    struct timespec ts = { (time_t)(ns / 1000000000ULL), (long)(ns % 1000000000ULL) };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+// Đọc lướt cả vết: các địa chỉ slave và độ dài vết. Trả về số địa chỉ, -1 nếu vết hỏng.
+static int replay_scan(ssd1306_trace_reader_t *r, uint16_t *addrs, int max, uint64_t *span_ns) {
+    ssd1306_trace_rec_t rec;
+    int n = 0, got;
+    *span_ns = 0;
+    while ((got = ssd1306_trace_next(r, &rec)) == 1) {
+        int known = 0;
+        for (int i = 0; i < n; ++i) known |= addrs[i] == rec.addr;
+        if (!known && n < max) addrs[n++] = rec.addr;
+        *span_ns = rec.start_ns + rec.write_ns;
+    }
+    return got < 0 || ssd1306_trace_rewind(r) != 0 ? -1 : n;
+}
+
+static int replay_pass(ssd1306_transport_t *t, ssd1306_trace_reader_t *r, int timed,
+                       uint64_t base_ns, replay_stats_t *st) {
+    ssd1306_trace_rec_t rec;
+    int got;
+    while ((got = ssd1306_trace_next(r, &rec)) == 1) {
+        if (timed) {
+            uint64_t due = base_ns + rec.start_ns, now = replay_now();
+            if (now < due) replay_sleep_until(due);
+            else if (now - due > st->max_late_ns) st->max_late_ns = now - due;
+        }
+        if (rec.err != 0) st->recorded_errors++;
+        ssd1306_hist_add(&st->recorded_ns, rec.write_ns);
+
+        uint64_t t0 = replay_now();
+        if (ssd1306_transport_set_addr(t, rec.addr) != 0 || ssd1306_transport_write(t, rec.data, rec.len) != 0) {
+            st->errors++;
+        }
+        ssd1306_hist_add(&st->write_ns, replay_now() - t0);
+        st->txns++;
+        st->bytes += rec.len;
+    }
+    return got < 0 || ssd1306_trace_rewind(r) != 0 ? -1 : 0;
+}
+
+static void replay_print(FILE *out, const char *path, const ssd1306_transport_t *t, uint32_t bus_hz,
+                         int timed, int loops, const replay_stats_t *st) {
+    double wall_s = st->wall_ns / 1e9;
+    fprintf(out, "{\"replay\":\"%s\",\"backend\":\"%s\",\"bus_hz\":%u,\"mode\":\"%s\",\"loops\":%d,"
+                 "\"txns\":%llu,\"bytes\":%llu,\"errors\":%llu,\"recorded_errors\":%llu,"
+                 "\"trace_ms\":%.3f,\"wall_ms\":%.3f,\"bus_ms\":%.3f,\"syscalls\":%llu,\"split_txns\":%llu,"
+                 "\"txns_per_s\":%.0f,\"kbytes_per_s\":%.1f,\"write_p50_us\":%.2f,\"write_p99_us\":%.2f,"
+                 "\"recorded_p50_us\":%.2f,\"recorded_p99_us\":%.2f,\"max_late_us\":%.2f}\n",
+            path, t->ops->name, bus_hz, timed ? "timed" : "fast", loops,
+            (unsigned long long)st->txns, (unsigned long long)st->bytes, (unsigned long long)st->errors,
+            (unsigned long long)st->recorded_errors, st->trace_ns / 1e6, st->wall_ns / 1e6,
+            st->bus_ns / 1e6, (unsigned long long)t->metrics.syscalls,
+            (unsigned long long)t->split_txns,
+            wall_s > 0 ? st->txns / wall_s : 0.0, wall_s > 0 ? st->bytes / wall_s / 1e3 : 0.0,
+            ssd1306_hist_percentile(&st->write_ns, 0.5) / 1e3, ssd1306_hist_percentile(&st->write_ns, 0.99) / 1e3,
+            ssd1306_hist_percentile(&st->recorded_ns, 0.5) / 1e3,
+            ssd1306_hist_percentile(&st->recorded_ns, 0.99) / 1e3, st->max_late_ns / 1e3);
+}
+
+int main(int argc, char *argv[]) {
+    const char *backend = "mem", *path = I2C_BUS_PATH, *emu_prefix = NULL;
+    uint32_t bus_hz = SSD1306_BUS_400KHZ;
+    int timed = 0, loops = 1, opt;
+
+    while ((opt = getopt(argc, argv, "t:p:b:Tl:e:")) != -1) {
+        switch (opt) {
+        case 't': backend = optarg; break;
+        case 'p': path = optarg; break;
+        case 'b': bus_hz = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'T': timed = 1; break;
+        case 'l': loops = atoi(optarg); break;
+        case 'e': emu_prefix = optarg; break;
+        default:
+            fprintf(stderr, "Usage: %s [-t mem|auto|dev|rdwr|smbus] [-p path] [-b bus_hz] [-T] [-l loops] "
+                            "[-e prefix] trace\n", argv[0]);
+            return 2;
+        }
+    }
+    if (optind >= argc || loops < 0) {
+        fprintf(stderr, "Error: missing trace file or invalid loop count.\n");
+        return 2;
+    }
+    if (emu_prefix != NULL && strcmp(backend, "mem") != 0) {
+        fprintf(stderr, "Error: -e needs the mem transport.\n");
+        return 2;
+    }
+
+    ssd1306_trace_reader_t r;
+    if (ssd1306_trace_open(&r, argv[optind]) != 0) {
+        return 1;
+    }
+    replay_stats_t st;
+    memset(&st, 0, sizeof(st));
+    uint16_t addrs[REPLAY_MAX_EMUS];
+    int addr_count = replay_scan(&r, addrs, REPLAY_MAX_EMUS, &st.trace_ns);
+    if (addr_count < 0) {
+        ssd1306_trace_close(&r);
+        return 1;
+    }
+
+    ssd1306_transport_t t;
+    if (ssd1306_transport_open_by_name(&t, backend, path, addr_count > 0 ? addrs[0] : SSD1306_I2C_ADDR,
+                                       bus_hz) != 0) {
+        ssd1306_trace_close(&r);
+        return 1;
+    }
+    // Trace không ghi loại panel: tấm kính của bộ mô phỏng theo panel mặc định (SSD1306_PANEL)
+    static ssd1306_emu_t emus[REPLAY_MAX_EMUS];
+    const ssd1306_panel_t *panel = ssd1306_default_panel();
+    for (int i = 0; emu_prefix != NULL && i < addr_count; ++i) {
+        ssd1306_emu_init(&emus[i], addrs[i], panel->width, panel->height, panel->col_offset);
+        ssd1306_emu_attach(&emus[i], &t);
+    }
+
+    int rc = 0;
+    uint64_t start = replay_now();
+    for (int loop = 0; rc == 0 && (loops == 0 || loop < loops); ++loop) {
+        rc = replay_pass(&t, &r, timed, start + loop * st.trace_ns, &st);
+        // Log của bus mem chỉ cần cho bộ mô phỏng (đã nhận qua endpoint): không giữ qua các vòng
+        st.bus_ns += t.mem.bus_time_ns;
+        ssd1306_mem_reset(&t);
+    }
+    st.wall_ns = replay_now() - start;
+
+    if (rc == 0) {
+        replay_print(stdout, argv[optind], &t, bus_hz, timed, loops, &st);
+    }
+    for (int i = 0; emu_prefix != NULL && i < addr_count; ++i) {
+        char out[256];
+        snprintf(out, sizeof(out), "%s-%02x.pbm", emu_prefix, addrs[i]);
+        if (emus[i].protocol_errors != 0) {
+            fprintf(stderr, "Emulator 0x%02X: %llu protocol errors.\n", addrs[i],
+                    (unsigned long long)emus[i].protocol_errors);
+        }
+        if (ssd1306_emu_write_pbm(&emus[i], out) != 0) rc = -1;
+    }
+    ssd1306_transport_close(&t);
+    ssd1306_trace_close(&r);
+    return rc == 0 ? 0 : 1;
+}
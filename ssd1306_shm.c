@@ -0,0 +1,257 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>         // For kill(pid, 0)
+#include <time.h>
+#include <fcntl.h>          // For O_CREAT, O_RDWR
+#include <unistd.h>         // For ftruncate(), getpid(), syscall()
+#include <sys/mman.h>       // For shm_open(), mmap()
+#include <sys/syscall.h>    // For SYS_futex
+#include <linux/futex.h>    // For FUTEX_WAIT, FUTEX_WAKE
+
+#include "ssd1306_shm.h"
+
+// =========================================================================
+// Tạo và gắn vùng nhớ chung
+// =========================================================================
+
+static int shm_pid_alive(int pid) {
+    return pid > 0 && (kill(pid, 0) == 0 || errno != ESRCH);
+}
+
+static ssd1306_shm_t *shm_map(int fd) {
+    void *p = mmap(NULL, sizeof(ssd1306_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        perror("Failed to map shared framebuffer");
+        return NULL;
+    }
+    return p;
+}
+
+ssd1306_shm_t *ssd1306_shm_create(const char *name, int width, int height) {
+    if (width <= 0 || width > SSD1306_WIDTH || height <= 0 || height > SSD1306_HEIGHT) {
+        fprintf(stderr, "Error: Invalid shared framebuffer size %dx%d.\n", width, height);
+        return NULL;
+    }
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0660);
+    if (fd < 0) {
+        perror("Failed to create shared framebuffer");
+        return NULL;
+    }
+    if (ftruncate(fd, sizeof(ssd1306_shm_t)) != 0) {
+        perror("Failed to size shared framebuffer");
+        close(fd);
+        return NULL;
+    }
+    ssd1306_shm_t *shm = shm_map(fd);
+    if (shm == NULL) return NULL;
+    // Daemon khác có thể đang khai báo vùng (magic còn 0): nhận ra nó qua version và pid
+    if ((atomic_load(&shm->magic) == SSD1306_SHM_MAGIC || shm->version == SSD1306_SHM_VERSION) &&
+        shm->daemon_pid != 0 && shm->daemon_pid != getpid() && shm_pid_alive(shm->daemon_pid)) {
+        fprintf(stderr, "Error: %s is already served by daemon pid %d.\n", name, shm->daemon_pid);
+        munmap(shm, sizeof(*shm));
+        return NULL;
+    }
+
+    // Bản của daemon đã chết: khởi tạo lại, client đang gắn phải claim lại vùng của mình
+    memset(shm, 0, sizeof(*shm));
+    shm->version = SSD1306_SHM_VERSION;
+    shm->width = (uint16_t)width;
+    shm->height = (uint16_t)height;
+    shm->daemon_pid = getpid();
+    return shm;
+}
+
+void ssd1306_shm_publish(ssd1306_shm_t *shm) {
+    // Release: client thấy magic thì cũng thấy region_count, tên và vị trí các vùng
+    atomic_store_explicit(&shm->magic, SSD1306_SHM_MAGIC, memory_order_release);
+}
+
+int ssd1306_shm_add_region(ssd1306_shm_t *shm, const char *name, int x, int y, int w, int h) {
+    if (atomic_load(&shm->magic) == SSD1306_SHM_MAGIC) {
+        fprintf(stderr, "Error: Region %s must be added before the framebuffer is published.\n", name);
+        return -1;
+    }
+    if (shm->region_count == SSD1306_SHM_MAX_REGIONS || strlen(name) >= SSD1306_SHM_NAME_MAX ||
+        x < 0 || y < 0 || w <= 0 || h <= 0 || x + w > shm->width || y + h > shm->height ||
+        y % 8 != 0 || h % 8 != 0) {
+        fprintf(stderr, "Error: Invalid region %s %dx%d at (%d,%d) (y and h must be multiples of 8).\n",
+                name, w, h, x, y);
+        return -1;
+    }
+    for (int i = 0; i < shm->region_count; ++i) {
+        const ssd1306_shm_region_t *r = &shm->regions[i];
+        if (strcmp(r->name, name) == 0 ||
+            (x < r->x + r->w && r->x < x + w && y / 8 < r->page + r->pages && r->page < (y + h) / 8)) {
+            fprintf(stderr, "Error: Region %s overlaps or duplicates region %s.\n", name, r->name);
+            return -1;
+        }
+    }
+    ssd1306_shm_region_t *r = &shm->regions[shm->region_count];
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    r->x = (uint8_t)x;
+    r->w = (uint8_t)w;
+    r->page = (uint8_t)(y / 8);
+    r->pages = (uint8_t)(h / 8);
+    return shm->region_count++;
+}
+
+void ssd1306_shm_destroy(ssd1306_shm_t *shm, const char *name) {
+    if (shm == NULL) return;
+    atomic_store(&shm->magic, 0);
+    munmap(shm, sizeof(*shm));
+    shm_unlink(name);
+}
+
+ssd1306_shm_t *ssd1306_shm_attach(const char *name) {
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        perror("Failed to open shared framebuffer (is ssd1306_daemon running?)");
+        return NULL;
+    }
+    ssd1306_shm_t *shm = shm_map(fd);
+    if (shm == NULL) return NULL;
+    if (atomic_load_explicit(&shm->magic, memory_order_acquire) != SSD1306_SHM_MAGIC) {
+        fprintf(stderr, "Error: %s is not ready (daemon still starting or stopped).\n", name);
+        munmap(shm, sizeof(*shm));
+        return NULL;
+    }
+    if (shm->version != SSD1306_SHM_VERSION || shm->width > SSD1306_WIDTH || shm->height > SSD1306_HEIGHT) {
+        fprintf(stderr, "Error: %s is not a compatible SSD1306 framebuffer (%ux%u, version %u).\n",
+                name, shm->width, shm->height, shm->version);
+        munmap(shm, sizeof(*shm));
+        return NULL;
+    }
+    return shm;
+}
+
+void ssd1306_shm_detach(ssd1306_shm_t *shm) {
+    if (shm != NULL) munmap(shm, sizeof(*shm));
+}
+
+// =========================================================================
+// Client: giữ vùng và ghi
+// =========================================================================
+
+int ssd1306_shm_find(const ssd1306_shm_t *shm, const char *region) {
+    for (int i = 0; i < shm->region_count; ++i) {
+        if (strcmp(shm->regions[i].name, region) == 0) return i;
+    }
+    return -1;
+}
+
+int ssd1306_shm_claim(ssd1306_shm_t *shm, const char *region) {
+    int id = ssd1306_shm_find(shm, region);
+    if (id < 0) {
+        fprintf(stderr, "Error: No region named '%s'.\n", region);
+        return -1;
+    }
+    ssd1306_shm_region_t *r = &shm->regions[id];
+    int pid = getpid(), owner = 0;
+    while (!atomic_compare_exchange_strong(&r->owner, &owner, pid)) {
+        if (owner == pid) return id;
+        if (shm_pid_alive(owner)) {
+            fprintf(stderr, "Error: Region '%s' is held by pid %d.\n", region, owner);
+            return -1;
+        }
+        // Client cũ chết, có thể giữa begin() và end(): lấy vùng rồi đưa seq về chẵn
+        if (atomic_compare_exchange_strong(&r->owner, &owner, pid)) {
+            unsigned seq = atomic_load(&r->seq);
+            if (seq & 1) atomic_store(&r->seq, seq + 1);
+            return id;
+        }
+    }
+    return id;
+}
+
+void ssd1306_shm_release(ssd1306_shm_t *shm, int id) {
+    int pid = getpid();
+    atomic_compare_exchange_strong(&shm->regions[id].owner, &pid, 0);
+}
+
+uint8_t *ssd1306_shm_begin(ssd1306_shm_t *shm, int id) {
+    ssd1306_shm_region_t *r = &shm->regions[id];
+    atomic_fetch_add_explicit(&r->seq, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release); // seq lẻ phải thấy được trước mọi byte mới
+    return shm->frame + r->page * SSD1306_WIDTH + r->x;
+}
+
+static long shm_futex(atomic_uint *word, int op, unsigned val, const struct timespec *timeout) {
+    return syscall(SYS_futex, word, op, val, timeout, NULL, 0);
+}
+
+void ssd1306_shm_end(ssd1306_shm_t *shm, int id) {
+    ssd1306_shm_region_t *r = &shm->regions[id];
+    atomic_fetch_add_explicit(&r->seq, 1, memory_order_release);
+    atomic_store(&r->pending, 1);
+    atomic_fetch_add(&shm->wake, 1);
+    // Cặp với sleeping = 1 rồi đọc lại wake trong ssd1306_shm_wait(): hoặc client thấy
+    // daemon đang ngủ, hoặc daemon thấy wake đã đổi. Daemon đang chạy thì không tốn syscall.
+    if (atomic_load(&shm->sleeping)) {
+        shm_futex(&shm->wake, FUTEX_WAKE, 1, NULL);
+    }
+}
+
+void ssd1306_shm_write(ssd1306_shm_t *shm, int id, const uint8_t *bitmap) {
+    const ssd1306_shm_region_t *r = &shm->regions[id];
+    uint8_t *dst = ssd1306_shm_begin(shm, id);
+    for (int p = 0; p < r->pages; ++p) {
+        memcpy(dst + p * SSD1306_WIDTH, bitmap + p * r->w, r->w);
+    }
+    ssd1306_shm_end(shm, id);
+}
+
+// =========================================================================
+// Daemon: gom các vùng đã ghi
+// =========================================================================
+
+void ssd1306_shm_wait(ssd1306_shm_t *shm, unsigned seen, int timeout_ms) {
+    struct timespec ts = { timeout_ms / 1000, (long)(timeout_ms % 1000) * 1000000L };
+    atomic_store(&shm->sleeping, 1);
+    if (atomic_load(&shm->wake) == seen) {
+        shm_futex(&shm->wake, FUTEX_WAIT, seen, &ts); // EAGAIN/EINTR/ETIMEDOUT: người gọi xét lại
+    }
+    atomic_store(&shm->sleeping, 0);
+}
+
+int ssd1306_shm_collect(ssd1306_shm_t *shm, ssd1306_t *dev) {
+    uint8_t copy[SSD1306_BUFFER_SIZE];
+    int taken = 0;
+
+    for (int i = 0; i < shm->region_count; ++i) {
+        ssd1306_shm_region_t *r = &shm->regions[i];
+        if (!atomic_exchange(&r->pending, 0)) continue;
+
+        // Client đang ghi dở hoặc ghi chen trong lúc chép: end() của nó sẽ đặt lại pending
+        unsigned seq = atomic_load_explicit(&r->seq, memory_order_acquire);
+        if (seq & 1) continue;
+        for (int p = r->page; p < r->page + r->pages; ++p) {
+            memcpy(copy + p * SSD1306_WIDTH + r->x, shm->frame + p * SSD1306_WIDTH + r->x, r->w);
+        }
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&r->seq, memory_order_relaxed) != seq) continue;
+
+        for (int p = r->page; p < r->page + r->pages; ++p) {
+            const uint8_t *src = copy + p * SSD1306_WIDTH;
+            uint8_t *dst = dev->display_buffer + p * SSD1306_WIDTH;
+            int first = -1, last = -1;
+            for (int x = r->x; x < r->x + r->w; ++x) {
+                if (dst[x] != src[x]) {
+                    dst[x] = src[x];
+                    if (first < 0) first = x;
+                    last = x;
+                }
+            }
+            if (first >= 0) ssd1306_mark_dirty(dev, first, last, p, p);
+        }
+        taken++;
+    }
+    if (taken > 0) {
+        atomic_fetch_add(&shm->ticks, 1);
+        atomic_fetch_add(&shm->updates, (uint64_t)taken);
+    }
+    return taken;
+}
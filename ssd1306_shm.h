@@ -0,0 +1,86 @@
+#ifndef SSD1306_SHM_H
+#define SSD1306_SHM_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "ssd1306_c_driver.h"
+
+// =========================================================================
+// Khung hình dùng chung giữa các tiến trình (daemon ssd1306_daemon)
+// Một daemon giữ bus và màn hình; các tiến trình client chỉ ghi vào các vùng có tên của
+// một khung page-major trong POSIX shared memory, không bao giờ gọi syscall lên bus, nên
+// panel không bao giờ nhận các luồng giao dịch xen kẽ nhau.
+//
+// Mỗi vùng là một hình chữ nhật cột x trang (y, h là bội của 8): các vùng không chung byte
+// nào, nên mỗi vùng có đúng một client ghi (ssd1306_shm_claim) và không cần khóa:
+//   - client: begin() -> vẽ -> end(). seq của vùng lẻ trong lúc ghi (seqlock); end() đặt
+//     cờ pending, tăng bộ đếm wake và đánh thức daemon qua futex nếu daemon đang ngủ.
+//   - daemon: mỗi nhịp làm tươi lấy mọi vùng pending, chép ra khi seq chẵn và không đổi
+//     trong lúc chép (nếu không, end() kế tiếp sẽ báo lại), so với display_buffer để chỉ
+//     đánh dấu bẩn các byte đổi, rồi flush một lần cho mọi client.
+// =========================================================================
+
+#define SSD1306_SHM_NAME         "/ssd1306"
+#define SSD1306_SHM_MAGIC        0x53443133u // "SD13"
+#define SSD1306_SHM_VERSION      1
+#define SSD1306_SHM_MAX_REGIONS  16
+#define SSD1306_SHM_NAME_MAX     16
+
+_Static_assert(ATOMIC_INT_LOCK_FREE == 2, "shared-memory protocol needs lock-free atomic int");
+// ticks/updates là atomic 64-bit dùng chung giữa các tiến trình: bản có khóa sẽ giữ khóa
+// riêng trong mỗi tiến trình (libatomic) và không còn nguyên tử
+_Static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "shared-memory protocol needs lock-free 64-bit atomics");
+
+typedef struct {
+    char name[SSD1306_SHM_NAME_MAX];
+    uint8_t x, w;             // cột x .. x + w - 1
+    uint8_t page, pages;      // trang page .. page + pages - 1
+    atomic_uint seq;          // seqlock: lẻ khi client đang ghi
+    atomic_uint pending;      // client đã ghi xong, daemon chưa lấy
+    atomic_int owner;         // pid của client giữ vùng, 0: trống
+} ssd1306_shm_region_t;
+
+typedef struct {
+    atomic_uint magic;        // 0 tới khi ssd1306_shm_publish(): client chỉ gắn vào sau đó
+    uint32_t version;
+    uint16_t width, height;   // kích thước panel; hàng trang trong frame vẫn dài SSD1306_WIDTH
+    int32_t daemon_pid;
+    int region_count;         // chỉ daemon ghi, trước ssd1306_shm_publish()
+    atomic_uint wake;         // futex: client tăng sau mỗi end()
+    atomic_uint sleeping;     // daemon đang chờ trên wake
+    atomic_uint_fast64_t ticks;   // nhịp có ít nhất một vùng được cập nhật
+    atomic_uint_fast64_t updates; // số lần lấy vùng (nhiều vùng/nhịp gộp chung một flush)
+    ssd1306_shm_region_t regions[SSD1306_SHM_MAX_REGIONS];
+    uint8_t frame[SSD1306_BUFFER_SIZE];
+} ssd1306_shm_t;
+
+// Daemon: tạo (hoặc thay bản cũ của daemon đã chết) vùng nhớ chung cho panel width x height.
+// Client chưa gắn được cho tới ssd1306_shm_publish(). NULL nếu lỗi.
+ssd1306_shm_t *ssd1306_shm_create(const char *name, int width, int height);
+// Khai báo vùng, chỉ trước ssd1306_shm_publish(); y và h phải là bội của 8 và các vùng không
+// được chồng nhau. Trả về id/-1.
+int ssd1306_shm_add_region(ssd1306_shm_t *shm, const char *name, int x, int y, int w, int h);
+// Mở cho client gắn vào sau khi đã khai báo mọi vùng
+void ssd1306_shm_publish(ssd1306_shm_t *shm);
+void ssd1306_shm_destroy(ssd1306_shm_t *shm, const char *name);
+// Chép các vùng pending vào display_buffer, chỉ đánh dấu bẩn các byte đổi. Trả về số vùng đã lấy.
+int ssd1306_shm_collect(ssd1306_shm_t *shm, ssd1306_t *dev);
+// Ngủ tới khi wake khác seen hoặc hết timeout_ms
+void ssd1306_shm_wait(ssd1306_shm_t *shm, unsigned seen, int timeout_ms);
+
+// Client
+ssd1306_shm_t *ssd1306_shm_attach(const char *name);
+void ssd1306_shm_detach(ssd1306_shm_t *shm);
+int ssd1306_shm_find(const ssd1306_shm_t *shm, const char *region);
+// Giữ vùng để ghi (lấy lại được vùng của client đã chết). Trả về id/-1.
+int ssd1306_shm_claim(ssd1306_shm_t *shm, const char *region);
+void ssd1306_shm_release(ssd1306_shm_t *shm, int id);
+// Con trỏ tới byte (trang đầu, cột đầu) của vùng trong khung; hàng trang kế tiếp cách
+// SSD1306_WIDTH byte. Chỉ ghi trong vùng, và gọi end() sau khi ghi xong.
+uint8_t *ssd1306_shm_begin(ssd1306_shm_t *shm, int id);
+void ssd1306_shm_end(ssd1306_shm_t *shm, int id);
+// Thay cả vùng bằng bitmap w x (pages * 8), bố cục trang như ssd1306_blit()
+void ssd1306_shm_write(ssd1306_shm_t *shm, int id, const uint8_t *bitmap);
+
+#endif // SSD1306_SHM_H
@@ -2,140 +2,373 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
-#include <fcntl.h>
 #include <unistd.h>
-#include <sys/ioctl.h>
-#include <linux/i2c-dev.h>
+
+#include "ssd1306_transport.h"
+#include "ssd1306_c_driver.h"
+#include "ssd1306_portrait.h"
+#include "ssd1306_font.h" // Font 5x7 ASCII + Latin-1 dùng chung với ssd1306_c_driver.c
 
 #define I2C_DEV "/dev/i2c-1"
 #define SSD1306_ADDR 0x3C
 
-// Font 5x7 ASCII cho một số ký tự cần thiết
-uint8_t font5x7[][5] = {
-// ' ' 33
-{0x00,0x00,0x00,0x00,0x00}, // space
-// '1' 49
-{0x00,0x00,0x7F,0x00,0x00}, // '1'
-// '2' 50
-{0x62,0x51,0x49,0x49,0x46}, // '2'
-// '3' 51
-{0x22,0x41,0x49,0x49,0x36}, // '3'
-// '4' 52
-{0x18,0x14,0x12,0x7F,0x10}, // '4'
-// '5' 53
-{0x2F,0x49,0x49,0x49,0x31}, // '5'
-// 'H' 72
-{0x7F,0x08,0x08,0x08,0x7F}, // 'H'
+void demo_send_command(ssd1306_transport_t *fd, uint8_t cmd) {
+uint8_t buffer[2] = {0x00, cmd};
+ssd1306_transport_write(fd, buffer, 2);
+}
+
+void demo_send_data(ssd1306_transport_t *fd, uint8_t data) {
+uint8_t buffer[2] = {0x40, data};
+ssd1306_transport_write(fd, buffer, 2);
+}
+
+// Toàn bộ chuỗi khởi tạo trong một giao dịch I2C
+void demo_init(ssd1306_transport_t *fd) {
+static const uint8_t init_seq[] = {
+0xAE, // Display OFF
+0xA8, 0x3F,
+0xD3, 0x00,
+0x40,
+0xA1, 0xC8,
+0xDA, 0x12,
+0x81, 0x7F,
+0xA4, 0xA6,
+0xD5, 0x80,
+0x8D, 0x14,
+0xAF, // Display ON
 };
+ssd1306_batch_t b;
+ssd1306_batch_begin(&b, fd);
+ssd1306_batch_cmd(&b, init_seq, sizeof(init_seq));
+ssd1306_batch_flush(&b);
+}
 
-int get_font_index(char c) {
-switch(c) {
-case ' ': return 0;
-case '1': return 1;
-case '2': return 2;
-case '3': return 3;
-case '4': return 4;
-case '5': return 5;
-case 'H': return 6;
-default: return 0;
+// Mỗi trang: 3 lệnh đặt vị trí (Co = 1) + 128 byte 0 trong cùng một giao dịch
+void demo_clear(ssd1306_transport_t *fd) {
+ssd1306_batch_t b;
+ssd1306_batch_begin(&b, fd);
+for (int page = 0; page < 8; page++) {
+ssd1306_batch_cmd3(&b, 0xB0 + page, 0x00, 0x10); // Set page, lower column, higher column
+ssd1306_batch_fill(&b, 0x00, 128);
 }
+ssd1306_batch_flush(&b);
 }
 
-void ssd1306_send_command(int fd, uint8_t cmd) {
-uint8_t buffer[2] = {0x00, cmd};
-write(fd, buffer, 2);
+static void demo_batch_set_pos(ssd1306_batch_t *b, uint8_t page, uint8_t col) {
+ssd1306_batch_cmd3(b, 0xB0 + page, col & 0x0F, 0x10 | (col >> 4)); // Set page, lower col, higher col
 }
 
-void ssd1306_send_data(int fd, uint8_t data) {
-uint8_t buffer[2] = {0x40, data};
-write(fd, buffer, 2);
+static void demo_batch_glyph(ssd1306_batch_t *b, char c) {
+ssd1306_batch_data(b, ssd1306_font_glyph(&ssd1306_font_5x7, (uint8_t)c), 5);
+ssd1306_batch_fill(b, 0x00, 1); // space between chars
 }
 
-void ssd1306_init(int fd) {
-ssd1306_send_command(fd, 0xAE); // Display OFF
-ssd1306_send_command(fd, 0xA8); ssd1306_send_command(fd, 0x3F);
-ssd1306_send_command(fd, 0xD3); ssd1306_send_command(fd, 0x00);
-ssd1306_send_command(fd, 0x40);
-ssd1306_send_command(fd, 0xA1); ssd1306_send_command(fd, 0xC8);
-ssd1306_send_command(fd, 0xDA); ssd1306_send_command(fd, 0x12);
-ssd1306_send_command(fd, 0x81); ssd1306_send_command(fd, 0x7F);
-ssd1306_send_command(fd, 0xA4); ssd1306_send_command(fd, 0xA6);
-ssd1306_send_command(fd, 0xD5); ssd1306_send_command(fd, 0x80);
-ssd1306_send_command(fd, 0x8D); ssd1306_send_command(fd, 0x14);
-ssd1306_send_command(fd, 0xAF); // Display ON
+void demo_draw_char(ssd1306_transport_t *fd, uint8_t page, uint8_t col, char c) {
+ssd1306_batch_t b;
+ssd1306_batch_begin(&b, fd);
+demo_batch_set_pos(&b, page, col);
+demo_batch_glyph(&b, c);
+ssd1306_batch_flush(&b);
 }
 
-void ssd1306_clear(int fd) {
-for (int page = 0; page < 8; page++) {
-ssd1306_send_command(fd, 0xB0 + page); // Set page address
-ssd1306_send_command(fd, 0x00); // Set lower column
-ssd1306_send_command(fd, 0x10); // Set higher column
-for (int col = 0; col < 128; col++) {
-ssd1306_send_data(fd, 0x00);
+// Page Addressing Mode tự tăng cột, nên cả chuỗi là một luồng dữ liệu liền mạch
+void demo_draw_string(ssd1306_transport_t *fd, uint8_t page, uint8_t col, const char *str) {
+ssd1306_batch_t b;
+ssd1306_batch_begin(&b, fd);
+demo_batch_set_pos(&b, page, col);
+while (*str && col < 128 - 6) {
+demo_batch_glyph(&b, *str++);
+col += 6;
 }
+ssd1306_batch_flush(&b);
 }
+
+void demo_start_scroll_left(ssd1306_transport_t *fd, uint8_t start_page, uint8_t end_page) {
+const uint8_t cmds[] = {
+0x27, // Left horizontal scroll
+0x00, // Dummy
+start_page, // Start page
+0x00, // Scroll speed (frame interval)
+end_page, // End page
+0x00, // Dummy
+0xFF, // Dummy
+0x2F, // Activate scroll
+};
+ssd1306_batch_t b;
+ssd1306_batch_begin(&b, fd);
+ssd1306_batch_cmd(&b, cmds, sizeof(cmds));
+ssd1306_batch_flush(&b);
+}
+
+void demo_stop_scroll(ssd1306_transport_t *fd) {
+demo_send_command(fd, 0x2E);
 }
 
-void ssd1306_draw_char(int fd, uint8_t page, uint8_t col, char c) {
-int idx = get_font_index(c);
-ssd1306_send_command(fd, 0xB0 + page); // Set page
-ssd1306_send_command(fd, col & 0x0F); // Lower col
-ssd1306_send_command(fd, 0x10 | (col >> 4)); // Higher col
+// =========================================================================
+// Tự kiểm tra (./ssd1306_test selftest, make test): chạy trên bus giả, không cần phần cứng.
+// Byte mong đợi lấy thẳng từ datasheet, không từ hằng số của driver.
+// =========================================================================
 
+static int test_failures;
 
-for (int i = 0; i < 5; i++) {
-    ssd1306_send_data(fd, font5x7[idx][i]);
-}
-ssd1306_send_data(fd, 0x00); // space between chars
+#define TEST_CHECK(cond, ...) do {                                      \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "FAIL %s:%d: ", __func__, __LINE__);        \
+            fprintf(stderr, __VA_ARGS__);                               \
+            fputc('\n', stderr);                                        \
+            test_failures++;                                            \
+        }                                                               \
+    } while (0)
+
+// So giao dịch thứ i trên bus giả với want
+static void test_expect_txn(const ssd1306_transport_t *t, size_t i, const uint8_t *want, size_t len, const char *what) {
+    const ssd1306_mem_bus_t *m = &t->mem;
+    if (i >= m->txn_count) {
+        TEST_CHECK(0, "%s: transaction %zu missing (%zu sent)", what, i, m->txn_count);
+        return;
+    }
+    const ssd1306_mem_txn_t *txn = &m->txns[i];
+    TEST_CHECK(txn->len == len && memcmp(m->log + txn->offset, want, len) == 0,
+               "%s: transaction %zu has %u bytes, want %zu", what, i, txn->len, len);
 }
 
-void ssd1306_draw_string(int fd, uint8_t page, uint8_t col, const char *str) {
-while (*str && col < 128 - 6) {
-ssd1306_draw_char(fd, page, col, *str++);
-col += 6;
+// Màn hình 128x64 trên bus giả, đã khởi tạo và gửi khung trống; bus log rỗng
+static ssd1306_t *test_open(ssd1306_bus_t **bus, const char *panel) {
+    *bus = ssd1306_bus_open("mem", I2C_BUS_PATH, SSD1306_BUS_400KHZ);
+    if (*bus == NULL) return NULL;
+    ssd1306_t *dev = ssd1306_open(*bus, SSD1306_I2C_ADDR);
+    if (dev == NULL || ssd1306_set_panel(dev, ssd1306_panel_find(panel)) != 0 ||
+        ssd1306_init(dev) != 0 || ssd1306_display_buffer(dev) < 0) {
+        ssd1306_bus_close(*bus);
+        return NULL;
+    }
+    ssd1306_mem_reset(&(*bus)->t);
+    return dev;
 }
+
+// Datasheet 10.1.6 / 10.1.15: "Set Display Start Line" là 0x40 | n, "Set Display Offset" là
+// 0xD3 rồi một byte 0..63. COM0 hiện hàng RAM (start line + offset) % 64, nên pixel ở hàng
+// 0 của màn hình phải được ghi vào hàng RAM 8 + 16 = 24: trang 3, bit 0.
+static void test_scroll_datasheet_bytes(void) {
+    ssd1306_bus_t *bus;
+    ssd1306_t *dev = test_open(&bus, "128x64");
+    TEST_CHECK(dev != NULL, "open 128x64 on mem bus");
+    if (dev == NULL) return;
+    ssd1306_transport_t *t = &bus->t;
+
+    TEST_CHECK(ssd1306_set_start_line(dev, 8) == 0, "set start line 8");
+    test_expect_txn(t, 0, (const uint8_t[]){ 0x00, 0x48 }, 2, "start line 8");
+    TEST_CHECK(ssd1306_set_display_offset(dev, 16) == 0, "set display offset 16");
+    test_expect_txn(t, 1, (const uint8_t[]){ 0x00, 0xD3, 0x10 }, 3, "display offset 16");
+
+    ssd1306_mem_reset(t);
+    ssd1306_draw_pixel(dev, 0, 0, SSD1306_COLOR_WHITE);
+    TEST_CHECK(ssd1306_display_buffer(dev) > 0, "flush shifted pixel");
+    // Cửa sổ cột 0..0, trang 3..3 (0x21, 0x22 mã hóa Co = 1: 0x80), rồi control byte dữ liệu 0x40
+    static const uint8_t want[] = {
+        0x80, 0x21, 0x80, 0x00, 0x80, 0x00,
+        0x80, 0x22, 0x80, 0x03, 0x80, 0x03,
+        0x40, 0x01,
+    };
+    TEST_CHECK(t->mem.txn_count == 1, "shifted pixel: %zu transactions, want 1", t->mem.txn_count);
+    test_expect_txn(t, 0, want, sizeof(want), "shifted pixel");
+
+    ssd1306_bus_close(bus);
 }
 
-void ssd1306_start_scroll_left(int fd, uint8_t start_page, uint8_t end_page) {
-ssd1306_send_command(fd, 0x27); // Left horizontal scroll
-ssd1306_send_command(fd, 0x00); // Dummy
-ssd1306_send_command(fd, start_page); // Start page
-ssd1306_send_command(fd, 0x00); // Scroll speed (frame interval)
-ssd1306_send_command(fd, end_page); // End page
-ssd1306_send_command(fd, 0x00); // Dummy
-ssd1306_send_command(fd, 0xFF); // Dummy
-ssd1306_send_command(fd, 0x2F); // Activate scroll
+// Adapter mô phỏng giới hạn cả độ dài (33 byte, như ghi khối SMBus) lẫn số message mỗi lần
+// truyền (4): EOPNOTSUPP của cả lượt không được hiểu nhầm thành giới hạn số message, và
+// max_msgs chỉ hạ khi từng giao dịch đơn đều qua. Dữ liệu trên bus phải đủ và đúng thứ tự.
+static void test_transport_chunk_limits(void) {
+    ssd1306_transport_t t;
+    TEST_CHECK(ssd1306_transport_open_mem(&t, SSD1306_BUS_400KHZ) == 0, "open mem transport");
+    t.addr = SSD1306_I2C_ADDR;
+    t.mem.max_write = 33;
+    t.mem.max_msgs = 4;
+
+    uint8_t frame[1 + 512];
+    frame[0] = 0x40;
+    for (int round = 0; round < 6; ++round) {
+        for (size_t i = 1; i < sizeof(frame); ++i) frame[i] = (uint8_t)(i * 7 + round);
+        ssd1306_mem_reset(&t);
+        TEST_CHECK(ssd1306_transport_write(&t, frame, sizeof(frame)) == 0, "round %d: write %zu bytes", round, sizeof(frame));
+
+        // Mỗi giao dịch là một luồng dữ liệu 0x40 <= 33 byte; ghép lại đúng bằng payload
+        uint8_t got[sizeof(frame) - 1];
+        size_t got_len = 0;
+        for (size_t k = 0; k < t.mem.txn_count; ++k) {
+            const ssd1306_mem_txn_t *txn = &t.mem.txns[k];
+            const uint8_t *p = t.mem.log + txn->offset;
+            TEST_CHECK(txn->len >= 2 && txn->len <= 33 && p[0] == 0x40,
+                       "round %d: transaction %zu is %u bytes, control 0x%02X", round, k, txn->len, p[0]);
+            if (txn->len < 2 || got_len + txn->len - 1 > sizeof(got)) break;
+            memcpy(got + got_len, p + 1, txn->len - 1);
+            got_len += txn->len - 1;
+        }
+        TEST_CHECK(got_len == sizeof(got) && memcmp(got, frame + 1, sizeof(got)) == 0,
+                   "round %d: payload %zu bytes, want %zu in order", round, got_len, sizeof(got));
+    }
+    TEST_CHECK(t.max_xfer == 33, "learned max_xfer %zu, want 33", t.max_xfer);
+    TEST_CHECK(t.max_msgs == 4, "learned max_msgs %d, want 4", t.max_msgs);
+    ssd1306_transport_close(&t);
 }
 
-void ssd1306_stop_scroll(int fd) {
-ssd1306_send_command(fd, 0x2E);
+// Luồng flush phục vụ các màn hình trên một bus theo vòng, mỗi màn hình tối đa một khung mỗi
+// lượt. Test giữ khóa bus để luồng flush kẹt ở khung đầu của màn hình 0, trong lúc đó cả ba
+// màn hình (và màn hình 0 thêm lần nữa) present: thứ tự trên bus phải là 0, 1, 2, rồi 0.
+static void test_flusher_round_robin(void) {
+    static const uint16_t addrs[] = { 0x3C, 0x3D, 0x3E };
+    ssd1306_t *devs[3];
+    ssd1306_bus_t *bus = ssd1306_bus_open("mem", I2C_BUS_PATH, SSD1306_BUS_400KHZ);
+    TEST_CHECK(bus != NULL, "open mem bus");
+    if (bus == NULL) return;
+    for (int i = 0; i < 3; ++i) {
+        devs[i] = ssd1306_open(bus, addrs[i]);
+        if (devs[i] == NULL || ssd1306_init(devs[i]) != 0 || ssd1306_display_buffer(devs[i]) < 0) {
+            TEST_CHECK(0, "open display 0x%X on mem bus", addrs[i]);
+            ssd1306_bus_close(bus);
+            return;
+        }
+    }
+    if (ssd1306_bus_start_flusher(bus) != 0) {
+        TEST_CHECK(0, "start flusher");
+        ssd1306_bus_close(bus);
+        return;
+    }
+    ssd1306_mem_reset(&bus->t);
+
+    pthread_mutex_lock(&bus->lock);
+    ssd1306_draw_pixel(devs[0], 0, 0, SSD1306_COLOR_WHITE);
+    ssd1306_present(devs[0]);
+    while (atomic_load(&devs[0]->frame_ready) & SSD1306_SLOT_NEW) {
+        usleep(100); // chờ luồng flush lấy khung rồi kẹt ở khóa bus
+    }
+    for (int i = 1; i < 3; ++i) {
+        ssd1306_draw_pixel(devs[i], 0, 0, SSD1306_COLOR_WHITE);
+        ssd1306_present(devs[i]);
+    }
+    ssd1306_draw_pixel(devs[0], 1, 0, SSD1306_COLOR_WHITE);
+    ssd1306_present(devs[0]);
+    pthread_mutex_unlock(&bus->lock);
+    ssd1306_bus_stop_flusher(bus); // gửi hết các khung đang chờ rồi mới dừng
+
+    // Gộp các giao dịch liền nhau cùng địa chỉ thành một lần phục vụ
+    static const uint16_t want[] = { 0x3C, 0x3D, 0x3E, 0x3C };
+    uint16_t got[8];
+    size_t n = 0;
+    for (size_t k = 0; k < bus->t.mem.txn_count; ++k) {
+        uint16_t addr = bus->t.mem.txns[k].addr;
+        if (n > 0 && got[n - 1] == addr) continue;
+        if (n == sizeof(got) / sizeof(got[0])) break;
+        got[n++] = addr;
+    }
+    TEST_CHECK(n == 4 && memcmp(got, want, sizeof(want)) == 0,
+               "service order %zu: 0x%X 0x%X 0x%X 0x%X, want 0x3C 0x3D 0x3E 0x3C",
+               n, n > 0 ? got[0] : 0, n > 1 ? got[1] : 0, n > 2 ? got[2] : 0, n > 3 ? got[3] : 0);
+    ssd1306_bus_close(bus);
 }
 
-int main() {
-int fd = open(I2C_DEV, O_RDWR);
-if (fd < 0) {
-perror("Failed to open I2C device");
-return 1;
+// Khung dọc: hình chữ nhật ngẫu nhiên (cả phần tràn khung) trên mọi panel, cả 90 lẫn 270 độ.
+// display_buffer sau phép chuyển vị ô 8x8 phải trùng từng bit với cách xoay cũ từng pixel:
+// pixel logic (x, y) là pixel vật lý (y, width - 1 - x), như bench portrait_naive.
+static void test_portrait_transpose(void) {
+    static const int rotations[] = { SSD1306_ROTATE_90, SSD1306_ROTATE_270 };
+    static const int colors[] = { SSD1306_COLOR_WHITE, SSD1306_COLOR_BLACK, SSD1306_COLOR_INVERT };
+    static ssd1306_portrait_t p;
+    uint32_t seed = 0x1306u;
+
+    for (int i = 0; i < ssd1306_panel_count; ++i) {
+        const char *name = ssd1306_panels[i].name;
+        for (int r = 0; r < 2; ++r) {
+            ssd1306_bus_t *bus;
+            ssd1306_t *dev = test_open(&bus, name);
+            TEST_CHECK(dev != NULL, "open %s on mem bus", name);
+            if (dev == NULL) continue;
+            TEST_CHECK(ssd1306_portrait_init(&p, dev, rotations[r]) == 0, "%s: portrait init %d", name, rotations[r]);
+
+            const int w = p.width, h = p.height;
+            for (int round = 0; round < 200; ++round) {
+                // 1..4 hình mỗi lượt convert, tọa độ lệch tới 8 pixel ra ngoài khung
+                for (int n = (int)((seed >> 16) & 3); n >= 0; --n) {
+                    seed = seed * 1103515245u + 12345u;
+                    int x = (int)((seed >> 8) % (uint32_t)(w + 16)) - 8;
+                    int y = (int)((seed >> 16) % (uint32_t)(h + 16)) - 8;
+                    seed = seed * 1103515245u + 12345u;
+                    int rw = (int)((seed >> 8) % (uint32_t)w) + 1;
+                    int rh = (int)((seed >> 16) % (uint32_t)(h / 2)) + 1;
+                    ssd1306_portrait_fill_rect(&p, x, y, rw, rh, colors[(seed >> 24) % 3]);
+                }
+                ssd1306_portrait_convert(&p);
+
+                uint8_t want[SSD1306_BUFFER_SIZE];
+                memset(want, 0, sizeof(want));
+                for (int y = 0; y < h; ++y) {
+                    for (int x = 0; x < w; ++x) {
+                        if ((p.buffer[(y >> 3) * SSD1306_PORTRAIT_WIDTH + x] >> (y & 7)) & 1) {
+                            int row = w - 1 - x;
+                            want[(row >> 3) * SSD1306_WIDTH + y] |= (uint8_t)(1u << (row & 7));
+                        }
+                    }
+                }
+                int bad = -1;
+                for (int page = 0; page < dev->pages && bad < 0; ++page) {
+                    for (int col = 0; col < dev->width; ++col) {
+                        if (dev->display_buffer[page * SSD1306_WIDTH + col] != want[page * SSD1306_WIDTH + col]) {
+                            bad = page * SSD1306_WIDTH + col;
+                            break;
+                        }
+                    }
+                }
+                TEST_CHECK(bad < 0, "%s rotate %d round %d: page %d column %d is 0x%02X, want 0x%02X",
+                           name, rotations[r], round, bad / SSD1306_WIDTH, bad % SSD1306_WIDTH,
+                           bad < 0 ? 0 : dev->display_buffer[bad], bad < 0 ? 0 : want[bad]);
+                if (bad >= 0) break;
+            }
+            ssd1306_bus_close(bus);
+        }
+    }
 }
 
+static int run_selftest(void) {
+    ssd1306_verbose = 0;
+    test_scroll_datasheet_bytes();
+    test_transport_chunk_limits();
+    test_flusher_round_robin();
+    test_portrait_transpose();
+    if (test_failures != 0) {
+        fprintf(stderr, "selftest: %d check(s) failed\n", test_failures);
+        return 1;
+    }
+    printf("selftest: all checks passed\n");
+    return 0;
+}
 
-if (ioctl(fd, I2C_SLAVE, SSD1306_ADDR) < 0) {
-    perror("Failed to set I2C address");
-    close(fd);
-    return 1;
+// Cách dùng: ./ssd1306_test [auto|dev|rdwr|smbus|mem|selftest]
+int main(int argc, char *argv[]) {
+if (argc > 1 && strcmp(argv[1], "selftest") == 0) {
+return run_selftest();
+}
+ssd1306_transport_t bus;
+ssd1306_transport_t *fd = &bus;
+const char *backend = argc > 1 ? argv[1] : "auto";
+if (ssd1306_transport_open_by_name(fd, backend, I2C_DEV, SSD1306_ADDR, SSD1306_BUS_400KHZ) != 0) {
+return 1;
 }
 
-ssd1306_init(fd);
-ssd1306_clear(fd);
+demo_init(fd);
+demo_clear(fd);
 
-ssd1306_draw_string(fd, 3, 0, "HHH12345"); // hiển thị tại page 3
+demo_draw_string(fd, 3, 0, "HHH12345"); // hiển thị tại page 3
 
 sleep(2); // chờ 2 giây
-ssd1306_start_scroll_left(fd, 3, 3); // cuộn dòng page 3
+demo_start_scroll_left(fd, 3, 3); // cuộn dòng page 3
 
 sleep(10); // cuộn trong 10 giây
-ssd1306_stop_scroll(fd);
+demo_stop_scroll(fd);
 
-close(fd);
+if (strcmp(backend, "mem") == 0) {
+ssd1306_mem_print_stats(fd, stdout);
+}
+ssd1306_transport_close(fd);
 return 0;
 }
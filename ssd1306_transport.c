@@ -0,0 +1,966 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>           // For nanosleep(), clock_gettime()
+#include <fcntl.h>          // For O_RDWR
+#include <unistd.h>         // For write(), close()
+#include <sys/ioctl.h>      // For ioctl()
+#include <linux/i2c.h>      // For struct i2c_msg
+#include <linux/i2c-dev.h>  // For I2C_SLAVE, I2C_RDWR, I2C_FUNCS, I2C_SMBUS
+
+#include "ssd1306_transport.h"
+
+int ssd1306_verbose = 1;
+
+// =========================================================================
+// Backend dev: write() trực tiếp lên /dev/i2c-N
+// =========================================================================
+
+static int dev_write(ssd1306_transport_t *t, const uint8_t *buf, size_t len) {
+    return (int)write(t->fd, buf, len);
+}
+
+static void fd_close(ssd1306_transport_t *t) {
+    close(t->fd);
+    t->fd = -1;
+}
+
+// write() không mang địa chỉ: đổi slave của fd bằng I2C_SLAVE
+static int dev_set_addr(ssd1306_transport_t *t, uint16_t addr) {
+    return ioctl(t->fd, I2C_SLAVE, addr) < 0 ? -1 : 0;
+}
+
+static const ssd1306_transport_ops_t dev_ops = {
+    .name = "dev",
+    .write = dev_write,
+    .set_addr = dev_set_addr,
+    .close = fd_close,
+};
+
+static int open_bus(ssd1306_transport_t *t, const char *path, uint16_t addr) {
+    memset(t, 0, sizeof(*t));
+    t->fd = open(path, O_RDWR);
+    if (t->fd < 0) {
+        perror("Failed to open I2C bus");
+        return -1;
+    }
+    t->addr = addr;
+    // Adapter không hỗ trợ I2C_FUNCS: coi như chỉ có write() thuần
+    if (ioctl(t->fd, I2C_FUNCS, &t->funcs) < 0) {
+        t->funcs = I2C_FUNC_I2C;
+    }
+    return 0;
+}
+
+int ssd1306_transport_open_dev(ssd1306_transport_t *t, const char *path, uint16_t addr) {
+    if (open_bus(t, path, addr) != 0) return -1;
+    if (dev_set_addr(t, addr) != 0) {
+        perror("Failed to set I2C slave address");
+        fd_close(t);
+        return -1;
+    }
+    t->ops = &dev_ops;
+    return 0;
+}
+
+// =========================================================================
+// Backend rdwr: ioctl(I2C_RDWR), địa chỉ slave nằm trong từng i2c_msg
+// =========================================================================
+
+static int rdwr_write(ssd1306_transport_t *t, const uint8_t *buf, size_t len) {
+    struct i2c_msg msg = {
+        .addr = t->addr,
+        .flags = 0,
+        .len = (uint16_t)len,
+        .buf = (uint8_t *)buf,
+    };
+    struct i2c_rdwr_ioctl_data xfer = { .msgs = &msg, .nmsgs = 1 };
+    if (len > UINT16_MAX) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+    if (ioctl(t->fd, I2C_RDWR, &xfer) < 0) return -1;
+    return (int)len;
+}
+
+// Các giao dịch đã chia nhỏ đi chung một ioctl, mỗi giao dịch một i2c_msg (START lặp lại
+// giữa các message). ioctl trả về số message đã thực hiện: ít hơn count là ghi một phần.
+static int rdwr_write_chunks(ssd1306_transport_t *t, const uint8_t *buf, const size_t *lens, int count) {
+    struct i2c_msg msgs[SSD1306_RDWR_MAX_MSGS];
+    for (int k = 0; k < count; ++k) {
+        msgs[k] = (struct i2c_msg){ .addr = t->addr, .flags = 0, .len = (uint16_t)lens[k], .buf = (uint8_t *)buf };
+        buf += lens[k];
+    }
+    struct i2c_rdwr_ioctl_data xfer = { .msgs = msgs, .nmsgs = (uint32_t)count };
+    return ioctl(t->fd, I2C_RDWR, &xfer);
+}
+
+static const ssd1306_transport_ops_t rdwr_ops = {
+    .name = "rdwr",
+    .write = rdwr_write,
+    .write_chunks = rdwr_write_chunks,
+    .close = fd_close,
+};
+
+int ssd1306_transport_open_rdwr(ssd1306_transport_t *t, const char *path, uint16_t addr) {
+    if (open_bus(t, path, addr) != 0) return -1;
+    t->max_msgs = SSD1306_RDWR_MAX_MSGS;
+    t->ops = &rdwr_ops;
+    return 0;
+}
+
+// =========================================================================
+// Backend smbus: ioctl(I2C_SMBUS). Một giao dịch [control byte, dữ liệu...] trùng khớp
+// với một lần ghi khối I2C SMBus: control byte là byte lệnh, tối đa 32 byte dữ liệu.
+// Adapter chỉ có ghi byte (SMBus write byte data) thì mỗi giao dịch là control byte + 1 byte.
+// =========================================================================
+
+static int smbus_write(ssd1306_transport_t *t, const uint8_t *buf, size_t len) {
+    union i2c_smbus_data data;
+    struct i2c_smbus_ioctl_data args = {
+        .read_write = I2C_SMBUS_WRITE,
+        .command = buf[0],
+        .data = &data,
+    };
+    if (len < SSD1306_XFER_MIN || len - 1 > SSD1306_SMBUS_BLOCK_MAX) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+    if (t->funcs & I2C_FUNC_SMBUS_WRITE_I2C_BLOCK) {
+        args.size = I2C_SMBUS_I2C_BLOCK_DATA;
+        data.block[0] = (uint8_t)(len - 1);
+        memcpy(data.block + 1, buf + 1, len - 1);
+    } else if (len == SSD1306_XFER_MIN) {
+        args.size = I2C_SMBUS_BYTE_DATA;
+        data.byte = buf[1];
+    } else {
+        errno = EMSGSIZE;
+        return -1;
+    }
+    if (ioctl(t->fd, I2C_SMBUS, &args) < 0) return -1;
+    return (int)len;
+}
+
+static const ssd1306_transport_ops_t smbus_ops = {
+    .name = "smbus",
+    .write = smbus_write,
+    .set_addr = dev_set_addr,
+    .close = fd_close,
+};
+
+int ssd1306_transport_open_smbus(ssd1306_transport_t *t, const char *path, uint16_t addr) {
+    if (open_bus(t, path, addr) != 0) return -1;
+    if (!(t->funcs & (I2C_FUNC_SMBUS_WRITE_I2C_BLOCK | I2C_FUNC_SMBUS_WRITE_BYTE_DATA))) {
+        fprintf(stderr, "Error: I2C adapter supports neither SMBus block nor byte writes.\n");
+        fd_close(t);
+        return -1;
+    }
+    if (dev_set_addr(t, addr) != 0) {
+        perror("Failed to set I2C slave address");
+        fd_close(t);
+        return -1;
+    }
+    // Giới hạn đã biết trước, không cần học
+    t->max_xfer = (t->funcs & I2C_FUNC_SMBUS_WRITE_I2C_BLOCK) ? 1 + SSD1306_SMBUS_BLOCK_MAX : SSD1306_XFER_MIN;
+    t->xfer_ok = t->max_xfer;
+    t->xfer_reject = t->max_xfer + 1;
+    t->ops = &smbus_ops;
+    return 0;
+}
+
+// =========================================================================
+// Backend auto: chọn theo khả năng của adapter
+//   I2C_FUNC_I2C       -> rdwr (giao dịch chia nhỏ vẫn chỉ tốn một ioctl)
+//   chỉ có SMBus       -> smbus
+//   không rõ           -> dev
+// =========================================================================
+
+int ssd1306_transport_open_auto(ssd1306_transport_t *t, const char *path, uint16_t addr) {
+    if (open_bus(t, path, addr) != 0) return -1;
+    unsigned long funcs = t->funcs;
+    fd_close(t);
+
+    int rc;
+    if (funcs & I2C_FUNC_I2C) {
+        rc = ssd1306_transport_open_rdwr(t, path, addr);
+    } else if (funcs & (I2C_FUNC_SMBUS_WRITE_I2C_BLOCK | I2C_FUNC_SMBUS_WRITE_BYTE_DATA)) {
+        rc = ssd1306_transport_open_smbus(t, path, addr);
+    } else {
+        rc = ssd1306_transport_open_dev(t, path, addr);
+    }
+    if (rc == 0 && ssd1306_verbose) {
+        fprintf(stderr, "I2C adapter functionality 0x%08lx: using '%s' transport.\n", funcs, t->ops->name);
+    }
+    return rc;
+}
+
+// =========================================================================
+// Backend mem: bus giả, ghi lại mọi giao dịch
+// =========================================================================
+
+uint64_t ssd1306_bus_time_ns(uint32_t bus_hz, size_t len) {
+    // 1 xung cho START, 9 xung cho byte địa chỉ, 9 xung mỗi byte, 1 xung cho STOP
+    uint64_t clocks = 1 + 9 + 9 * (uint64_t)len + 1;
+    return clocks * 1000000000ULL / bus_hz;
+}
+
+static int mem_grow(void **ptr, size_t *cap, size_t need, size_t elem) {
+    if (need <= *cap) return 0;
+    size_t new_cap = *cap ? *cap : 64;
+    while (new_cap < need) new_cap *= 2;
+    void *p = realloc(*ptr, new_cap * elem);
+    if (p == NULL) return -1;
+    *ptr = p;
+    *cap = new_cap;
+    return 0;
+}
+
+static int mem_write(ssd1306_transport_t *t, const uint8_t *buf, size_t len) {
+    ssd1306_mem_bus_t *m = &t->mem;
+    if (m->max_write != 0 && len > m->max_write) {
+        errno = EOPNOTSUPP; // như quirk max_write_len của driver adapter trong kernel
+        return -1;
+    }
+    if (mem_grow((void **)&m->txns, &m->txn_cap, m->txn_count + 1, sizeof(*m->txns)) != 0 ||
+        mem_grow((void **)&m->log, &m->log_cap, m->log_len + len, 1) != 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    ssd1306_mem_txn_t *txn = &m->txns[m->txn_count++];
+    txn->start_ns = m->bus_time_ns;
+    txn->bus_ns = (uint32_t)ssd1306_bus_time_ns(m->bus_hz, len);
+    txn->offset = (uint32_t)m->log_len;
+    txn->len = (uint32_t)len;
+    txn->addr = t->addr;
+    memcpy(m->log + m->log_len, buf, len);
+    m->log_len += len;
+
+    m->total_bytes += len;
+    m->bus_time_ns += txn->bus_ns;
+    if (m->endpoint != NULL) {
+        m->endpoint(m->endpoint_ctx, t->addr, buf, len);
+    }
+    if (m->realtime) {
+        struct timespec req = { 0, (long)txn->bus_ns };
+        while (nanosleep(&req, &req) != 0 && errno == EINTR) {
+        }
+    }
+    return (int)len;
+}
+
+static void mem_close(ssd1306_transport_t *t) {
+    free(t->mem.txns);
+    free(t->mem.log);
+    memset(&t->mem, 0, sizeof(t->mem));
+}
+
+// Kiểm tra quirk như i2c_check_for_quirks() của kernel: cả lượt bị từ chối trước khi byte
+// nào lên bus
+static int mem_write_chunks(ssd1306_transport_t *t, const uint8_t *buf, const size_t *lens, int count) {
+    ssd1306_mem_bus_t *m = &t->mem;
+    if (m->max_msgs != 0 && count > m->max_msgs) {
+        errno = EOPNOTSUPP;
+        return -1;
+    }
+    for (int i = 0; m->max_write != 0 && i < count; ++i) {
+        if (lens[i] > m->max_write) {
+            errno = EOPNOTSUPP;
+            return -1;
+        }
+    }
+    for (int i = 0; i < count; ++i) {
+        if (mem_write(t, buf, lens[i]) < 0) return i > 0 ? i : -1;
+        buf += lens[i];
+    }
+    return count;
+}
+
+static const ssd1306_transport_ops_t mem_ops = {
+    .name = "mem",
+    .write = mem_write,
+    .write_chunks = mem_write_chunks,
+    .close = mem_close,
+};
+
+int ssd1306_transport_open_mem(ssd1306_transport_t *t, uint32_t bus_hz) {
+    if (bus_hz != SSD1306_BUS_100KHZ && bus_hz != SSD1306_BUS_400KHZ && bus_hz != SSD1306_BUS_1MHZ) {
+        fprintf(stderr, "Error: unsupported simulated bus clock %u Hz.\n", bus_hz);
+        return -1;
+    }
+    memset(t, 0, sizeof(*t));
+    t->fd = -1;
+    t->mem.bus_hz = bus_hz;
+    t->max_msgs = SSD1306_RDWR_MAX_MSGS;
+    t->ops = &mem_ops;
+    return 0;
+}
+
+void ssd1306_mem_reset(ssd1306_transport_t *t) {
+    t->mem.txn_count = 0;
+    t->mem.log_len = 0;
+    t->mem.total_bytes = 0;
+    t->mem.bus_time_ns = 0;
+}
+
+void ssd1306_mem_print_stats(const ssd1306_transport_t *t, FILE *out) {
+    const ssd1306_mem_bus_t *m = &t->mem;
+    fprintf(out, "mem bus @ %u Hz: %zu transactions, %llu bytes, %.3f ms bus time\n",
+            m->bus_hz, m->txn_count, (unsigned long long)m->total_bytes,
+            m->bus_time_ns / 1e6);
+}
+
+// =========================================================================
+// Bộ dựng giao dịch (batch)
+// =========================================================================
+
+#define BATCH_NONE 0 // chưa có luồng nào mở ở cuối giao dịch hiện tại
+#define BATCH_CMD  1 // luồng lệnh Co = 0
+#define BATCH_DATA 2 // luồng dữ liệu Co = 0
+
+void ssd1306_batch_begin(ssd1306_batch_t *b, ssd1306_transport_t *t) {
+    b->t = t;
+    b->len = 0;
+    b->txn_count = 0;
+    b->mode = BATCH_NONE;
+    b->stream_pos = 0;
+    b->txn_start = 0;
+    b->bytes_sent = 0;
+    b->error = 0;
+}
+
+static void batch_close_txn(ssd1306_batch_t *b) {
+    if (b->len > b->txn_start) {
+        b->txn_end[b->txn_count++] = b->len;
+    }
+    b->txn_start = b->len;
+    b->mode = BATCH_NONE;
+}
+
+// Gửi mọi giao dịch đang có trong bộ đệm rồi làm rỗng bộ đệm
+static int batch_send(ssd1306_batch_t *b) {
+    batch_close_txn(b);
+    size_t start = 0;
+    for (int i = 0; i < b->txn_count; ++i) {
+        size_t n = b->txn_end[i] - start;
+        if (!b->error) {
+            if (ssd1306_transport_write(b->t, b->buf + start, n) != 0) {
+                perror("Failed to write batch to I2C");
+                b->error = 1;
+            } else {
+                b->bytes_sent += (long)n;
+            }
+        }
+        start = b->txn_end[i];
+    }
+    b->len = 0;
+    b->txn_count = 0;
+    b->txn_start = 0;
+    return b->error ? -1 : 0;
+}
+
+// Bảo đảm còn chỗ cho n byte và một giao dịch nữa; nếu không thì gửi bớt
+static int batch_reserve(ssd1306_batch_t *b, size_t n) {
+    if (b->len + n <= SSD1306_BATCH_MAX && b->txn_count < SSD1306_BATCH_MAX_TXNS - 1) {
+        return 0;
+    }
+    return batch_send(b);
+}
+
+int ssd1306_batch_cmd(ssd1306_batch_t *b, const uint8_t *cmds, size_t n) {
+    if (n == 0) return 0;
+    if (n >= SSD1306_BATCH_MAX) {
+        fprintf(stderr, "Error: command run too long for batch (%zu bytes).\n", n);
+        return -1;
+    }
+    if (b->mode == BATCH_DATA) batch_close_txn(b); // không thể chèn lệnh sau luồng dữ liệu
+    if (batch_reserve(b, n + 1) != 0) return -1;
+    if (b->mode != BATCH_CMD) {
+        b->stream_pos = b->len;
+        b->buf[b->len++] = SSD1306_CONTROL_CMD_STREAM;
+        b->mode = BATCH_CMD;
+    }
+    memcpy(b->buf + b->len, cmds, n);
+    b->len += n;
+    return 0;
+}
+
+int ssd1306_batch_cmd1(ssd1306_batch_t *b, uint8_t c0) {
+    return ssd1306_batch_cmd(b, &c0, 1);
+}
+
+int ssd1306_batch_cmd2(ssd1306_batch_t *b, uint8_t c0, uint8_t c1) {
+    uint8_t cmds[2] = { c0, c1 };
+    return ssd1306_batch_cmd(b, cmds, 2);
+}
+
+int ssd1306_batch_cmd3(ssd1306_batch_t *b, uint8_t c0, uint8_t c1, uint8_t c2) {
+    uint8_t cmds[3] = { c0, c1, c2 };
+    return ssd1306_batch_cmd(b, cmds, 3);
+}
+
+// Chuỗi lệnh ngắn ở cuối giao dịch được mã hóa lại thành các cặp Co = 1
+// để luồng dữ liệu có thể nối tiếp trong cùng giao dịch.
+static void batch_prepare_data(ssd1306_batch_t *b) {
+    if (b->mode != BATCH_CMD) return;
+    size_t k = b->len - b->stream_pos - 1;
+    if (k <= SSD1306_BATCH_CO_MAX && b->len + k + 1 <= SSD1306_BATCH_MAX) {
+        for (size_t i = k; i-- > 0;) {
+            b->buf[b->stream_pos + 2 * i + 1] = b->buf[b->stream_pos + 1 + i];
+            b->buf[b->stream_pos + 2 * i] = SSD1306_CONTROL_CMD_SINGLE;
+        }
+        b->len = b->stream_pos + 2 * k;
+        b->mode = BATCH_NONE;
+    } else {
+        batch_close_txn(b);
+    }
+}
+
+// src == NULL nghĩa là lặp lại giá trị value
+static int batch_append_data(ssd1306_batch_t *b, const uint8_t *src, uint8_t value, size_t n) {
+    batch_prepare_data(b);
+    while (n > 0) {
+        if (b->mode != BATCH_DATA) {
+            if (batch_reserve(b, 2) != 0) return -1;
+            b->stream_pos = b->len;
+            b->buf[b->len++] = SSD1306_CONTROL_DATA_STREAM;
+            b->mode = BATCH_DATA;
+        }
+        size_t room = SSD1306_BATCH_MAX - b->len;
+        if (room == 0) {
+            if (batch_send(b) != 0) return -1; // Con trỏ địa chỉ vẫn giữ nguyên giữa hai giao dịch
+            continue;
+        }
+        size_t chunk = n < room ? n : room;
+        if (src != NULL) {
+            memcpy(b->buf + b->len, src, chunk);
+            src += chunk;
+        } else {
+            memset(b->buf + b->len, value, chunk);
+        }
+        b->len += chunk;
+        n -= chunk;
+    }
+    return 0;
+}
+
+int ssd1306_batch_data(ssd1306_batch_t *b, const uint8_t *data, size_t n) {
+    return batch_append_data(b, data, 0, n);
+}
+
+int ssd1306_batch_fill(ssd1306_batch_t *b, uint8_t value, size_t n) {
+    return batch_append_data(b, NULL, value, n);
+}
+
+long ssd1306_batch_flush(ssd1306_batch_t *b) {
+    if (batch_send(b) != 0) return -1;
+    return b->bytes_sent;
+}
+
+// =========================================================================
+// Ghi vết lưu lượng I2C
+// =========================================================================
+
+struct ssd1306_trace {
+    FILE *f;
+    char path[256];
+    uint64_t start_ns;    // lúc bật ghi vết
+    uint64_t last_ns;     // thời điểm bắt đầu của bản ghi trước
+    int last_addr;        // -1: chưa có bản ghi
+    uint64_t records, bytes;
+};
+
+// Luôn đo thời gian thật, kể cả khi biên dịch với SSD1306_NO_METRICS
+static uint64_t trace_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static size_t trace_put_varint(uint8_t *p, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+int ssd1306_trace_start(ssd1306_transport_t *t, const char *path) {
+    if (t->trace != NULL && ssd1306_trace_stop(t) != 0) {
+        return -1;
+    }
+    ssd1306_trace_t *tr = calloc(1, sizeof(*tr));
+    if (tr == NULL) {
+        perror("Failed to allocate I2C trace");
+        return -1;
+    }
+    tr->f = fopen(path, "wb");
+    if (tr->f == NULL) {
+        perror("Failed to open I2C trace file");
+        free(tr);
+        return -1;
+    }
+    // Khung đầy đủ là 1 KB: bộ đệm lớn để mỗi khung không tốn một syscall ghi file
+    setvbuf(tr->f, NULL, _IOFBF, 1 << 16);
+
+    uint8_t header[16] = SSD1306_TRACE_MAGIC;
+    header[8] = SSD1306_TRACE_VERSION;
+    if (fwrite(header, sizeof(header), 1, tr->f) != 1) {
+        perror("Failed to write I2C trace header");
+        fclose(tr->f);
+        free(tr);
+        return -1;
+    }
+    snprintf(tr->path, sizeof(tr->path), "%s", path);
+    tr->start_ns = tr->last_ns = trace_now();
+    tr->last_addr = -1;
+    t->trace = tr;
+    return 0;
+}
+
+int ssd1306_trace_stop(ssd1306_transport_t *t) {
+    ssd1306_trace_t *tr = t->trace;
+    if (tr == NULL) return 0;
+    t->trace = NULL;
+    int rc = fclose(tr->f) == 0 ? 0 : -1;
+    if (rc != 0) {
+        perror("Failed to write I2C trace");
+    } else if (ssd1306_verbose) {
+        fprintf(stderr, "I2C trace %s: %llu transactions, %llu bytes.\n", tr->path,
+               (unsigned long long)tr->records, (unsigned long long)tr->bytes);
+    }
+    free(tr);
+    return rc;
+}
+
+// Ghi một bản ghi cho giao dịch bắt đầu lúc t0. Lỗi ghi file dừng ghi vết, không làm
+// hỏng việc gửi lên màn hình.
+static void trace_record(ssd1306_transport_t *t, uint64_t t0, const uint8_t *buf, size_t len, int err) {
+    ssd1306_trace_t *tr = t->trace;
+    uint8_t head[48];
+    size_t n = 1;
+    uint8_t flags = 0;
+
+    n += trace_put_varint(head + n, t0 - tr->last_ns);
+    n += trace_put_varint(head + n, trace_now() - t0);
+    if (t->addr != tr->last_addr) {
+        flags |= SSD1306_TRACE_ADDR;
+        head[n++] = (uint8_t)t->addr;
+        head[n++] = (uint8_t)(t->addr >> 8);
+    }
+    if (err != 0) {
+        flags |= SSD1306_TRACE_ERROR;
+        n += trace_put_varint(head + n, (uint64_t)err);
+    }
+    n += trace_put_varint(head + n, len);
+    head[0] = flags;
+
+    if (fwrite(head, 1, n, tr->f) != n || fwrite(buf, 1, len, tr->f) != len) {
+        perror("Failed to write I2C trace, recording stopped");
+        ssd1306_trace_stop(t);
+        return;
+    }
+    tr->last_ns = t0;
+    tr->last_addr = t->addr;
+    tr->records++;
+    tr->bytes += len;
+}
+
+static int trace_get_varint(FILE *f, uint64_t *v) {
+    *v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = getc(f);
+        if (c == EOF) return -1;
+        *v |= (uint64_t)(c & 0x7F) << shift;
+        if (!(c & 0x80)) return 0;
+    }
+    return -1;
+}
+
+int ssd1306_trace_open(ssd1306_trace_reader_t *r, const char *path) {
+    memset(r, 0, sizeof(*r));
+    r->f = fopen(path, "rb");
+    if (r->f == NULL) {
+        perror("Failed to open I2C trace file");
+        return -1;
+    }
+    r->path = path;
+    if (ssd1306_trace_rewind(r) != 0) {
+        ssd1306_trace_close(r);
+        return -1;
+    }
+    return 0;
+}
+
+int ssd1306_trace_rewind(ssd1306_trace_reader_t *r) {
+    uint8_t header[16];
+    rewind(r->f);
+    if (fread(header, sizeof(header), 1, r->f) != 1 ||
+        memcmp(header, SSD1306_TRACE_MAGIC, 8) != 0 || header[8] != SSD1306_TRACE_VERSION) {
+        fprintf(stderr, "Error: %s is not an SSD1306 I2C trace (version %d).\n", r->path, SSD1306_TRACE_VERSION);
+        return -1;
+    }
+    r->start_ns = 0;
+    r->addr = 0;
+    r->records = 0;
+    return 0;
+}
+
+int ssd1306_trace_next(ssd1306_trace_reader_t *r, ssd1306_trace_rec_t *rec) {
+    int flags = getc(r->f);
+    if (flags == EOF) return 0;
+
+    uint64_t delta, write_ns, err = 0, len;
+    if (trace_get_varint(r->f, &delta) != 0 || trace_get_varint(r->f, &write_ns) != 0) goto corrupt;
+    if (flags & SSD1306_TRACE_ADDR) {
+        int lo = getc(r->f), hi = getc(r->f);
+        if (hi == EOF) goto corrupt;
+        r->addr = (uint16_t)(lo | hi << 8);
+    } else if (r->records == 0) {
+        goto corrupt;
+    }
+    if ((flags & SSD1306_TRACE_ERROR) && trace_get_varint(r->f, &err) != 0) goto corrupt;
+    if (trace_get_varint(r->f, &len) != 0 || len > (1u << 24)) goto corrupt;
+    if (len > r->cap) {
+        uint8_t *p = realloc(r->buf, len);
+        if (p == NULL) {
+            perror("Failed to allocate I2C trace record");
+            return -1;
+        }
+        r->buf = p;
+        r->cap = len;
+    }
+    if (len != 0 && fread(r->buf, len, 1, r->f) != 1) goto corrupt;
+
+    r->start_ns += delta;
+    r->records++;
+    rec->start_ns = r->start_ns;
+    rec->write_ns = write_ns;
+    rec->addr = r->addr;
+    rec->err = (int)err;
+    rec->len = len;
+    rec->data = r->buf;
+    return 1;
+
+corrupt:
+    fprintf(stderr, "Error: %s: truncated or corrupt record after %llu records.\n",
+            r->path, (unsigned long long)r->records);
+    return -1;
+}
+
+void ssd1306_trace_close(ssd1306_trace_reader_t *r) {
+    if (r->f != NULL) fclose(r->f);
+    free(r->buf);
+    memset(r, 0, sizeof(*r));
+}
+
+// =========================================================================
+// Hàm chung
+// =========================================================================
+
+int ssd1306_transport_open_by_name(ssd1306_transport_t *t, const char *name,
+                                   const char *path, uint16_t addr, uint32_t bus_hz) {
+    if (strcmp(name, "dev") == 0) return ssd1306_transport_open_dev(t, path, addr);
+    if (strcmp(name, "rdwr") == 0) return ssd1306_transport_open_rdwr(t, path, addr);
+    if (strcmp(name, "smbus") == 0) return ssd1306_transport_open_smbus(t, path, addr);
+    if (strcmp(name, "mem") == 0) return ssd1306_transport_open_mem(t, bus_hz);
+    if (strcmp(name, "auto") == 0) return ssd1306_transport_open_auto(t, path, addr);
+    fprintf(stderr, "Error: unknown transport '%s' (expected dev, rdwr, smbus, mem or auto).\n", name);
+    return -1;
+}
+
+void ssd1306_transport_close(ssd1306_transport_t *t) {
+    if (t->ops == NULL) return;
+    ssd1306_trace_stop(t);
+    t->ops->close(t);
+    t->ops = NULL;
+    free(t->stage);
+    t->stage = NULL;
+    t->stage_cap = 0;
+}
+
+// Ghi nhận một syscall ghi bắt đầu lúc t0: txns giao dịch với tổng bytes byte đã lên bus.
+// failed: syscall không gửi hết, errno cho biết lý do.
+static void transport_account(ssd1306_transport_t *t, uint64_t t0, uint64_t txns, size_t bytes, int failed) {
+    ssd1306_transport_metrics_t *m = &t->metrics;
+    uint64_t dt = ssd1306_metrics_now() - t0;
+    int err = errno;
+
+    m->syscalls++;
+    ssd1306_hist_add(&m->write_ns, dt);
+    m->busy_ns += dt;
+    m->txns += txns;
+    m->bytes += bytes;
+    if (failed && (err == ENXIO || err == EREMOTEIO)) m->nacks++;
+    errno = err;
+}
+
+static int transport_op_write(ssd1306_transport_t *t, const uint8_t *buf, size_t len) {
+    uint64_t t0 = ssd1306_metrics_now();
+    int n = t->ops->write(t, buf, len);
+    if (n > 0 && (size_t)n < len) t->metrics.short_writes++;
+    transport_account(t, t0, n > 0, n > 0 ? (size_t)n : 0, n != (int)len);
+    return n;
+}
+
+static int transport_op_chunks(ssd1306_transport_t *t, const uint8_t *buf, const size_t *lens, int count) {
+    uint64_t t0 = ssd1306_metrics_now();
+    int sent = t->ops->write_chunks(t, buf, lens, count);
+    size_t bytes = 0;
+    if (sent > count) sent = count;
+    for (int i = 0; i < sent; ++i) bytes += lens[i];
+    if (sent > 0 && sent < count) t->metrics.short_writes++;
+    transport_account(t, t0, sent > 0 ? (uint64_t)sent : 0, bytes, sent != count);
+    return sent;
+}
+
+// Số giao dịch tối đa mỗi lượt, học bằng chia đôi giữa lượt lớn nhất đã qua (msgs_ok) và
+// lượt nhỏ nhất bị từ chối (msgs_reject), giống max_xfer
+static void transport_set_msgs(ssd1306_transport_t *t) {
+    if (t->msgs_reject - t->msgs_ok <= 1) {
+        if (t->max_msgs != t->msgs_ok) {
+            fprintf(stderr, "I2C adapter accepts at most %d messages per transfer.\n", t->msgs_ok);
+        }
+        t->max_msgs = t->msgs_ok;
+        return;
+    }
+    int max = t->msgs_ok != 0 ? (t->msgs_ok + t->msgs_reject) / 2 : t->msgs_reject / 2;
+    t->max_msgs = max < 1 ? 1 : max;
+}
+
+// Gửi count giao dịch liền nhau trong buf qua write_chunks, mỗi lượt tối đa max_msgs.
+// Trả về số giao dịch đã gửi; ít hơn count là lỗi (errno được đặt).
+static int transport_chunks(ssd1306_transport_t *t, const uint8_t *buf, const size_t *lens, int count) {
+    int i = 0;
+    while (i < count) {
+        int n = count - i < t->max_msgs ? count - i : t->max_msgs;
+        int sent = transport_op_chunks(t, buf, lens + i, n);
+        if (sent == n) {
+            if (n > 1 && t->msgs_reject != 0 && n > t->msgs_ok) {
+                t->msgs_ok = n;
+                transport_set_msgs(t); // chưa hội tụ: lần sau thử lượt lớn hơn
+            }
+        } else if (sent < 0 && errno == EOPNOTSUPP && n > 1) {
+            // Quirk về độ dài hay về số message? Gửi lại từng giao dịch: giao dịch đơn bị từ
+            // chối là giới hạn độ dài, để transport_write() học max_xfer
+            for (sent = 0; sent < n; ++sent) {
+                int r = transport_op_chunks(t, buf, lens + i + sent, 1);
+                if (r != 1) {
+                    if (r >= 0) errno = EIO;
+                    return i + sent;
+                }
+                buf += lens[i + sent];
+            }
+            i += n;
+            if (t->msgs_reject == 0 || n < t->msgs_reject) t->msgs_reject = n;
+            if (t->msgs_ok >= t->msgs_reject) t->msgs_ok = 0;
+            transport_set_msgs(t);
+            continue;
+        } else {
+            // Ghi một phần: sent giao dịch đầu đã lên bus
+            if (sent >= 0) errno = EIO;
+            return i + (sent > 0 ? sent : 0);
+        }
+        for (int k = 0; k < n; ++k) buf += lens[i + k];
+        i += n;
+    }
+    return count;
+}
+
+// Control byte của luồng Co = 0 đang mở tại vị trí pos của giao dịch, -1 nếu pos nằm ở
+// ranh giới control byte. pos nằm giữa một cặp Co = 1 thì lùi về đầu cặp.
+static int transport_stream_at(const uint8_t *buf, size_t *pos) {
+    size_t i = 0;
+    while (i < *pos) {
+        uint8_t control = buf[i];
+        if (!(control & 0x80)) return control;  // luồng kéo dài tới hết giao dịch
+        if (i + 2 > *pos) {
+            *pos = i;
+            return -1;
+        }
+        i += 2;
+    }
+    return -1;
+}
+
+// Chia buf[*pos, len) thành các giao dịch <= max byte, ghép liền nhau trong t->stage rồi gửi.
+// *stream: control byte của luồng Co = 0 đang mở tại *pos, -1 nếu *pos ở ranh giới control byte.
+// Khi lỗi, *pos/*stream chỉ tới phần chưa gửi để có thể gửi tiếp với giới hạn nhỏ hơn.
+static int transport_write_split(ssd1306_transport_t *t, const uint8_t *buf, size_t len,
+                                 size_t *pos, int *stream, size_t max) {
+    size_t lens[SSD1306_RDWR_MAX_MSGS], end_pos[SSD1306_RDWR_MAX_MSGS];
+    // Mỗi giao dịch mới tốn thêm nhiều nhất một control byte
+    size_t need = (len - *pos) + (len - *pos) / (max - 1) + 2;
+    if (need > t->stage_cap) {
+        uint8_t *p = realloc(t->stage, need);
+        if (p == NULL) return -1;
+        t->stage = p;
+        t->stage_cap = need;
+    }
+
+    t->split_txns++;
+    size_t i = *pos;
+    int ctrl = *stream;
+    while (i < len) {
+        int count = 0;
+        size_t out = 0;
+        // Gom tối đa SSD1306_RDWR_MAX_MSGS giao dịch rồi gửi một lượt
+        while (i < len && count < SSD1306_RDWR_MAX_MSGS) {
+            size_t start = out;
+            if (ctrl >= 0) t->stage[out++] = (uint8_t)ctrl;
+            while (i < len) {
+                if (ctrl >= 0) {
+                    size_t room = max - (out - start);
+                    size_t k = len - i < room ? len - i : room;
+                    memcpy(t->stage + out, buf + i, k);
+                    out += k;
+                    i += k;
+                    if (i < len) break; // giao dịch đầy, luồng tiếp tục ở giao dịch sau
+                } else if (buf[i] & 0x80) {
+                    size_t n = len - i < 2 ? len - i : 2; // một cặp Co = 1 không bị cắt đôi
+                    if (out - start + n > max) break;
+                    memcpy(t->stage + out, buf + i, n);
+                    out += n;
+                    i += n;
+                } else {
+                    if (out - start + SSD1306_XFER_MIN > max) break;
+                    ctrl = buf[i++]; // luồng Co = 0 kéo dài tới hết giao dịch
+                    t->stage[out++] = (uint8_t)ctrl;
+                }
+            }
+            lens[count] = out - start;
+            end_pos[count++] = i;
+        }
+
+        int sent;
+        if (t->ops->write_chunks != NULL) {
+            sent = transport_chunks(t, t->stage, lens, count);
+        } else {
+            const uint8_t *p = t->stage;
+            for (sent = 0; sent < count; ++sent) {
+                int n = transport_op_write(t, p, lens[sent]);
+                if (n != (int)lens[sent]) {
+                    if (n >= 0) errno = EIO;
+                    break;
+                }
+                p += lens[sent];
+            }
+        }
+        if (sent > 0) {
+            *pos = end_pos[sent - 1];
+            *stream = *pos > 0 ? transport_stream_at(buf, pos) : -1;
+        }
+        if (sent < count) return -1;
+    }
+    return 0;
+}
+
+// Lỗi cho thấy adapter không nhận giao dịch dài như vậy (driver adapter trả EOPNOTSUPP
+// khi vượt quirk, một số trả EINVAL/EMSGSIZE)
+static int transport_size_error(int err) {
+    return err == EOPNOTSUPP || err == EMSGSIZE || err == E2BIG || err == EINVAL;
+}
+
+// Tìm giới hạn bằng chia đôi giữa cỡ lớn nhất đã gửi được (xfer_ok) và cỡ nhỏ nhất bị từ
+// chối (xfer_reject). Mỗi lần thử hụt chỉ tốn một syscall bị từ chối, không byte nào lên bus.
+static int transport_limit_known(const ssd1306_transport_t *t) {
+    return t->xfer_reject != 0 && t->xfer_reject - t->xfer_ok <= 1;
+}
+
+static void transport_set_limit(ssd1306_transport_t *t, int was_known) {
+    if (transport_limit_known(t)) {
+        t->max_xfer = t->xfer_ok;
+        if (!was_known) {
+            fprintf(stderr, "I2C adapter accepts at most %zu bytes per transfer; splitting longer ones.\n", t->xfer_ok);
+        }
+        return;
+    }
+    size_t max = t->xfer_ok != 0 ? (t->xfer_ok + t->xfer_reject) / 2 : t->xfer_reject / 2;
+    t->max_xfer = max < SSD1306_XFER_MIN ? SSD1306_XFER_MIN : max;
+}
+
+static void transport_limit_rejected(ssd1306_transport_t *t, size_t len) {
+    int was_known = transport_limit_known(t);
+    if (t->xfer_reject == 0 || len < t->xfer_reject) t->xfer_reject = len;
+    if (t->xfer_ok >= t->xfer_reject) t->xfer_ok = 0; // adapter đổi ý (ví dụ sau khi nạp lại driver)
+    transport_set_limit(t, was_known && transport_limit_known(t));
+}
+
+static void transport_limit_accepted(ssd1306_transport_t *t, size_t len) {
+    if (t->xfer_reject == 0 || len <= t->xfer_ok) return;
+    int was_known = transport_limit_known(t);
+    t->xfer_ok = len < t->xfer_reject ? len : t->xfer_reject - 1;
+    transport_set_limit(t, was_known); // chưa hội tụ: lần sau thử cỡ lớn hơn
+}
+
+static int transport_write(ssd1306_transport_t *t, const uint8_t *buf, size_t len) {
+    size_t pos = 0;   // phần đầu đã lên bus
+    int stream = -1;
+    for (;; t->metrics.retries++) {
+        size_t max = t->max_xfer, tried;
+        if (pos == 0 && (max == 0 || len <= max)) {
+            int n = transport_op_write(t, buf, len);
+            if (n == (int)len) {
+                transport_limit_accepted(t, len);
+                return 0;
+            }
+            if (n > 0) {
+                // Ghi được một phần: adapter vừa cho biết giới hạn, n byte đầu đã lên bus
+                t->xfer_ok = (size_t)n;
+                t->xfer_reject = (size_t)n + 1;
+                transport_set_limit(t, 0);
+                pos = (size_t)n;
+                stream = transport_stream_at(buf, &pos);
+                continue;
+            }
+            if (n == 0) errno = EIO;
+            tried = len;
+        } else {
+            if (transport_write_split(t, buf, len, &pos, &stream, max) == 0) {
+                transport_limit_accepted(t, max);
+                return 0;
+            }
+            tried = max;
+        }
+        if (!transport_size_error(errno) || tried <= SSD1306_XFER_MIN) {
+            t->metrics.errors++;
+            return -1;
+        }
+        t->metrics.size_rejects++;
+        transport_limit_rejected(t, tried);
+    }
+}
+
+int ssd1306_transport_write(ssd1306_transport_t *t, const uint8_t *buf, size_t len) {
+    if (t->ops == NULL) {
+        errno = EBADF;
+        return -1;
+    }
+    if (t->trace == NULL) {
+        return transport_write(t, buf, len);
+    }
+
+    uint64_t t0 = trace_now();
+    int rc = transport_write(t, buf, len);
+    int err = rc == 0 ? 0 : errno != 0 ? errno : EIO;
+    trace_record(t, t0, buf, len, err);
+    errno = err;
+    return rc;
+}
+
+int ssd1306_transport_set_addr(ssd1306_transport_t *t, uint16_t addr) {
+    if (t->ops == NULL) {
+        errno = EBADF;
+        return -1;
+    }
+    if (addr == t->addr) return 0;
+    if (t->ops->set_addr != NULL && t->ops->set_addr(t, addr) != 0) {
+        return -1;
+    }
+    t->addr = addr;
+    return 0;
+}
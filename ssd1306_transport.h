@@ -0,0 +1,231 @@
+#ifndef SSD1306_TRANSPORT_H
+#define SSD1306_TRANSPORT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "ssd1306_metrics.h"
+
+// =========================================================================
+// Lớp truyền tải (transport) cho SSD1306
+// Mọi byte gửi tới màn hình (control byte + lệnh/dữ liệu) đi qua một
+// ssd1306_transport_t. Mỗi lần gọi ssd1306_transport_write() là một giao dịch
+// I2C (START - địa chỉ - dữ liệu - STOP).
+//
+// Các backend:
+//   - dev : write() trên /dev/i2c-N sau khi đặt I2C_SLAVE (cách cũ)
+//   - rdwr: ioctl(I2C_RDWR) với mảng struct i2c_msg
+//   - smbus: ioctl(I2C_SMBUS) ghi khối I2C (control byte làm byte lệnh, tối đa 32 byte
+//           dữ liệu) cho adapter chỉ hỗ trợ SMBus
+//   - mem : bus giả trong bộ nhớ, ghi lại từng giao dịch và thời gian bus mô phỏng
+//   - auto: hỏi I2C_FUNCS của adapter rồi chọn rdwr, smbus hoặc dev
+//
+// Adapter thường giới hạn số byte mỗi giao dịch. Giao dịch dài hơn max_xfer được chia
+// thành nhiều giao dịch ngắn: chỉ cắt giữa hai cặp Co = 1 hoặc bên trong một luồng
+// Co = 0 (phần sau được thêm lại control byte của luồng), con trỏ địa chỉ của SSD1306
+// chạy tiếp nên màn hình nhận đúng nội dung. Nếu adapter từ chối một giao dịch vì
+// kích thước (EOPNOTSUPP, EMSGSIZE, ...) hoặc chỉ ghi được một phần, giới hạn được học
+// (chia đôi qua vài lần gửi) và lưu trong max_xfer cho các lần gửi sau. Backend gửi được
+// nhiều giao dịch trong một syscall (rdwr, mem) học số giao dịch tối đa mỗi lần (max_msgs)
+// theo cùng cách: EOPNOTSUPP của cả lượt có thể do độ dài hoặc do số message, nên lượt đó
+// được gửi lại từng giao dịch một; chỉ khi từng giao dịch đều qua thì mới hạ max_msgs.
+// =========================================================================
+
+// Tốc độ bus chuẩn cho backend mem
+#define SSD1306_BUS_100KHZ       100000
+#define SSD1306_BUS_400KHZ       400000
+#define SSD1306_BUS_1MHZ         1000000
+
+typedef struct ssd1306_transport ssd1306_transport_t;
+typedef struct ssd1306_trace ssd1306_trace_t;
+
+typedef struct {
+    const char *name;
+    // Gửi len byte trong một giao dịch. Trả về số byte đã gửi, -1 nếu lỗi (errno được đặt).
+    int (*write)(ssd1306_transport_t *t, const uint8_t *buf, size_t len);
+    // Gửi count giao dịch đặt liền nhau trong buf (độ dài lens[i]) trong một lần truyền
+    // (một syscall), count <= t->max_msgs. NULL: gọi write() cho từng giao dịch.
+    // Trả về số giao dịch đã gửi (count nếu không lỗi, ít hơn nếu chỉ gửi được một phần),
+    // -1 nếu không giao dịch nào được gửi (errno được đặt).
+    int (*write_chunks)(ssd1306_transport_t *t, const uint8_t *buf, const size_t *lens, int count);
+    // Đổi địa chỉ slave cho các giao dịch sau (NULL: chỉ cần lưu t->addr). Trả về 0/-1.
+    int (*set_addr)(ssd1306_transport_t *t, uint16_t addr);
+    void (*close)(ssd1306_transport_t *t);
+} ssd1306_transport_ops_t;
+
+// Một giao dịch đã ghi lại bởi backend mem
+typedef struct {
+    uint64_t start_ns;    // thời điểm bắt đầu trên trục thời gian bus mô phỏng
+    uint32_t bus_ns;      // thời gian chiếm bus của giao dịch
+    uint32_t offset;      // vị trí payload trong mem.log
+    uint32_t len;         // số byte (kể cả control byte, không kể byte địa chỉ)
+    uint16_t addr;        // địa chỉ slave của giao dịch
+} ssd1306_mem_txn_t;
+
+typedef struct {
+    uint32_t bus_hz;
+    ssd1306_mem_txn_t *txns;
+    size_t txn_count, txn_cap;
+    uint8_t *log;         // payload của mọi giao dịch, nối liền nhau
+    size_t log_len, log_cap;
+    uint64_t total_bytes;
+    uint64_t bus_time_ns;
+    int realtime;         // != 0: write() ngủ đúng thời gian bus mô phỏng, như một adapter thật
+    size_t max_write;     // != 0: từ chối giao dịch dài hơn (EOPNOTSUPP), mô phỏng adapter giới hạn
+    int max_msgs;         // != 0: từ chối lần truyền nhiều giao dịch hơn (EOPNOTSUPP), như quirk max_num_msgs
+    // Thiết bị ở đầu kia của bus (ví dụ bộ mô phỏng ssd1306_emu), NULL: chỉ ghi log
+    void (*endpoint)(void *ctx, uint16_t addr, const uint8_t *buf, size_t len);
+    void *endpoint_ctx;
+} ssd1306_mem_bus_t;
+
+// Giới hạn của adapter
+#define SSD1306_XFER_MIN         2    // control byte + 1 byte: luôn gửi được nếu adapter còn hoạt động
+#define SSD1306_SMBUS_BLOCK_MAX  32   // byte dữ liệu của một lần ghi khối SMBus
+#define SSD1306_RDWR_MAX_MSGS    42   // I2C_RDWR_IOCTL_MAX_MSGS của i2c-dev
+
+struct ssd1306_transport {
+    const ssd1306_transport_ops_t *ops; // NULL khi chưa mở
+    int fd;
+    uint16_t addr;
+    unsigned long funcs;     // I2C_FUNCS của adapter (0 với backend mem)
+    size_t max_xfer;         // số byte tối đa mỗi giao dịch, 0: chưa gặp giới hạn
+    size_t xfer_ok;          // giao dịch lớn nhất đã gửi được từ khi gặp giới hạn
+    size_t xfer_reject;      // giao dịch nhỏ nhất bị từ chối vì kích thước, 0: chưa có
+    int max_msgs;            // số giao dịch tối đa trong một lần write_chunks (i2c_msg của I2C_RDWR)
+    int msgs_ok;             // lượt nhiều giao dịch nhất đã gửi được từ khi gặp giới hạn
+    int msgs_reject;         // lượt ít giao dịch nhất bị từ chối vì số message, 0: chưa có
+    uint8_t *stage;          // bộ đệm ghép các giao dịch đã chia nhỏ
+    size_t stage_cap;
+    uint64_t split_txns;     // số giao dịch phải chia nhỏ
+    ssd1306_transport_metrics_t metrics; // ghi khi giữ khóa bus
+    ssd1306_mem_bus_t mem;
+    ssd1306_trace_t *trace;  // != NULL: đang ghi vết mọi giao dịch (ssd1306_trace_start)
+};
+
+// != 0 (mặc định): thư viện in thông báo trạng thái (mở/đóng bus, backend auto chọn, ghi vết)
+// ra stderr. stdout luôn dành cho chương trình. Backend đã chọn cũng có ở t->ops->name.
+extern int ssd1306_verbose;
+
+int ssd1306_transport_open_dev(ssd1306_transport_t *t, const char *path, uint16_t addr);
+int ssd1306_transport_open_rdwr(ssd1306_transport_t *t, const char *path, uint16_t addr);
+int ssd1306_transport_open_smbus(ssd1306_transport_t *t, const char *path, uint16_t addr);
+int ssd1306_transport_open_mem(ssd1306_transport_t *t, uint32_t bus_hz);
+// Hỏi I2C_FUNCS và mở backend tốt nhất mà adapter hỗ trợ
+int ssd1306_transport_open_auto(ssd1306_transport_t *t, const char *path, uint16_t addr);
+// Mở backend theo tên ("dev", "rdwr", "smbus", "mem", "auto"); bus_hz chỉ dùng cho "mem"
+int ssd1306_transport_open_by_name(ssd1306_transport_t *t, const char *name,
+                                   const char *path, uint16_t addr, uint32_t bus_hz);
+void ssd1306_transport_close(ssd1306_transport_t *t);
+
+static inline int ssd1306_transport_is_open(const ssd1306_transport_t *t) {
+    return t->ops != NULL;
+}
+
+// Chọn slave cho các giao dịch sau; nhiều màn hình trên cùng một bus dùng chung một transport
+int ssd1306_transport_set_addr(ssd1306_transport_t *t, uint16_t addr);
+
+// Gửi trọn vẹn len byte trong một giao dịch (hoặc nhiều giao dịch nếu vượt max_xfer).
+// Trả về 0 nếu thành công, -1 nếu lỗi.
+int ssd1306_transport_write(ssd1306_transport_t *t, const uint8_t *buf, size_t len);
+
+// Thời gian bus cho một giao dịch len byte ở tốc độ bus_hz:
+// START + byte địa chỉ + len byte (mỗi byte 9 xung kể cả ACK) + STOP
+uint64_t ssd1306_bus_time_ns(uint32_t bus_hz, size_t len);
+
+// =========================================================================
+// Ghi vết lưu lượng I2C
+// Khi bật, mỗi lần gọi ssd1306_transport_write() được ghi thành một bản ghi: thời điểm,
+// thời gian gửi, địa chỉ slave, kết quả và nguyên giao dịch (control byte + payload) như
+// driver yêu cầu, trước khi chia nhỏ theo max_xfer. Phát lại bằng ssd1306_replay để đo
+// cùng một lưu lượng trên bus khác hoặc với phiên bản transport khác.
+//
+// Định dạng file (số nguyên little-endian, "varint" là LEB128 không dấu):
+//   đầu file: "SSD1306T" + u32 phiên bản (1) + u32 dự trữ (0)
+//   bản ghi : u8 cờ, varint ns từ lúc bắt đầu bản ghi trước, varint ns gửi,
+//             [u16 địa chỉ nếu cờ ADDR], [varint errno nếu cờ ERROR], varint len, len byte
+// Khung 1 KB tốn thêm khoảng 8 byte; một lệnh ngắn khoảng 6 byte.
+// =========================================================================
+
+#define SSD1306_TRACE_MAGIC      "SSD1306T"
+#define SSD1306_TRACE_VERSION    1
+#define SSD1306_TRACE_ADDR       0x01 // địa chỉ slave khác bản ghi trước (luôn có ở bản ghi đầu)
+#define SSD1306_TRACE_ERROR      0x02 // giao dịch thất bại
+
+// Bật ghi vết vào path (ghi đè). Gọi khi giữ khóa bus nếu bus đang được dùng. Trả về 0/-1.
+int ssd1306_trace_start(ssd1306_transport_t *t, const char *path);
+// Ghi nốt bộ đệm và đóng file; ssd1306_transport_close() tự gọi. Trả về 0/-1.
+int ssd1306_trace_stop(ssd1306_transport_t *t);
+
+typedef struct {
+    uint64_t start_ns;    // thời điểm bắt đầu, tính từ lúc bật ghi vết
+    uint64_t write_ns;    // thời gian ssd1306_transport_write() khi ghi
+    uint16_t addr;
+    int err;              // 0: thành công, errno khi thất bại
+    size_t len;
+    const uint8_t *data;  // hợp lệ tới lần đọc kế tiếp
+} ssd1306_trace_rec_t;
+
+typedef struct {
+    FILE *f;
+    const char *path;
+    uint8_t *buf;
+    size_t cap;
+    uint64_t start_ns;
+    uint16_t addr;
+    uint64_t records;
+} ssd1306_trace_reader_t;
+
+int ssd1306_trace_open(ssd1306_trace_reader_t *r, const char *path);
+// Đọc bản ghi kế tiếp. Trả về 1, 0 khi hết file, -1 nếu file hỏng.
+int ssd1306_trace_next(ssd1306_trace_reader_t *r, ssd1306_trace_rec_t *rec);
+// Quay lại bản ghi đầu (phát lặp). Trả về 0/-1.
+int ssd1306_trace_rewind(ssd1306_trace_reader_t *r);
+void ssd1306_trace_close(ssd1306_trace_reader_t *r);
+
+// =========================================================================
+// Bộ dựng giao dịch (batch)
+// Gom lệnh và dữ liệu rồi phát ra bằng ít giao dịch I2C nhất có thể:
+//   - Các lệnh liên tiếp dùng chung một control byte 0x00 (Co = 0).
+//   - Khi dữ liệu theo sau một chuỗi lệnh ngắn (<= SSD1306_BATCH_CO_MAX byte),
+//     các lệnh được mã hóa lại với Co = 1 (0x80, cmd, 0x80, cmd, ...) để
+//     lệnh + dữ liệu nằm trong cùng một giao dịch.
+//   - Sau một luồng dữ liệu Co = 0 không thể chèn lệnh -> mở giao dịch mới.
+// Khi bộ đệm đầy, batch tự flush phần đã gom.
+// =========================================================================
+
+#define SSD1306_CONTROL_CMD_STREAM   0x00 // Co = 0, D/C# = 0
+#define SSD1306_CONTROL_CMD_SINGLE   0x80 // Co = 1, D/C# = 0
+#define SSD1306_CONTROL_DATA_STREAM  0x40 // Co = 0, D/C# = 1
+
+#define SSD1306_BATCH_MAX        1152 // Đủ cho khung 128x64 + lệnh đặt cửa sổ
+#define SSD1306_BATCH_MAX_TXNS   32
+#define SSD1306_BATCH_CO_MAX     8    // Chuỗi lệnh dài hơn thì tách giao dịch
+
+typedef struct {
+    ssd1306_transport_t *t;
+    uint8_t buf[SSD1306_BATCH_MAX];
+    size_t len;
+    size_t txn_end[SSD1306_BATCH_MAX_TXNS]; // vị trí kết thúc các giao dịch đã đóng
+    int txn_count;
+    int mode;                 // luồng đang mở ở cuối giao dịch hiện tại
+    size_t stream_pos;        // vị trí control byte của luồng đó
+    size_t txn_start;         // vị trí bắt đầu giao dịch hiện tại
+    long bytes_sent;          // tổng byte đã gửi kể từ ssd1306_batch_begin()
+    int error;
+} ssd1306_batch_t;
+
+void ssd1306_batch_begin(ssd1306_batch_t *b, ssd1306_transport_t *t);
+int ssd1306_batch_cmd(ssd1306_batch_t *b, const uint8_t *cmds, size_t n);
+int ssd1306_batch_cmd1(ssd1306_batch_t *b, uint8_t c0);
+int ssd1306_batch_cmd2(ssd1306_batch_t *b, uint8_t c0, uint8_t c1);
+int ssd1306_batch_cmd3(ssd1306_batch_t *b, uint8_t c0, uint8_t c1, uint8_t c2);
+int ssd1306_batch_data(ssd1306_batch_t *b, const uint8_t *data, size_t n);
+int ssd1306_batch_fill(ssd1306_batch_t *b, uint8_t value, size_t n);
+// Gửi mọi giao dịch đã gom. Trả về tổng byte đã gửi từ lúc begin, -1 nếu có lỗi.
+long ssd1306_batch_flush(ssd1306_batch_t *b);
+
+void ssd1306_mem_reset(ssd1306_transport_t *t);
+void ssd1306_mem_print_stats(const ssd1306_transport_t *t, FILE *out);
+
+#endif // SSD1306_TRANSPORT_H